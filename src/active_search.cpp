@@ -6,6 +6,7 @@
 
 #include "active_search.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace wolf{
@@ -27,7 +28,8 @@ void ActiveSearchGrid::setParameters(const int & _img_size_h, const int & _img_s
     margin_ = _margin;
 
     projections_count_.resize(_n_cells_h + 1, _n_cells_v + 1);
-    empty_cells_tile_tmp_.resize(2, (_n_cells_h + 1) * (_n_cells_v + 1));
+    empty_cells_.reserve((_n_cells_h - 1) * (_n_cells_v - 1));
+    empty_cell_position_.resize((_n_cells_h + 1) * (_n_cells_v + 1));
     img_size_(0) = _img_size_h;
     img_size_(1) = _img_size_v;
     grid_size_(0) = _n_cells_h + 1;
@@ -38,29 +40,37 @@ void ActiveSearchGrid::setParameters(const int & _img_size_h, const int & _img_s
     renew();
 }
 
+void ActiveSearchGrid::clear()
+{
+    projections_count_.setZero();
+
+    // all inner cells are empty
+    empty_cells_.clear();
+    std::fill(empty_cell_position_.begin(), empty_cell_position_.end(), -1);
+    for (int j = 1; j < grid_size_(1) - 1; j++)
+        for (int i = 1; i < grid_size_(0) - 1; i++)
+        {
+            int cell_index = i + grid_size_(0) * j;
+            empty_cell_position_[cell_index] = empty_cells_.size();
+            empty_cells_.push_back(cell_index);
+        }
+}
+
+void ActiveSearchGrid::hitCells(const std::vector<cv::KeyPoint>& _pixels)
+{
+    for (const auto& pix : _pixels)
+        hitCell(pix.pt.x, pix.pt.y);
+}
+
 // Functions to fill in cells
 bool ActiveSearchGrid::pickEmptyCell(Eigen::Vector2i & _cell) {
-    int k = 0;
-    Eigen::Vector2i cell0;
-    for (int i = 1; i < grid_size_(0) - 1; i++) {
-        for (int j = 1; j < grid_size_(1) - 1; j++) {
-            cell0(0) = i;
-            cell0(1) = j;
-            if (projections_count_(i, j) == 0) {
-                empty_cells_tile_tmp_(0,k) = i; //may be done in a better way
-                empty_cells_tile_tmp_(1,k) = j;
-                k++;
-            }
-        }
-    }
-    if (k > 0) { // number of empty inner cells
-        int idx = rand() % k; // between 0 and k-1
-        _cell(0) = empty_cells_tile_tmp_(0, idx);
-        _cell(1) = empty_cells_tile_tmp_(1, idx);
-        return true;
-    }
-    else
+    if (empty_cells_.empty())
         return false;
+
+    int cell_index = empty_cells_[random_generator_() % empty_cells_.size()];
+    _cell(0) = cell_index % grid_size_(0);
+    _cell(1) = cell_index / grid_size_(0);
+    return true;
 }
 
 /*
@@ -105,6 +115,55 @@ void ActiveSearchGrid::blockCell(const cv::Rect & _roi)
     pix(1) = _roi.y+_roi.height/2;
     Eigen::Vector2i cell = coords2cell(pix(0), pix(1));
     projections_count_(cell(0), cell(1)) = -1;
+    removeEmptyCell(cell(0) + grid_size_(0) * cell(1));
+}
+
+bool ActiveSearchGrid::emptyRoiContains(const cv::KeyPoint& _pix, int& _cell_index)
+{
+    Eigen::Vector2i cell = coords2cell(_pix.pt.x, _pix.pt.y);
+    if (cell(0) < 1 || cell(1) < 1 || cell(0) >= grid_size_(0) - 1 || cell(1) >= grid_size_(1) - 1)
+        return false; // only inner cells
+    if (projections_count_(cell(0), cell(1)) != 0)
+        return false; // occupied or blocked
+
+    // inside the roi, i.e. away from the cell edges by the separation
+    Eigen::Vector2i cell0 = cellOrigin(cell);
+    if (_pix.pt.x < cell0(0) + separation_ || _pix.pt.x >= cell0(0) + cell_size_(0) - separation_ ||
+        _pix.pt.y < cell0(1) + separation_ || _pix.pt.y >= cell0(1) + cell_size_(1) - separation_)
+        return false;
+
+    _cell_index = cell(0) + grid_size_(0) * cell(1);
+    return true;
+}
+
+unsigned int ActiveSearchGrid::pickBestInEmptyRois(const std::vector<cv::KeyPoint>& _keypoints, unsigned int _max_keypoints,
+                                                   std::vector<unsigned int>& _selected)
+{
+    // best keypoint of each empty cell
+    best_in_cell_.assign(numCells(), -1);
+    int cell_index;
+    for (unsigned int i = 0; i < _keypoints.size(); i++)
+    {
+        if (emptyRoiContains(_keypoints[i], cell_index))
+        {
+            int& best = best_in_cell_[cell_index];
+            if (best < 0 || _keypoints[i].response > _keypoints[best].response)
+                best = i;
+        }
+    }
+
+    _selected.clear();
+    for (auto best : best_in_cell_)
+        if (best >= 0)
+            _selected.push_back(best);
+
+    // strongest first, up to the maximum
+    std::sort(_selected.begin(), _selected.end(),
+              [&_keypoints](unsigned int _a, unsigned int _b) { return _keypoints[_a].response > _keypoints[_b].response; });
+    if (_max_keypoints > 0 && _selected.size() > _max_keypoints)
+        _selected.resize(_max_keypoints);
+
+    return _selected.size();
 }
 
 /*
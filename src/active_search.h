@@ -17,6 +17,9 @@
 #include <opencv2/core/core.hpp>
 #include "opencv2/features2d/features2d.hpp"
 
+// std includes
+#include <random>
+
 namespace wolf{
 
         /**
@@ -54,6 +57,10 @@ namespace wolf{
          *
          *   \image html tesselationExample.png "A typical configuration of the tesselation grid"
          *
+         * The empty inner cells are kept in a list, updated by hitCell() and blockCell(),
+         * so that picking one of them at random takes constant time.
+         * The random numbers come from a generator owned by each grid, so that several grids can work concurrently.
+         *
          * Observe the figure and use the following facts as an operation guide:
          * - The grid is offset by a fraction of a cell size.
          *     - use renew() at each frame to clear the grid and set a new offset.
@@ -111,7 +118,10 @@ class ActiveSearchGrid {
         Eigen::Vector2i offset_;
         Eigen::Vector2i roi_coordinates_;
         Eigen::MatrixXi projections_count_;
-        Eigen::MatrixXi empty_cells_tile_tmp_;
+        std::vector<int> empty_cells_;          ///< linear indices of the empty inner cells
+        std::vector<int> empty_cell_position_;  ///< position of each cell in empty_cells_, -1 if not there
+        std::vector<int> best_in_cell_;         ///< workspace of pickBestInEmptyRois()
+        std::minstd_rand random_generator_;
         int separation_;
         int margin_;
 
@@ -183,6 +193,17 @@ class ActiveSearchGrid {
          */
         void hitCell(const cv::KeyPoint& _pix);
 
+        /**
+         * \brief Add a set of projected pixels to the grid.
+         * \param _pixels the pixels to add as cv::KeyPoints.
+         */
+        void hitCells(const std::vector<cv::KeyPoint>& _pixels);
+
+        /**
+         * \brief Seed the random generator of the grid offset and of pickRoi().
+         */
+        void seed(unsigned int _seed);
+
         /**
          * \brief Get ROI of a random empty cell.
          * \param _roi the resulting ROI
@@ -197,6 +218,33 @@ class ActiveSearchGrid {
          */
         void blockCell(const cv::Rect & _roi);
 
+        /**
+         * \brief Number of cells of the grid, including the outer ones.
+         */
+        int numCells() const;
+
+        /**
+         * \brief Get the empty inner cell whose ROI contains a pixel.
+         * \param _pix the pixel as a cv::KeyPoint.
+         * \param _cell_index the linear index of the cell, in [0, numCells()).
+         * \return true if the pixel lies inside the ROI of an empty inner cell.
+         *
+         * Use this to bucket the keypoints of a whole-image detection into the cells that pickRoi() would return.
+         */
+        bool emptyRoiContains(const cv::KeyPoint& _pix, int& _cell_index);
+
+        /**
+         * \brief Select the strongest keypoint in the ROI of each empty inner cell.
+         * \param _keypoints the keypoints of a whole-image detection.
+         * \param _max_keypoints maximum number of selected keypoints. 0 means no limit.
+         * \param _selected the indices of the selected keypoints in _keypoints, strongest first.
+         * \return the number of selected keypoints.
+         *
+         * This is the whole-image equivalent of looping over pickRoi() and keeping the best keypoint of each ROI.
+         */
+        unsigned int pickBestInEmptyRois(const std::vector<cv::KeyPoint>& _keypoints, unsigned int _max_keypoints,
+                                         std::vector<unsigned int>& _selected);
+
 
     private:
         /**
@@ -225,18 +273,42 @@ class ActiveSearchGrid {
          */
         void cell2roi(const Eigen::Vector2i & _cell, cv::Rect& _roi);
 
+        /**
+         * \brief Remove a cell from the list of empty cells, if it is there
+         */
+        void removeEmptyCell(int _cell_index);
+
 };
 
-inline void ActiveSearchGrid::clear()
+inline void ActiveSearchGrid::renew()
 {
-    projections_count_.setZero();
+    offset_(0) = -(margin_ + random_generator_() % (cell_size_(0) - 2 * margin_)); // from -margin to -(cellSize(0)-margin)
+    offset_(1) = -(margin_ + random_generator_() % (cell_size_(1) - 2 * margin_)); // from -margin to -(cellSize(0)-margin)
+    clear();
 }
 
-inline void ActiveSearchGrid::renew()
+inline void ActiveSearchGrid::seed(unsigned int _seed)
 {
-    offset_(0) = -(margin_ + rand() % (cell_size_(0) - 2 * margin_)); // from -margin to -(cellSize(0)-margin)
-    offset_(1) = -(margin_ + rand() % (cell_size_(1) - 2 * margin_)); // from -margin to -(cellSize(0)-margin)
-    clear();
+    random_generator_.seed(_seed);
+}
+
+inline void ActiveSearchGrid::removeEmptyCell(int _cell_index)
+{
+    int position = empty_cell_position_[_cell_index];
+    if (position < 0)
+        return;
+
+    // move the last empty cell to the removed position
+    int last_cell = empty_cells_.back();
+    empty_cells_[position] = last_cell;
+    empty_cell_position_[last_cell] = position;
+    empty_cells_.pop_back();
+    empty_cell_position_[_cell_index] = -1;
+}
+
+inline int ActiveSearchGrid::numCells() const
+{
+    return grid_size_(0) * grid_size_(1);
 }
 
 inline void ActiveSearchGrid::hitCell(const cv::KeyPoint& _pix)
@@ -270,6 +342,7 @@ inline void ActiveSearchGrid::hitCell(const Scalar _x, const Scalar _y)
         projections_count_(cell(0), cell(1)) = 0;
 
     projections_count_(cell(0), cell(1))++;
+    removeEmptyCell(cell(0) + grid_size_(0) * cell(1));
 }
 
 /**
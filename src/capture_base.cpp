@@ -2,7 +2,7 @@
 
 namespace wolf{
 
-unsigned int CaptureBase::capture_id_count_ = 0;
+std::atomic<unsigned int> CaptureBase::capture_id_count_(0);
 
 CaptureBase::CaptureBase(const TimeStamp& _ts, SensorBase* _sensor_ptr) :
         NodeLinked(MID, "CAPTURE"),
@@ -14,7 +14,7 @@ class SensorBase;
 #include "node_linked.h"
 
 //std includes
-//
+#include <atomic>
 
 namespace wolf{
 
@@ -23,7 +23,7 @@ namespace wolf{
 class CaptureBase : public NodeLinked<FrameBase, FeatureBase>
 {
     private:
-        static unsigned int capture_id_count_;
+        static std::atomic<unsigned int> capture_id_count_; ///< Atomic: Captures are created by the sensor driver threads
     protected:
         unsigned int capture_id_;
         TimeStamp time_stamp_; ///< Time stamp
@@ -1,10 +1,11 @@
 #include "capture_image.h"
 #include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
 
 namespace wolf {
 
 CaptureImage::CaptureImage(const TimeStamp& _ts, SensorCamera* _camera_ptr, cv::Mat _data_cv) :
-    CaptureBase(_ts, _camera_ptr), image_(_data_cv)
+    CaptureBase(_ts, _camera_ptr), image_(_data_cv), keypoints_detector_descriptor_ptr_(nullptr)
 {
     setType("IMAGE");
 }
@@ -19,14 +20,47 @@ const cv::Mat & CaptureImage::getImage() const
     return image_;
 }
 
+const cv::Mat& CaptureImage::getGrayImage()
+{
+    if (image_gray_.empty())
+    {
+        if (image_.channels() == 1)
+            image_gray_ = image_;
+        else
+            cv::cvtColor(image_, image_gray_, CV_BGR2GRAY);
+    }
+    return image_gray_;
+}
+
+bool CaptureImage::hasKeypoints(const cv::Feature2D* _detector_descriptor_ptr) const
+{
+    return keypoints_detector_descriptor_ptr_ != nullptr && keypoints_detector_descriptor_ptr_ == _detector_descriptor_ptr;
+}
+
+void CaptureImage::describe(cv::Feature2D* _detector_descriptor_ptr)
+{
+    if (hasKeypoints(_detector_descriptor_ptr))
+        return;
+
+    // new descriptors: the Features of a previous detection keep rows of the old ones
+    descriptors_.release();
+
+    // the descriptor may drop some keypoints, e.g. too close to the image border, so that both stay aligned
+    _detector_descriptor_ptr->detect(getGrayImage(), keypoints_);
+    _detector_descriptor_ptr->compute(getGrayImage(), keypoints_, descriptors_);
+    keypoints_detector_descriptor_ptr_ = _detector_descriptor_ptr;
+}
+
 void CaptureImage::setDescriptors(const cv::Mat& _descriptors)
 {
     descriptors_ = _descriptors;
+    keypoints_detector_descriptor_ptr_ = nullptr;
 }
 
 void CaptureImage::setKeypoints(const std::vector<cv::KeyPoint> &_keypoints)
 {
     keypoints_ = _keypoints;
+    keypoints_detector_descriptor_ptr_ = nullptr;
 }
 
 cv::Mat& CaptureImage::getDescriptors()
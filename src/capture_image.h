@@ -8,6 +8,7 @@
 
 // opencv includes
 #include <opencv2/core/core.hpp>
+#include <opencv2/features2d/features2d.hpp>
 
 //std includes
 //
@@ -24,8 +25,10 @@ class CaptureImage : public CaptureBase
 {
     protected:
         cv::Mat image_;
-        cv::Mat descriptors_;
+        cv::Mat image_gray_; ///< grayscale image, computed on first use
+        cv::Mat descriptors_; ///< one descriptor per keypoint, one per row. The Features keep rows of it, sharing its memory
         std::vector<cv::KeyPoint> keypoints_;
+        const cv::Feature2D* keypoints_detector_descriptor_ptr_; ///< detector-descriptor of keypoints_ and descriptors_. nullptr: none
 
     public:
         CaptureImage(const TimeStamp& _ts, SensorCamera* _camera_ptr, cv::Mat _data_cv);
@@ -37,6 +40,24 @@ class CaptureImage : public CaptureBase
         virtual ~CaptureImage();
 
         virtual const cv::Mat& getImage() const;
+
+        /** \brief Grayscale image, converted once and cached
+         *
+         * Detectors and descriptors work on grayscale images, and would otherwise convert the image at each call.
+         * ROIs of it are cv::Mat views, so that cropping them does not copy pixels.
+         */
+        const cv::Mat& getGrayImage();
+
+        /** \brief Whether the keypoints and descriptors of the whole image are already computed by a detector-descriptor
+         *
+         * An image where the detector found no keypoint is also computed.
+         */
+        bool hasKeypoints(const cv::Feature2D* _detector_descriptor_ptr) const;
+
+        /** \brief Detect and describe the keypoints of the whole image, unless already done with the same detector-descriptor
+         */
+        void describe(cv::Feature2D* _detector_descriptor_ptr);
+
         virtual void setDescriptors(const cv::Mat &_descriptors);
         virtual void setKeypoints(const std::vector<cv::KeyPoint>& _keypoints);
         virtual cv::Mat& getDescriptors();
@@ -1,16 +1,49 @@
 #include "capture_laser_2D.h"
+#include "sensor_laser_2D.h"
 
 namespace wolf {
 
 CaptureLaser2D::CaptureLaser2D(const TimeStamp& _ts, SensorBase* _sensor_ptr, const std::vector<float>& _ranges) :
-        CaptureBase(_ts, _sensor_ptr), laser_ptr_((SensorLaser2D*)(sensor_ptr_)), scan_(_ranges)
+        CaptureBase(_ts, _sensor_ptr), laser_ptr_((SensorLaser2D*)(sensor_ptr_)), scan_ptr_(nullptr)
 {
     setType("LASER 2D");
+    acquireScan();
+    scan_ptr_->ranges_raw_.assign(_ranges.begin(), _ranges.end());
+}
+
+CaptureLaser2D::CaptureLaser2D(const TimeStamp& _ts, SensorBase* _sensor_ptr, const float* _ranges, unsigned int _n_ranges) :
+        CaptureBase(_ts, _sensor_ptr), laser_ptr_((SensorLaser2D*)(sensor_ptr_)), scan_ptr_(nullptr)
+{
+    setType("LASER 2D");
+    acquireScan();
+    scan_ptr_->ranges_raw_.assign(_ranges, _ranges + _n_ranges);
+}
+
+CaptureLaser2D::CaptureLaser2D(const TimeStamp& _ts, SensorBase* _sensor_ptr, std::vector<float>&& _ranges) :
+        CaptureBase(_ts, _sensor_ptr), laser_ptr_((SensorLaser2D*)(sensor_ptr_)), scan_ptr_(nullptr)
+{
+    setType("LASER 2D");
+    acquireScan();
+    scan_ptr_->ranges_raw_.swap(_ranges);
 }
 
 CaptureLaser2D::~CaptureLaser2D()
 {
-    //
+    if (scan_pool_ptr_)
+        scan_pool_ptr_->release(scan_ptr_);
+    else
+        delete scan_ptr_;
+}
+
+void CaptureLaser2D::acquireScan()
+{
+    if (laser_ptr_ != nullptr)
+    {
+        scan_pool_ptr_ = laser_ptr_->getScanPool();
+        scan_ptr_ = scan_pool_ptr_->acquire();
+    }
+    else
+        scan_ptr_ = new laserscanutils::LaserScan();
 }
 
 } // namespace wolf
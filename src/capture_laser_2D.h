@@ -1,4 +1,3 @@
-
 #ifndef CAPTURE_LASER_2D_H_
 #define CAPTURE_LASER_2D_H_
 
@@ -6,12 +5,24 @@
 
 //wolf includes
 #include "capture_base.h"
+#include "laser_scan_pool.h"
 
 //laserscanutils includes
 #include "laser_scan_utils/laser_scan.h"
 
 namespace wolf {
 
+/** \brief Capture of a 2D laser scan
+ *
+ * The scan is taken from the scan pool of the sensor (see SensorLaser2D::getScanPool()),
+ * and is given back to it when the capture is destroyed.
+ * The ranges can be handed over in three ways:
+ *   - copied from a std::vector
+ *   - copied from an externally owned buffer, e.g. the driver's one, without any intermediate vector
+ *   - moved from a std::vector, without copy
+ *
+ * Copies go into the recycled buffers of the pooled scan, so they do not allocate.
+ */
 class CaptureLaser2D : public CaptureBase
 {
     public:
@@ -19,6 +30,19 @@ class CaptureLaser2D : public CaptureBase
          **/
         CaptureLaser2D(const TimeStamp& _ts, SensorBase* _sensor_ptr, const std::vector<float>& _ranges);
 
+        /** \brief Constructor with an external buffer of ranges
+         *
+         * \param _ranges pointer to the first range. The buffer is still owned by the caller.
+         * \param _n_ranges number of ranges in the buffer.
+         **/
+        CaptureLaser2D(const TimeStamp& _ts, SensorBase* _sensor_ptr, const float* _ranges, unsigned int _n_ranges);
+
+        /** \brief Constructor taking the ownership of the ranges
+         *
+         * \param _ranges ranges, moved into the scan. On return, it holds the previous buffer of the recycled scan.
+         **/
+        CaptureLaser2D(const TimeStamp& _ts, SensorBase* _sensor_ptr, std::vector<float>&& _ranges);
+
         /** \brief Default destructor (not recommended)
          *
          * Default destructor (please use destruct() instead of delete for guaranteeing the wolf tree integrity)
@@ -29,13 +53,16 @@ class CaptureLaser2D : public CaptureBase
 
     private:
         SensorLaser2D* laser_ptr_; //specific pointer to sensor laser 2D object
-        laserscanutils::LaserScan scan_;
+        LaserScanPoolPtr scan_pool_ptr_;
+        laserscanutils::LaserScan* scan_ptr_;
+
+        void acquireScan();
 
 };
 
 inline laserscanutils::LaserScan& CaptureLaser2D::getScan()
 {
-    return scan_;
+    return *scan_ptr_;
 }
 
 } // namespace wolf
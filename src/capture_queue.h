@@ -0,0 +1,143 @@
+/**
+ * \file capture_queue.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_CAPTURE_QUEUE_H_
+#define SRC_CAPTURE_QUEUE_H_
+
+// Fwd refs
+namespace wolf{
+class CaptureBase;
+}
+
+// STL
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+namespace wolf {
+
+/** \brief Lock-free single-producer single-consumer queue of Captures.
+ *
+ * This queue hands Captures over from one thread to another without locks:
+ *   - The producer is typically the sensor driver, which acquires the raw data and
+ *     creates the Capture at the sensor rate. It calls push().
+ *   - The consumer is the thread owning the wolf Problem, which pops the Captures
+ *     and processes them, in arrival order, whenever it is ready to do so. It calls pop().
+ *
+ * Only one thread may push and only one thread may pop. All other functions are approximate
+ * when called while the other thread is operating on the queue.
+ *
+ * The queue is a ring buffer of fixed capacity. When it is full, push() fails
+ * and the Capture remains owned by the producer.
+ */
+class CaptureQueue
+{
+    public:
+        /** \brief Constructor
+         * \param _capacity maximum number of Captures that can be waiting in the queue.
+         */
+        CaptureQueue(unsigned int _capacity = 8);
+        ~CaptureQueue();
+
+        CaptureQueue(const CaptureQueue&) = delete;
+        CaptureQueue& operator=(const CaptureQueue&) = delete;
+
+        /** \brief Push a Capture at the back of the queue. Producer side only.
+         * \return false if the queue is full, and the Capture was not pushed.
+         */
+        bool push(CaptureBase* _capture_ptr);
+
+        /** \brief Pop the Capture at the front of the queue. Consumer side only.
+         * \return the oldest Capture in the queue, or nullptr if the queue is empty.
+         */
+        CaptureBase* pop();
+
+        /** \brief Peek the Capture at the front of the queue, without popping it. Consumer side only.
+         * \return the oldest Capture in the queue, or nullptr if the queue is empty.
+         */
+        CaptureBase* front() const;
+
+        bool empty() const;
+        unsigned int size() const;
+        unsigned int capacity() const;
+
+    private:
+        std::vector<CaptureBase*> buffer_;  ///< Ring buffer, with one extra slot to tell full from empty.
+        std::atomic<unsigned int> head_;    ///< Next slot to pop. Written by the consumer only.
+        std::atomic<unsigned int> tail_;    ///< Next slot to push. Written by the producer only.
+
+        unsigned int next(unsigned int _index) const;
+};
+
+inline CaptureQueue::CaptureQueue(unsigned int _capacity) :
+        buffer_(_capacity + 1, nullptr), head_(0), tail_(0)
+{
+    assert(_capacity > 0 && "CaptureQueue: capacity must be at least 1");
+}
+
+inline CaptureQueue::~CaptureQueue()
+{
+    // Captures still waiting are not owned by the queue: it is the user's responsibility to pop them.
+}
+
+inline bool CaptureQueue::push(CaptureBase* _capture_ptr)
+{
+    unsigned int tail = tail_.load(std::memory_order_relaxed);
+    unsigned int tail_next = next(tail);
+    if (tail_next == head_.load(std::memory_order_acquire))
+        return false; // full
+
+    buffer_[tail] = _capture_ptr;
+    tail_.store(tail_next, std::memory_order_release);
+    return true;
+}
+
+inline CaptureBase* CaptureQueue::pop()
+{
+    unsigned int head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+        return nullptr; // empty
+
+    CaptureBase* capture_ptr = buffer_[head];
+    head_.store(next(head), std::memory_order_release);
+    return capture_ptr;
+}
+
+inline CaptureBase* CaptureQueue::front() const
+{
+    unsigned int head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+        return nullptr; // empty
+
+    return buffer_[head];
+}
+
+inline bool CaptureQueue::empty() const
+{
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+}
+
+inline unsigned int CaptureQueue::size() const
+{
+    unsigned int head = head_.load(std::memory_order_acquire);
+    unsigned int tail = tail_.load(std::memory_order_acquire);
+    return (tail + buffer_.size() - head) % buffer_.size();
+}
+
+inline unsigned int CaptureQueue::capacity() const
+{
+    return buffer_.size() - 1;
+}
+
+inline unsigned int CaptureQueue::next(unsigned int _index) const
+{
+    return (_index + 1) % buffer_.size();
+}
+
+} // namespace wolf
+
+#endif /* SRC_CAPTURE_QUEUE_H_ */
@@ -50,6 +50,9 @@ ceres::Solver::Summary CeresManager::solve()
 	// run Ceres Solver
 	ceres::Solve(ceres_options_, ceres_problem_, &ceres_summary_);
 
+    // re-index the landmarks moved by the solver
+    wolf_problem_->getMapPtr()->updateLandmarkIndex();
+
 	//return results
 	return ceres_summary_;
 }
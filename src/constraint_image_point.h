@@ -0,0 +1,212 @@
+/**
+ * \file constraint_image_point.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef CONSTRAINT_IMAGE_POINT_H_
+#define CONSTRAINT_IMAGE_POINT_H_
+
+//Wolf includes
+#include "constraint_analytic.h"
+#include "landmark_base.h"
+#include "sensor_camera.h"
+#include "state_block.h"
+#include "pinholeTools.h"
+
+namespace wolf {
+
+/** \brief Reprojection error of a 3D point landmark in a pin-hole camera
+ *
+ * The landmark is either a Euclidean point (EP), with a position state block of size 3,
+ * or a homogeneous point (HP), with a StateHomogeneous3D of size 4. The constraint type,
+ * CTR_IMG_PNT_TO_EP or CTR_IMG_PNT_TO_HP, follows from the size of the landmark state block.
+ *
+ * The state blocks are, in this order:
+ *   - 0: frame position, size 3
+ *   - 1: frame orientation, a quaternion of size 4
+ *   - 2: landmark position, size 3 (EP) or 4 (HP)
+ *
+ * The landmark block goes last, so that the solver can eliminate the landmarks first (Schur complement)
+ * and solve for the frames with the reduced camera system.
+ *
+ * The camera extrinsic and intrinsic parameters are taken from the sensor of the feature's Capture,
+ * and are not estimated here.
+ *
+ * The expectation of a landmark with homogeneous position h = [m ; w] is the projection of the vector
+ *
+ *   v = R_rc^T * ( R_wr^T * (m - t_wr * w) - t_rc * w )
+ *
+ * where (t_wr, R_wr) is the frame pose and (t_rc, R_rc) the camera pose in the frame.
+ * A Euclidean landmark is the case w = 1. Its Jacobians are analytic, built with the pinhole::projectPoint() chain.
+ */
+class ConstraintImagePoint : public ConstraintAnalytic
+{
+    protected:
+        SensorCamera* camera_ptr_;
+
+    public:
+
+        /** \brief Constructor of category CTR_LANDMARK
+         **/
+        ConstraintImagePoint(FeatureBase* _ftr_ptr, LandmarkBase* _landmark_ptr, bool _apply_loss_function = false, ConstraintStatus _status = CTR_ACTIVE) :
+            ConstraintAnalytic(_ftr_ptr, _landmark_ptr->getPPtr()->getSize() == 4 ? CTR_IMG_PNT_TO_HP : CTR_IMG_PNT_TO_EP,
+                               _landmark_ptr, _apply_loss_function, _status,
+                               _ftr_ptr->getFramePtr()->getPPtr(), _ftr_ptr->getFramePtr()->getOPtr(), _landmark_ptr->getPPtr()),
+            camera_ptr_((SensorCamera*)(_ftr_ptr->getCapturePtr()->getSensorPtr()))
+        {
+            assert((_landmark_ptr->getPPtr()->getSize() == 3 || _landmark_ptr->getPPtr()->getSize() == 4) && "Landmark must be a 3D Euclidean or homogeneous point");
+            setType("IMAGE POINT");
+        }
+
+        /** \brief Default destructor (not recommended)
+         *
+         * Default destructor (please use destruct() instead of delete for guaranteeing the wolf tree integrity)
+         **/
+        virtual ~ConstraintImagePoint()
+        {
+            //
+        }
+
+        /** \brief Returns the constraint residual size
+         **/
+        virtual unsigned int getSize() const
+        {
+            return 2;
+        }
+
+        /** \brief Returns the residual evaluated in the states provided
+         *
+         * Returns the residual evaluated in the states provided in a std::vector of mapped Eigen::VectorXs
+         **/
+        virtual Eigen::VectorXs evaluateResiduals(const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector) const;
+
+        /** \brief Returns the jacobians evaluated in the states provided
+         *
+         * Returns the jacobians evaluated in the states provided in std::vector of mapped Eigen::VectorXs.
+         * IMPORTANT: only fill the jacobians of the state blocks specified in _compute_jacobian.
+         *
+         * The jacobians are w.r.t. the global parameters of the state blocks, i.e. the 4 quaternion coefficients
+         * and the 4 homogeneous coordinates. The local parametrizations project them onto the tangent space.
+         *
+         * \param _st_vector is a vector containing the mapped eigen vectors of all state blocks involved in the constraint
+         * \param jacobians is an output vector of mapped eigen matrices that sould contain the jacobians w.r.t each state block
+         * \param _compute_jacobian is a vector that specifies whether the ith jacobian sould be computed or not
+         **/
+        virtual void evaluateJacobians(const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector,
+                                       std::vector<Eigen::Map<Eigen::MatrixXs> >& jacobians,
+                                       const std::vector<bool>& _compute_jacobian) const;
+
+        /** \brief Returns the pure jacobians (without measurement noise) evaluated in the state blocks values
+         * \param jacobians is an output vector of matrices with the jacobians w.r.t each state block
+         **/
+        virtual void evaluatePureJacobians(std::vector<Eigen::MatrixXs>& jacobians) const;
+
+        /** \brief Returns the jacobians computation method
+         **/
+        virtual JacobianMethod getJacobianMethod() const
+        {
+            return JAC_ANALYTIC;
+        }
+
+        /** \brief Expected measurement, and its pure jacobians w.r.t. the state blocks
+         * \param _p_wr frame position
+         * \param _q_wr frame orientation quaternion, as [x, y, z, w]
+         * \param _lmk landmark position, Euclidean of size 3 or homogeneous of size 4
+         * \param _u expected pixel
+         * \param _U_p, _U_q, _U_l jacobians of \a _u w.r.t. \a _p_wr, \a _q_wr and \a _lmk, computed only if \a _jacobians is true
+         */
+        void expectation(const Eigen::VectorXs& _p_wr, const Eigen::VectorXs& _q_wr, const Eigen::VectorXs& _lmk,
+                         Eigen::Vector2s& _u, Eigen::MatrixXs& _U_p, Eigen::MatrixXs& _U_q, Eigen::MatrixXs& _U_l,
+                         bool _jacobians = true) const;
+};
+
+
+/// IMPLEMENTATION ///
+
+inline void ConstraintImagePoint::expectation(const Eigen::VectorXs& _p_wr, const Eigen::VectorXs& _q_wr,
+                                              const Eigen::VectorXs& _lmk, Eigen::Vector2s& _u, Eigen::MatrixXs& _U_p,
+                                              Eigen::MatrixXs& _U_q, Eigen::MatrixXs& _U_l, bool _jacobians) const
+{
+    // Camera
+    Eigen::Vector4s k = camera_ptr_->getIntrinsicPtr()->getVector();
+    Eigen::VectorXs d = camera_ptr_->getDistortionVector();
+    Eigen::Vector3s t_rc = camera_ptr_->getPPtr()->getVector();
+    Eigen::Matrix3s R_rc = Eigen::Map<const Eigen::Quaternions>(camera_ptr_->getOPtr()->getPtr()).toRotationMatrix();
+
+    // Landmark in the frame, then in the camera
+    Eigen::Map<const Eigen::Quaternions> q_wr(_q_wr.data());
+    Eigen::Matrix3s R_wr = q_wr.toRotationMatrix();
+    Scalar w = (_lmk.size() == 4 ? _lmk(3) : 1);
+    Eigen::Vector3s a = _lmk.head<3>() - _p_wr.head<3>() * w;
+    Eigen::Vector3s v = R_rc.transpose() * (R_wr.transpose() * a - t_rc * w);
+
+    if (!_jacobians)
+    {
+        _u = pinhole::projectPoint(k, d, v);
+        return;
+    }
+
+    Eigen::MatrixXs U_v(2, 3);
+    pinhole::projectPoint(k, d, v, _u, U_v);
+    Eigen::Matrix<Scalar, 2, 3> U_r = U_v * R_rc.transpose(); // Jacobian w.r.t. the landmark expressed in the frame
+    Eigen::Matrix<Scalar, 2, 3> U_a = U_r * R_wr.transpose();
+
+    // Frame position
+    _U_p = -w * U_a;
+
+    // Frame orientation: derivative of R(q)^T * a w.r.t. q = [qv ; qw]
+    //   d/dqv = 2 * (qv'a * I + qv a' - a qv' + qw [a]x)
+    //   d/dqw = 2 * (qw a - qv x a)
+    Eigen::Vector3s qv = _q_wr.head<3>();
+    Scalar qw = _q_wr(3);
+    Eigen::Matrix3s a_x;
+    a_x << 0, -a(2), a(1), a(2), 0, -a(0), -a(1), a(0), 0;
+    Eigen::Matrix<Scalar, 3, 4> Ra_q;
+    Ra_q.leftCols<3>() = 2 * (qv.dot(a) * Eigen::Matrix3s::Identity() + qv * a.transpose() - a * qv.transpose() + qw * a_x);
+    Ra_q.col(3) = 2 * (qw * a - qv.cross(a));
+    _U_q = U_r * Ra_q;
+
+    // Landmark
+    _U_l.resize(2, _lmk.size());
+    _U_l.leftCols(3) = U_a;
+    if (_lmk.size() == 4)
+        _U_l.col(3) = -U_r * (R_wr.transpose() * _p_wr.head<3>() + t_rc);
+}
+
+inline Eigen::VectorXs ConstraintImagePoint::evaluateResiduals(
+        const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector) const
+{
+    Eigen::Vector2s u;
+    Eigen::MatrixXs U_p, U_q, U_l;
+    expectation(_st_vector[0], _st_vector[1], _st_vector[2], u, U_p, U_q, U_l, false);
+    return getMeasurementSquareRootInformation() * (u - getMeasurement());
+}
+
+inline void ConstraintImagePoint::evaluateJacobians(const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector,
+                                                    std::vector<Eigen::Map<Eigen::MatrixXs> >& jacobians,
+                                                    const std::vector<bool>& _compute_jacobian) const
+{
+    Eigen::Vector2s u;
+    Eigen::MatrixXs U_p, U_q, U_l;
+    expectation(_st_vector[0], _st_vector[1], _st_vector[2], u, U_p, U_q, U_l);
+    if (_compute_jacobian[0])
+        jacobians[0] = getMeasurementSquareRootInformation() * U_p;
+    if (_compute_jacobian[1])
+        jacobians[1] = getMeasurementSquareRootInformation() * U_q;
+    if (_compute_jacobian[2])
+        jacobians[2] = getMeasurementSquareRootInformation() * U_l;
+}
+
+inline void ConstraintImagePoint::evaluatePureJacobians(std::vector<Eigen::MatrixXs>& jacobians) const
+{
+    Eigen::Vector2s u;
+    jacobians.resize(3);
+    expectation(getStatePtrVector()[0]->getVector(), getStatePtrVector()[1]->getVector(),
+                getStatePtrVector()[2]->getVector(), u, jacobians[0], jacobians[1], jacobians[2]);
+}
+
+} // namespace wolf
+
+#endif /* CONSTRAINT_IMAGE_POINT_H_ */
@@ -0,0 +1,389 @@
+/**
+ * \file correlative_scan_matcher_2D.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef CORRELATIVE_SCAN_MATCHER_2D_H_
+#define CORRELATIVE_SCAN_MATCHER_2D_H_
+
+//wolf
+#include "wolf.h"
+
+//std
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace wolf
+{
+
+struct ScanMatcherParams2D
+{
+        Scalar resolution;      ///< cell size of the grid, in meters
+        Scalar hit_std_dev;     ///< std deviation of the hit likelihood around each map point, in meters
+        Scalar linear_window;   ///< half size of the searched window in x and y, in meters
+        Scalar angular_window;  ///< half size of the searched window in orientation, in radians
+        unsigned int n_levels;  ///< number of coarse levels of the branch-and-bound search. 0: exhaustive search
+        Scalar min_score;       ///< minimum score, in [0,1], to accept a match
+};
+
+/** \brief Multi-resolution 2D likelihood grid
+ *
+ * Level 0 stores the likelihood of hitting each cell, built from a set of points.
+ * Level k stores, at each cell (x,y), the maximum of level 0 over the 2^k x 2^k cells starting at (x,y).
+ * This makes level k an upper bound of the score of any offset within a 2^k x 2^k block of offsets,
+ * which is what the branch-and-bound search of CorrelativeScanMatcher2D needs.
+ *
+ * Cells are floats stored contiguously, row by row.
+ */
+class ProbabilityGrid2D
+{
+    public:
+        /** \brief Constructor
+         * \param _resolution cell size, in meters
+         * \param _hit_std_dev std deviation of the hit likelihood around each point, in meters
+         */
+        ProbabilityGrid2D(const Scalar& _resolution, const Scalar& _hit_std_dev);
+
+        /** \brief Clear the grid and set its bounds
+         * \param _min lower corner of the area where points will be inserted, in meters
+         * \param _max upper corner of the area where points will be inserted, in meters
+         * \param _n_levels number of levels above level 0
+         *
+         * The grid is padded with empty cells around these bounds,
+         * so that any block of any level starting outside the grid is empty.
+         */
+        void reset(const Eigen::Vector2s& _min, const Eigen::Vector2s& _max, const unsigned int& _n_levels);
+
+        /** \brief Add hits at the given points
+         * \param _points 2xN points, in the grid frame, inside the bounds given to reset().
+         */
+        void insertPoints(const Eigen::Ref<const Eigen::Matrix<Scalar, 2, Eigen::Dynamic> >& _points);
+
+        /** \brief Compute levels 1 and up from level 0. Call it after inserting all points.
+         */
+        void computeLevels();
+
+        int cellX(const Scalar& _x) const;
+        int cellY(const Scalar& _y) const;
+        float value(const unsigned int& _level, const int& _ix, const int& _iy) const;
+
+        const Scalar& getResolution() const;
+        unsigned int getNLevels() const;
+
+    private:
+        Scalar resolution_;
+        Scalar hit_std_dev_;
+        int hit_radius_;         ///< radius of the hit kernel, in cells
+        Eigen::Vector2s origin_; ///< position of the corner of cell (0,0)
+        int width_, height_;
+        std::vector<std::vector<float> > levels_;
+};
+
+/** \brief Correlative scan matcher with branch-and-bound search
+ *
+ * Registers a scan against a ProbabilityGrid2D, by exhaustive search of the pose maximizing
+ * the average likelihood of the scan points in a window around an initial guess.
+ * The search is exact at the grid resolution, but most of the window is pruned
+ * using the upper bounds of the coarser levels of the grid.
+ *
+ * For each searched orientation, the scan is rotated and discretized once into a table of cells,
+ * so that scoring one candidate is a sum of grid values at integer offsets of that table.
+ */
+class CorrelativeScanMatcher2D
+{
+    public:
+        CorrelativeScanMatcher2D(const ScanMatcherParams2D& _params);
+
+        ProbabilityGrid2D& getGrid();
+        const ScanMatcherParams2D& getParams() const;
+
+        /** \brief Match a scan against the grid
+         * \param _points 2xN scan points, in the scan frame.
+         * \param _pose_guess initial guess of the pose of the scan frame in the grid frame: x, y, theta.
+         * \param _pose returned pose of the scan frame in the grid frame.
+         * \param _score returned score of the pose, in [0,1].
+         * \return true if a pose with a score of at least params.min_score was found.
+         */
+        bool match(const Eigen::Ref<const Eigen::Matrix<Scalar, 2, Eigen::Dynamic> >& _points,
+                   const Eigen::Vector3s& _pose_guess, Eigen::Vector3s& _pose, Scalar& _score);
+
+    private:
+        struct Candidate
+        {
+                int angle_index;
+                int dx, dy;
+                Scalar score;
+                bool operator<(const Candidate& _other) const { return score > _other.score; } // best first
+        };
+
+        ScanMatcherParams2D params_;
+        ProbabilityGrid2D grid_;
+
+        // Discretized rotated scans, one block of n_points_ cells per angle
+        unsigned int n_points_;
+        std::vector<Scalar> angles_;
+        std::vector<int> scan_cells_x_, scan_cells_y_;
+        int window_cells_;
+
+        // Candidates of each level, kept to avoid reallocations
+        std::vector<std::vector<Candidate> > candidates_;
+        Candidate best_;
+
+        void discretizeScans(const Eigen::Ref<const Eigen::Matrix<Scalar, 2, Eigen::Dynamic> >& _points,
+                             const Eigen::Vector3s& _pose_guess);
+        Scalar score(const unsigned int& _level, const Candidate& _candidate) const;
+        void search(const unsigned int& _level);
+};
+
+inline ProbabilityGrid2D::ProbabilityGrid2D(const Scalar& _resolution, const Scalar& _hit_std_dev) :
+        resolution_(_resolution), hit_std_dev_(_hit_std_dev), hit_radius_(std::ceil(3 * _hit_std_dev / _resolution)),
+        origin_(Eigen::Vector2s::Zero()), width_(0), height_(0)
+{
+    assert(_resolution > 0 && "ProbabilityGrid2D: resolution must be positive");
+    assert(_hit_std_dev > 0 && "ProbabilityGrid2D: hit std deviation must be positive");
+}
+
+inline void ProbabilityGrid2D::reset(const Eigen::Vector2s& _min, const Eigen::Vector2s& _max,
+                                     const unsigned int& _n_levels)
+{
+    // the hit kernel spreads up to hit_radius_ cells, and blocks span up to 2^_n_levels cells
+    const int pad = hit_radius_ + (1 << _n_levels);
+    origin_ = _min - Eigen::Vector2s::Constant(pad * resolution_);
+    width_ = std::ceil((_max(0) - _min(0)) / resolution_) + 2 * pad + 1;
+    height_ = std::ceil((_max(1) - _min(1)) / resolution_) + 2 * pad + 1;
+    levels_.resize(_n_levels + 1);
+    for (auto& level : levels_)
+        level.assign(width_ * height_, 0.0f); // keeps capacity
+}
+
+inline void ProbabilityGrid2D::insertPoints(const Eigen::Ref<const Eigen::Matrix<Scalar, 2, Eigen::Dynamic> >& _points)
+{
+    std::vector<float>& cells = levels_[0];
+    const int radius = hit_radius_;
+    const Scalar k = -0.5 * resolution_ * resolution_ / (hit_std_dev_ * hit_std_dev_);
+    for (unsigned int i = 0; i < _points.cols(); i++)
+    {
+        // offset of the point w.r.t. its cell center, in cells
+        Scalar fx = (_points(0, i) - origin_(0)) / resolution_;
+        Scalar fy = (_points(1, i) - origin_(1)) / resolution_;
+        int cx = std::floor(fx);
+        int cy = std::floor(fy);
+        fx -= cx + 0.5;
+        fy -= cy + 0.5;
+        for (int iy = std::max(cy - radius, 0); iy <= std::min(cy + radius, height_ - 1); iy++)
+            for (int ix = std::max(cx - radius, 0); ix <= std::min(cx + radius, width_ - 1); ix++)
+            {
+                Scalar ex = ix - cx - fx;
+                Scalar ey = iy - cy - fy;
+                float p = std::exp(k * (ex * ex + ey * ey));
+                float& cell = cells[iy * width_ + ix];
+                if (p > cell)
+                    cell = p;
+            }
+    }
+}
+
+inline void ProbabilityGrid2D::computeLevels()
+{
+    // the 2^k block at (x,y) is the union of four 2^(k-1) blocks at (x,y), (x+s,y), (x,y+s), (x+s,y+s)
+    for (unsigned int k = 1; k < levels_.size(); k++)
+    {
+        const int s = 1 << (k - 1);
+        const std::vector<float>& prev = levels_[k - 1];
+        std::vector<float>& cells = levels_[k];
+        for (int iy = 0; iy < height_; iy++)
+            for (int ix = 0; ix < width_; ix++)
+            {
+                float m = prev[iy * width_ + ix];
+                if (ix + s < width_)
+                    m = std::max(m, prev[iy * width_ + ix + s]);
+                if (iy + s < height_)
+                {
+                    m = std::max(m, prev[(iy + s) * width_ + ix]);
+                    if (ix + s < width_)
+                        m = std::max(m, prev[(iy + s) * width_ + ix + s]);
+                }
+                cells[iy * width_ + ix] = m;
+            }
+    }
+}
+
+inline int ProbabilityGrid2D::cellX(const Scalar& _x) const
+{
+    return std::floor((_x - origin_(0)) / resolution_);
+}
+
+inline int ProbabilityGrid2D::cellY(const Scalar& _y) const
+{
+    return std::floor((_y - origin_(1)) / resolution_);
+}
+
+inline float ProbabilityGrid2D::value(const unsigned int& _level, const int& _ix, const int& _iy) const
+{
+    // blocks starting outside the grid only cover padding cells, see reset()
+    if (_ix < 0 || _iy < 0 || _ix >= width_ || _iy >= height_)
+        return 0.0f;
+    return levels_[_level][_iy * width_ + _ix];
+}
+
+inline const Scalar& ProbabilityGrid2D::getResolution() const
+{
+    return resolution_;
+}
+
+inline unsigned int ProbabilityGrid2D::getNLevels() const
+{
+    return levels_.size();
+}
+
+inline CorrelativeScanMatcher2D::CorrelativeScanMatcher2D(const ScanMatcherParams2D& _params) :
+        params_(_params), grid_(_params.resolution, _params.hit_std_dev), n_points_(0), window_cells_(0)
+{
+    best_.score = 0;
+}
+
+inline ProbabilityGrid2D& CorrelativeScanMatcher2D::getGrid()
+{
+    return grid_;
+}
+
+inline const ScanMatcherParams2D& CorrelativeScanMatcher2D::getParams() const
+{
+    return params_;
+}
+
+inline bool CorrelativeScanMatcher2D::match(const Eigen::Ref<const Eigen::Matrix<Scalar, 2, Eigen::Dynamic> >& _points,
+                                            const Eigen::Vector3s& _pose_guess, Eigen::Vector3s& _pose,
+                                            Scalar& _score)
+{
+    _pose = _pose_guess;
+    _score = 0;
+    if (_points.cols() == 0 || grid_.getNLevels() < params_.n_levels + 1)
+        return false;
+
+    discretizeScans(_points, _pose_guess);
+
+    // Level 0 blocks are single offsets; the top level blocks tile the whole window
+    const unsigned int top = params_.n_levels;
+    const int block = 1 << top;
+    candidates_.resize(top + 1);
+    std::vector<Candidate>& candidates = candidates_[top];
+    candidates.clear();
+    Candidate c;
+    for (c.angle_index = 0; c.angle_index < (int)angles_.size(); c.angle_index++)
+        for (c.dx = -window_cells_; c.dx <= window_cells_; c.dx += block)
+            for (c.dy = -window_cells_; c.dy <= window_cells_; c.dy += block)
+            {
+                c.score = score(top, c);
+                candidates.push_back(c);
+            }
+    std::sort(candidates.begin(), candidates.end());
+
+    // Only poses better than the minimum score are of interest
+    best_.score = params_.min_score;
+    best_.angle_index = -1;
+    search(top);
+
+    if (best_.angle_index < 0)
+        return false;
+
+    _pose(0) = _pose_guess(0) + best_.dx * grid_.getResolution();
+    _pose(1) = _pose_guess(1) + best_.dy * grid_.getResolution();
+    _pose(2) = pi2pi(_pose_guess(2) + angles_[best_.angle_index]);
+    _score = best_.score;
+    return true;
+}
+
+inline void CorrelativeScanMatcher2D::discretizeScans(const Eigen::Ref<const Eigen::Matrix<Scalar, 2, Eigen::Dynamic> >& _points,
+                                                      const Eigen::Vector3s& _pose_guess)
+{
+    n_points_ = _points.cols();
+    window_cells_ = std::ceil(params_.linear_window / grid_.getResolution());
+
+    // angular step so that the farthest point moves at most one cell
+    Scalar max_range = std::sqrt(_points.colwise().squaredNorm().maxCoeff());
+    Scalar angular_step = params_.angular_window;
+    if (max_range > grid_.getResolution())
+        angular_step = std::acos(1 - grid_.getResolution() * grid_.getResolution() / (2 * max_range * max_range));
+    int n_steps = angular_step > 0 ? std::ceil(params_.angular_window / angular_step) : 0;
+    angles_.resize(2 * n_steps + 1);
+    for (int i = -n_steps; i <= n_steps; i++)
+        angles_[i + n_steps] = i * angular_step;
+
+    scan_cells_x_.resize(angles_.size() * n_points_);
+    scan_cells_y_.resize(angles_.size() * n_points_);
+    for (unsigned int a = 0; a < angles_.size(); a++)
+    {
+        Eigen::Rotation2Ds R(_pose_guess(2) + angles_[a]);
+        Eigen::Matrix2s Rm = R.matrix();
+        int* cx = &scan_cells_x_[a * n_points_];
+        int* cy = &scan_cells_y_[a * n_points_];
+        for (unsigned int i = 0; i < n_points_; i++)
+        {
+            Eigen::Vector2s p = Rm * _points.col(i) + _pose_guess.head<2>();
+            cx[i] = grid_.cellX(p(0));
+            cy[i] = grid_.cellY(p(1));
+        }
+    }
+}
+
+inline Scalar CorrelativeScanMatcher2D::score(const unsigned int& _level, const Candidate& _candidate) const
+{
+    const int* cx = &scan_cells_x_[_candidate.angle_index * n_points_];
+    const int* cy = &scan_cells_y_[_candidate.angle_index * n_points_];
+    float sum = 0;
+    for (unsigned int i = 0; i < n_points_; i++)
+        sum += grid_.value(_level, cx[i] + _candidate.dx, cy[i] + _candidate.dy);
+    return sum / n_points_;
+}
+
+inline void CorrelativeScanMatcher2D::search(const unsigned int& _level)
+{
+    // candidates of this level are sorted, best first
+    std::vector<Candidate>& candidates = candidates_[_level];
+    std::vector<Candidate> level_candidates; // local copy, since deeper levels reuse candidates_
+    level_candidates.swap(candidates);
+
+    for (const Candidate& candidate : level_candidates)
+    {
+        // the score of a block is an upper bound of the scores of all its offsets
+        if (candidate.score <= best_.score)
+            break;
+
+        if (_level == 0)
+        {
+            best_ = candidate;
+            break;
+        }
+
+        // branch into the four sub-blocks
+        const int half = 1 << (_level - 1);
+        std::vector<Candidate>& children = candidates_[_level - 1];
+        children.clear();
+        Candidate child;
+        child.angle_index = candidate.angle_index;
+        for (int i = 0; i < 2; i++)
+            for (int j = 0; j < 2; j++)
+            {
+                child.dx = candidate.dx + i * half;
+                child.dy = candidate.dy + j * half;
+                if (child.dx > window_cells_ || child.dy > window_cells_)
+                    continue;
+                child.score = score(_level - 1, child);
+                children.push_back(child);
+            }
+        std::sort(children.begin(), children.end());
+        search(_level - 1);
+    }
+
+    // give the memory back for the next match
+    level_candidates.clear();
+    candidates.swap(level_candidates);
+}
+
+} // namespace wolf
+
+#endif /* CORRELATIVE_SCAN_MATCHER_2D_H_ */
@@ -0,0 +1,208 @@
+#include "association_hungarian.h"
+
+//std
+#include <limits>
+#include <algorithm>
+
+namespace wolf
+{
+
+AssociationHungarian::AssociationHungarian() :
+    max_dist_(MAX_DIST_DEFAULT)
+{
+    //
+}
+        
+AssociationHungarian::~AssociationHungarian()
+{
+    //
+}
+
+void AssociationHungarian::setMaxDist(const double _max_dist)
+{
+    max_dist_ = _max_dist;
+}
+        
+void AssociationHungarian::reset()
+{
+    nd_ = 0; 
+    nt_ = 0;
+    scores_.clear(); 
+}
+            
+void AssociationHungarian::resize(const unsigned int _n_det, const unsigned int _n_tar)
+{
+    nd_ = _n_det; //detections 
+    nt_ = _n_tar; //targets
+    scores_.resize(nd_, nt_); 
+}
+
+unsigned int AssociationHungarian::findComponent(unsigned int _node)
+{
+    while (component_[_node] != _node)
+    {
+        component_[_node] = component_[component_[_node]]; //path halving
+        _node = component_[_node];
+    }
+    return _node;
+}
+
+void AssociationHungarian::solve(std::vector<std::pair<unsigned int, unsigned int> > & _pairs, std::vector<bool> & _associated_mask)
+{
+    unsigned int ii, jj;
+
+    //resize _associated_mask and resets it to false
+    _associated_mask.resize(nd_,false);
+
+    //gating: connected components of the graph of pairs closer than max_dist_
+    component_.resize(nd_ + nt_);
+    for (ii = 0; ii < nd_ + nt_; ii++)
+        component_[ii] = ii;
+    for (ii = 0; ii < nd_; ii++)
+        for (jj = 0; jj < nt_; jj++)
+            if ( scores_(ii,jj) < max_dist_ )
+                component_[findComponent(ii)] = findComponent(nd_ + jj);
+
+    //group the nodes by component, keeping detections before targets
+    for (ii = 0; ii < nd_ + nt_; ii++)
+        component_[ii] = findComponent(ii); //point all nodes to their root
+    nodes_.resize(nd_ + nt_);
+    for (ii = 0; ii < nd_ + nt_; ii++)
+        nodes_[ii] = ii;
+    std::stable_sort(nodes_.begin(), nodes_.end(),
+                     [this](unsigned int _a, unsigned int _b) { return component_[_a] < component_[_b]; });
+
+    //solve each component with at least one detection and one target
+    for (auto begin = nodes_.begin(); begin != nodes_.end(); )
+    {
+        comp_det_.clear();
+        comp_tar_.clear();
+        auto end = begin;
+        for (; end != nodes_.end() && component_[*end] == component_[*begin]; end++)
+        {
+            if ( *end < nd_ )
+                comp_det_.push_back(*end);
+            else
+                comp_tar_.push_back(*end - nd_);
+        }
+        begin = end;
+
+        if ( comp_det_.empty() || comp_tar_.empty() )
+            continue;
+
+        //isolated pair: nothing to decide
+        if ( comp_det_.size() == 1 && comp_tar_.size() == 1 )
+        {
+            _associated_mask.at(comp_det_[0]) = true;
+            _pairs.push_back( std::pair<unsigned int, unsigned int>(comp_det_[0], comp_tar_[0]) );
+            continue;
+        }
+
+        solveComponent(_pairs, _associated_mask);
+    }
+}
+
+void AssociationHungarian::solveComponent(std::vector<std::pair<unsigned int, unsigned int> > & _pairs, std::vector<bool> & _associated_mask)
+{
+    // Square problem of size n = nr + nc, where
+    //   - rows 0..nr-1 are detections, and rows nr..n-1 stand for "target unassociated"
+    //   - cols 0..nc-1 are targets, and cols nc..n-1 stand for "detection unassociated"
+    const unsigned int nr = comp_det_.size();
+    const unsigned int nc = comp_tar_.size();
+    const unsigned int n = nr + nc;
+    const double unassociated = max_dist_ / 2;
+    const double infeasible = 2 * max_dist_ * n + 1; //larger than any feasible assignment
+
+    cost_.assign(n * n, infeasible);
+    for (unsigned int r = 0; r < nr; r++)
+    {
+        for (unsigned int c = 0; c < nc; c++)
+        {
+            double d = scores_(comp_det_[r], comp_tar_[c]);
+            if ( d < max_dist_ )
+                cost_[r * n + c] = d;
+        }
+        cost_[r * n + nc + r] = unassociated; //detection r unassociated
+    }
+    for (unsigned int c = 0; c < nc; c++)
+    {
+        cost_[(nr + c) * n + c] = unassociated; //target c unassociated
+        for (unsigned int r = 0; r < nr; r++)
+            cost_[(nr + c) * n + nc + r] = 0; //dummy with dummy
+    }
+
+    hungarian(n);
+
+    for (unsigned int c = 0; c < nc; c++)
+    {
+        unsigned int r = p_[c + 1] - 1;
+        if ( r < nr && cost_[r * n + c] < max_dist_ )
+        {
+            _associated_mask.at(comp_det_[r]) = true;
+            _pairs.push_back( std::pair<unsigned int, unsigned int>(comp_det_[r], comp_tar_[c]) );
+        }
+    }
+}
+
+void AssociationHungarian::hungarian(const unsigned int _n)
+{
+    // Shortest augmenting path with potentials u_ (rows) and v_ (cols), 1-based, column 0 is the virtual start
+    const double inf = std::numeric_limits<double>::infinity();
+    u_.assign(_n + 1, 0);
+    v_.assign(_n + 1, 0);
+    p_.assign(_n + 1, 0);
+    way_.assign(_n + 1, 0);
+
+    for (unsigned int i = 1; i <= _n; i++)
+    {
+        p_[0] = i;
+        unsigned int j0 = 0;
+        minv_.assign(_n + 1, inf);
+        used_.assign(_n + 1, false);
+        do
+        {
+            used_[j0] = true;
+            unsigned int i0 = p_[j0], j1 = 0;
+            double delta = inf;
+            const double* cost_row = &cost_[(i0 - 1) * _n];
+            for (unsigned int j = 1; j <= _n; j++)
+            {
+                if ( !used_[j] )
+                {
+                    double cur = cost_row[j - 1] - u_[i0] - v_[j];
+                    if ( cur < minv_[j] )
+                    {
+                        minv_[j] = cur;
+                        way_[j] = j0;
+                    }
+                    if ( minv_[j] < delta )
+                    {
+                        delta = minv_[j];
+                        j1 = j;
+                    }
+                }
+            }
+            for (unsigned int j = 0; j <= _n; j++)
+            {
+                if ( used_[j] )
+                {
+                    u_[p_[j]] += delta;
+                    v_[j] -= delta;
+                }
+                else
+                    minv_[j] -= delta;
+            }
+            j0 = j1;
+        } while ( p_[j0] != 0 );
+
+        //augment along the path
+        do
+        {
+            unsigned int j1 = way_[j0];
+            p_[j0] = p_[j1];
+            j0 = j1;
+        } while ( j0 != 0 );
+    }
+}
+
+} // namespace wolf
@@ -0,0 +1,109 @@
+#ifndef association_hungarian_H
+#define association_hungarian_H
+
+//std
+#include <iostream>
+#include <vector>
+
+//pipol tracker
+#include "association_solver.h"
+#include "association_nnls.h" //MAX_DIST_DEFAULT
+
+
+namespace wolf
+{
+
+/** \brief Optimal linear assignment
+ * 
+ * Solves data association problems given a table of distances, by minimizing the sum of the distances
+ * of the associated pairs, plus a cost of max_dist_/2 for each detection or target left unassociated.
+ * Therefore, a pair is only associated if its distance is below max_dist_, as in AssociationNNLS,
+ * but the result is globally consistent and does not depend on the order of detections and targets.
+ * 
+ * The gating by max_dist_ is done first, and splits the problem into independent connected components
+ * of the bipartite graph of gated pairs. Each component is solved with the Hungarian algorithm 
+ * (shortest augmenting paths, in the Jonker-Volgenant form), in O(n^3) of the size of the component.
+ * Isolated pairs, the most common case, are associated directly.
+ * 
+*/
+class AssociationHungarian : public AssociationSolver
+{
+    protected:
+        double max_dist_; //maximum distance to allow association 
+
+        // connected components of the gated graph. Detections are nodes 0..nd_-1, targets are nd_..nd_+nt_-1
+        std::vector<unsigned int> component_; // union-find parents
+        std::vector<unsigned int> comp_det_, comp_tar_; // detections and targets of the component being solved
+        std::vector<unsigned int> nodes_; // all nodes, grouped by component
+
+        // Hungarian workspace
+        std::vector<double> cost_; // square cost matrix, row major
+        std::vector<double> u_, v_, minv_;
+        std::vector<int> p_, way_;
+        std::vector<bool> used_;
+        
+    public:
+        /** \brief Constructor
+        * 
+        * Constructor 
+        * 
+        */        
+        AssociationHungarian();            
+        
+        /** \brief Destructor
+        * 
+        * Destructor
+        * 
+        */        
+        virtual ~AssociationHungarian();
+        
+        /** \brief Sets max_dist_
+         * 
+         * Sets max_dist_
+         * 
+         **/
+        void setMaxDist(const double _max_dist);
+        
+        /** \brief Resets problem
+        * 
+        * Resets problem
+        * 
+        */        
+        void reset();                    
+            
+        /** \brief Resizes the problem
+        * 
+        * Resizes the problem
+        * 
+        */        
+        void resize(const unsigned int _n_det, const unsigned int _n_tar);
+               
+        /** \brief Solves the problem
+         * 
+         * Solves the association problem with optimal assignment.
+         * Return values are: 
+         * \param _pairs Returned pairs: vector of pairs (d_i, t_j)
+         * \param _associated_mask Resized to nd_. Marks true at i if detection d_i has been associated, otherwise marks false
+         * 
+         * Assumes scores_ matrix is correctly sized, by a previous call to resize()
+         * 
+         **/
+        void solve(std::vector<std::pair<unsigned int, unsigned int> > & _pairs, std::vector<bool> & _associated_mask);
+
+    protected:
+        unsigned int findComponent(unsigned int _node);
+
+        /** \brief Solves the component in comp_det_ and comp_tar_
+         */
+        void solveComponent(std::vector<std::pair<unsigned int, unsigned int> > & _pairs, std::vector<bool> & _associated_mask);
+
+        /** \brief Hungarian algorithm on the square matrix cost_ of size _n
+         * 
+         * At output, p_[j] is the row (1-based) assigned to column j (1-based).
+         */
+        void hungarian(const unsigned int _n);
+};
+
+} // namespace wolf
+
+#endif            
@@ -6,7 +6,9 @@ namespace wolf
 
 AssociationTree::AssociationTree() :
     AssociationSolver(),
-    root_(0,0,1, NULL, true)
+    root_(0,0,1, NULL, true),
+    beam_width_(0),
+    prune_ratio_(0.)
 {
     //
 }
@@ -23,6 +25,7 @@ void AssociationTree::reset()
     scores_.clear(); 
     terminus_node_list_.clear();
     root_.destroyTree();
+    beam_nodes_.clear(); // keeps the pool memory
 }
 
 void AssociationTree::resize(const unsigned int _n_det, const unsigned int _n_tar)
@@ -32,6 +35,12 @@ void AssociationTree::resize(const unsigned int _n_det, const unsigned int _n_ta
     scores_.resize(nd_,nt_+1); //"+1" to account for void target, which manages unassociated detections
 }
 
+
+void AssociationTree::setBeamSearch(const unsigned int _beam_width, const double _prune_ratio)
+{
+    beam_width_ = _beam_width;
+    prune_ratio_ = _prune_ratio;
+}
              
 void AssociationTree::growTree()
 {
@@ -77,6 +86,16 @@ void AssociationTree::solve(std::map<unsigned int, unsigned int> & _pairs, std::
 //    bool rootReached = false;
     AssociationNode *anPtr;
     
+    //pruned tree
+    if ( beam_width_ > 0 )
+    {
+        std::vector<std::pair<unsigned int, unsigned int> > pairs;
+        setBeamPairs(growBeam(), pairs, _associated_mask);
+        for (auto pair : pairs)
+            _pairs[pair.first] = pair.second;
+        return;
+    }
+
     //grows tree exploring all likely hypothesis
     growTree();
     
@@ -123,6 +142,13 @@ void AssociationTree::solve(std::vector<std::pair<unsigned int, unsigned int> >
 //    bool rootReached = false;
     AssociationNode *anPtr;
 
+    //pruned tree
+    if ( beam_width_ > 0 )
+    {
+        setBeamPairs(growBeam(), _pairs, _associated_mask);
+        return;
+    }
+
     //grows tree exploring all likely hypothesis
     growTree();
 
@@ -162,6 +188,107 @@ void AssociationTree::solve(std::vector<std::pair<unsigned int, unsigned int> >
         anPtr = anPtr->upNodePtr();
     }
 }
+
+int AssociationTree::growBeam()
+{
+    if ( nd_ == 0 ) //check if detections
+        return -1;
+
+    //node probabilities do not depend on the hypothesis: compute them once
+    node_probs_.resize(nd_, nt_+1);
+    for (unsigned int det_i = 0; det_i < nd_; det_i++)
+        for (unsigned int tar_j = 0; tar_j < nt_+1; tar_j++)
+            node_probs_(det_i, tar_j) = root_.computeNodeProb(nd_, nt_, det_i, tar_j, scores_);
+
+    //root
+    beam_nodes_.clear();
+    beam_nodes_.push_back(BeamNode({0, 0, 1., -1}));
+    beam_.assign(1, 0);
+
+    int best_node = -1;
+    double best_prob = 0.;
+    for (unsigned int det_i = 0; det_i < nd_; det_i++)
+    {
+        next_beam_.clear();
+        for (auto node_idx : beam_)
+        {
+            //targets already associated in this hypothesis
+            used_targets_.assign(nt_, false);
+            for (int up_idx = node_idx; up_idx > 0; up_idx = beam_nodes_[up_idx].up_node_idx_)
+                if ( beam_nodes_[up_idx].tar_idx_ < nt_ )
+                    used_targets_[beam_nodes_[up_idx].tar_idx_] = true;
+
+            //grow, as AssociationNode::growTree() does
+            bool grown = false;
+            for (unsigned int tar_j = 0; tar_j < nt_+1; tar_j++)
+            {
+                if ( tar_j < nt_ && used_targets_[tar_j] )
+                    continue;
+                double p_ij = node_probs_(det_i, tar_j);
+                if ( p_ij > PROB_ZERO_ )
+                {
+                    beam_nodes_.push_back(BeamNode({det_i, tar_j, beam_nodes_[node_idx].tree_prob_ * p_ij, node_idx}));
+                    next_beam_.push_back(beam_nodes_.size()-1);
+                    grown = true;
+                }
+            }
+
+            //a branch that stops growing is a terminus node
+            if ( !grown && beam_nodes_[node_idx].tree_prob_ > best_prob )
+            {
+                best_node = node_idx;
+                best_prob = beam_nodes_[node_idx].tree_prob_;
+            }
+        }
+
+        //keep the best hypotheses of this level
+        auto better = [this](int _a, int _b) { return beam_nodes_[_a].tree_prob_ > beam_nodes_[_b].tree_prob_; };
+        if ( next_beam_.size() > beam_width_ )
+        {
+            std::nth_element(next_beam_.begin(), next_beam_.begin() + beam_width_, next_beam_.end(), better);
+            next_beam_.resize(beam_width_);
+        }
+        if ( prune_ratio_ > 0 && !next_beam_.empty() )
+        {
+            double th = prune_ratio_ * beam_nodes_[*std::min_element(next_beam_.begin(), next_beam_.end(), better)].tree_prob_;
+            next_beam_.erase(std::remove_if(next_beam_.begin(), next_beam_.end(),
+                                            [this, th](int _a) { return beam_nodes_[_a].tree_prob_ < th; }),
+                             next_beam_.end());
+        }
+        beam_.swap(next_beam_);
+    }
+
+    //complete hypotheses
+    for (auto node_idx : beam_)
+    {
+        if ( beam_nodes_[node_idx].tree_prob_ > best_prob )
+        {
+            best_node = node_idx;
+            best_prob = beam_nodes_[node_idx].tree_prob_;
+        }
+    }
+
+    return best_node;
+}
+
+void AssociationTree::setBeamPairs(int _node_idx, std::vector<std::pair<unsigned int, unsigned int> > & _pairs, std::vector<bool> & _associated_mask)
+{
+    if ( _node_idx < 0 ) return;
+
+    //resize _associated_mask and resets it to false
+    _associated_mask.resize(nd_,false);
+
+    //set pairs
+    for (; _node_idx > 0; _node_idx = beam_nodes_[_node_idx].up_node_idx_)
+    {
+        const BeamNode& node = beam_nodes_[_node_idx];
+        if ( node.tar_idx_ < nt_ ) //association pair
+        {
+            _associated_mask.at(node.det_idx_) = true;
+            _pairs.push_back( std::pair<unsigned int, unsigned int>(node.det_idx_, node.tar_idx_) );
+        }
+    }
+}
     
 void AssociationTree::printTree()
 {
@@ -19,6 +19,19 @@ namespace wolf
 {
 
 /** \brief The whole decision tree
+ *
+ * By default, the tree of all detection-to-target hypotheses is grown and evaluated,
+ * which is exponential in the number of detections.
+ *
+ * With beam search enabled (see setBeamSearch()), the tree is grown breadth-first, one detection per level,
+ * and only the best hypotheses of each level are expanded further:
+ *   - at most _beam_width hypotheses, those with the highest joint probability,
+ *   - and none with a joint probability below _prune_ratio times the best one of the level.
+ *
+ * The cost is then linear in the number of detections.
+ * The hypotheses are stored in a flat pool of nodes, reused from one solve() to the next,
+ * and the node probabilities are computed once per detection-target pair.
+ * The result is the same as with the full tree if no hypothesis gets pruned.
  */
 class AssociationTree : public AssociationSolver
 {
@@ -26,6 +39,21 @@ class AssociationTree : public AssociationSolver
         AssociationNode root_;
         std::list<AssociationNode*> terminus_node_list_;
 
+        // Beam search
+        struct BeamNode
+        {
+                unsigned int det_idx_;
+                unsigned int tar_idx_;
+                double tree_prob_;
+                int up_node_idx_; ///< index of the up node in beam_nodes_. -1 for the root.
+        };
+        unsigned int beam_width_; ///< max hypotheses per level. 0: beam search disabled, grow the full tree
+        double prune_ratio_;      ///< prune hypotheses below this ratio of the best of each level
+        Matrixx<double> node_probs_;        ///< node probability of each detection-target pair
+        std::vector<BeamNode> beam_nodes_;  ///< pool of hypothesis nodes, root at index 0
+        std::vector<int> beam_, next_beam_; ///< nodes of the current and next levels
+        std::vector<bool> used_targets_;
+
     public:
         /** \brief Constructor
         * 
@@ -57,6 +85,14 @@ class AssociationTree : public AssociationSolver
         * 
         */        
         void resize(const unsigned int _n_det, const unsigned int _n_tar);                
+
+        /** \brief Enables pruned growing of the tree
+        *
+        * \param _beam_width max number of hypotheses kept at each level. 0 disables beam search.
+        * \param _prune_ratio hypotheses with a probability below this ratio of the best of their level are dropped.
+        *
+        */
+        void setBeamSearch(const unsigned int _beam_width, const double _prune_ratio = 0.);
         
         /** \brief Build tree from scores
         * 
@@ -122,6 +158,18 @@ class AssociationTree : public AssociationSolver
         * 
         */                        
         void printTerminusNodes();       
+
+    protected:
+        /** \brief Grows the tree with beam search
+        *
+        * \return index in beam_nodes_ of the best terminus node. -1 if there are no detections.
+        *
+        */
+        int growBeam();
+
+        /** \brief Gets the pairs of the hypothesis ending at the given node of beam_nodes_
+        */
+        void setBeamPairs(int _node_idx, std::vector<std::pair<unsigned int, unsigned int> > & _pairs, std::vector<bool> & _associated_mask);
 };
 
 } // namespace wolf
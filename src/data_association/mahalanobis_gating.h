@@ -0,0 +1,88 @@
+/**
+ * \file mahalanobis_gating.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef MAHALANOBIS_GATING_H_
+#define MAHALANOBIS_GATING_H_
+
+//wolf
+#include "../wolf.h"
+
+//std
+#include <cassert>
+#include <limits>
+
+namespace wolf
+{
+
+/** \brief Batch of 3D innovations, in structure-of-arrays form.
+ *
+ * Column i holds the innovation of the i-th feature-landmark pair.
+ * Being row major, each component of all pairs is contiguous in memory.
+ */
+typedef Eigen::Matrix<Scalar, 3, Eigen::Dynamic, Eigen::RowMajor> InnovationBatch3;
+
+/** \brief Batch of 3x3 symmetric innovation covariances, in structure-of-arrays form.
+ *
+ * Column i holds the 6 unique entries (xx, xy, xz, yy, yz, zz) of the covariance of the i-th pair.
+ */
+typedef Eigen::Matrix<Scalar, 6, Eigen::Dynamic, Eigen::RowMajor> CovarianceBatch3;
+
+/** \brief Store a 3x3 symmetric covariance in a column of a covariance batch
+ */
+inline void setBatchCovariance(CovarianceBatch3& _batch, const unsigned int& _i, const Eigen::Matrix3s& _cov)
+{
+    _batch.col(_i) << _cov(0,0), _cov(0,1), _cov(0,2), _cov(1,1), _cov(1,2), _cov(2,2);
+}
+
+/** \brief Batch squared Mahalanobis distances of 3D innovations.
+ * \param _innovations input batch of N innovations d_i. It is overwritten with L_i^-1 * d_i.
+ * \param _covariances input batch of N innovation covariances S_i. It is overwritten with their Cholesky factors L_i.
+ * \param _squared_distances output vector of the N squared distances d_i' * S_i^-1 * d_i.
+ *
+ * The 3x3 Cholesky factorizations and triangular solves are written in closed form,
+ * so that each step is one array operation over the N pairs: Eigen vectorizes them,
+ * and no memory is allocated if _squared_distances has already N elements.
+ *
+ * Pairs with a covariance that is not positive definite get an infinite distance.
+ */
+inline void squaredMahalanobisDistances(InnovationBatch3& _innovations, CovarianceBatch3& _covariances,
+                                        Eigen::VectorXs& _squared_distances)
+{
+    assert(_innovations.cols() == _covariances.cols() && "squaredMahalanobisDistances: batch sizes do not match");
+
+    // Cholesky factors, in place: S = L * L'
+    auto L00 = _covariances.row(0).array();
+    auto L10 = _covariances.row(1).array();
+    auto L20 = _covariances.row(2).array();
+    auto L11 = _covariances.row(3).array();
+    auto L21 = _covariances.row(4).array();
+    auto L22 = _covariances.row(5).array();
+    L00 = L00.sqrt();
+    L10 /= L00;
+    L20 /= L00;
+    L11 = (L11 - L10.square()).sqrt();
+    L21 = (L21 - L20 * L10) / L11;
+    L22 = (L22 - L20.square() - L21.square()).sqrt();
+
+    // forward substitution, in place: y = L^-1 * d
+    auto y0 = _innovations.row(0).array();
+    auto y1 = _innovations.row(1).array();
+    auto y2 = _innovations.row(2).array();
+    y0 /= L00;
+    y1 = (y1 - L10 * y0) / L11;
+    y2 = (y2 - L20 * y0 - L21 * y1) / L22;
+
+    // squared distances: d' * S^-1 * d = y' * y
+    _squared_distances.resize(_innovations.cols());
+    _squared_distances.array() = y0.square().transpose() + y1.square().transpose() + y2.square().transpose();
+    _squared_distances = _squared_distances.array().isNaN().select(std::numeric_limits<Scalar>::infinity(),
+                                                                    _squared_distances);
+}
+
+} // namespace wolf
+
+#endif /* MAHALANOBIS_GATING_H_ */
@@ -0,0 +1,139 @@
+#ifndef DESCRIPTORTOOLS_H
+#define DESCRIPTORTOOLS_H
+
+/**
+ * \file descriptorTools.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "wolf.h"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// OpenCV includes
+#include <opencv2/core/core.hpp>
+#include <opencv2/features2d/features2d.hpp>
+
+namespace wolf {
+
+enum DetectorDescriptorType
+{
+    DD_BRISK,
+    DD_ORB
+};
+
+struct DetectorDescriptorParamsBase
+{
+        DetectorDescriptorType type;
+        unsigned int nominal_pattern_radius = 18; ///< Radius of the pattern before scaling
+        //should this be here? doesn't it depend on the descriptor?
+};
+
+struct DetectorDescriptorParamsBrisk : public DetectorDescriptorParamsBase
+{
+        unsigned int threshold=30; ///< on the keypoint strength to declare it key-point
+        unsigned int octaves=0; ///< Multi-scale evaluation. 0: no multi-scale
+        float pattern_scale=1.0f; ///< Scale of the base pattern wrt the nominal one
+};
+
+struct DetectorDescriptorParamsOrb : public DetectorDescriptorParamsBase
+{
+        unsigned int nfeatures=500;
+        float scaleFactor=1.2f;
+        unsigned int nlevels=1;//8
+        unsigned int edgeThreshold=4; //31
+        unsigned int firstLevel=0;
+        unsigned int WTA_K=2;
+        unsigned int scoreType=cv::ORB::HARRIS_SCORE;
+        unsigned int patchSize=31;
+};
+
+/**
+ * Namespace for operations on image descriptors.
+ *
+ * The descriptors of an image are stored in one cv::Mat, one descriptor per row, contiguous in memory.
+ * The Features of the image keep cv::Mat rows of it, which share its memory instead of owning a copy.
+ * The functions here work on raw row pointers, so that matching streams through the rows
+ * without building a cv::Mat header, nor touching its reference counter, per candidate.
+ */
+namespace descriptor {
+
+            /**
+             * Distance between two descriptors
+             * \param _d1 the first descriptor
+             * \param _d2 the second descriptor
+             * \param _bytes the length of the descriptors in bytes, e.g. 32 for ORB
+             * \param _norm the norm, e.g. cv::NORM_HAMMING for binary descriptors
+             */
+            inline Scalar distance(const uchar* _d1, const uchar* _d2, int _bytes, int _norm)
+            {
+                if (_norm == cv::NORM_HAMMING)
+                    return cv::normHamming(_d1, _d2, _bytes);
+                // other norms: wrap the rows without copying them
+                return cv::norm(cv::Mat(1, _bytes, CV_8U, (void*)_d1), cv::Mat(1, _bytes, CV_8U, (void*)_d2), _norm);
+            }
+
+            /**
+             * Copy some rows of a descriptor matrix into another one, in the given order
+             * \param _descriptors the source descriptors, one per row
+             * \param _rows the rows to copy
+             * \param _sorted_descriptors the copied descriptors: row k is row _rows[k] of \a _descriptors
+             *
+             * Sorting the descriptors in the order they are visited, e.g. by image bucket,
+             * makes their matching stream linearly through memory.
+             */
+            inline void sortRows(const cv::Mat& _descriptors, const std::vector<unsigned int>& _rows, cv::Mat& _sorted_descriptors)
+            {
+                _sorted_descriptors.create(_rows.size(), _descriptors.cols, _descriptors.type());
+                const size_t row_bytes = _descriptors.cols * _descriptors.elemSize();
+                for (unsigned int k = 0; k < _rows.size(); k++)
+                    std::memcpy(_sorted_descriptors.ptr<uchar>(k), _descriptors.ptr<uchar>(_rows[k]), row_bytes);
+            }
+
+            /**
+             * Create the detector-descriptor given by a set of parameters
+             * \param _params the parameters, of the derived type given by _params->type
+             * \param _pattern_radius returns the radius of the detector pattern, in pixels
+             * \return the detector-descriptor, owned by the caller
+             */
+            inline cv::Feature2D* createDetectorDescriptor(const DetectorDescriptorParamsBase* _params, unsigned int& _pattern_radius)
+            {
+                switch (_params->type)
+                {
+                    case DD_BRISK:
+                    {
+                        const DetectorDescriptorParamsBrisk* params_brisk = (const DetectorDescriptorParamsBrisk*)_params;
+                        _pattern_radius = std::max((unsigned int)((_params->nominal_pattern_radius) * pow(2, params_brisk->octaves)),
+                                                   (unsigned int)((_params->nominal_pattern_radius) * params_brisk->pattern_scale));
+                        return new cv::BRISK(params_brisk->threshold, //
+                                             params_brisk->octaves, //
+                                             params_brisk->pattern_scale);
+                    }
+                    case DD_ORB:
+                    {
+                        const DetectorDescriptorParamsOrb* params_orb = (const DetectorDescriptorParamsOrb*)_params;
+                        _pattern_radius = (unsigned int)((_params->nominal_pattern_radius)
+                                * pow(params_orb->scaleFactor, params_orb->nlevels - 1));
+                        return new cv::ORB(params_orb->nfeatures, //
+                                           params_orb->scaleFactor, //
+                                           params_orb->nlevels, //
+                                           params_orb->edgeThreshold, //
+                                           params_orb->firstLevel, //
+                                           params_orb->WTA_K, //
+                                           params_orb->scoreType, //
+                                           params_orb->patchSize);
+                    }
+                    default:
+                        throw std::runtime_error("Unknown detector-descriptor type");
+                }
+            }
+
+} // namespace descriptor
+
+} // namespace wolf
+
+#endif // DESCRIPTORTOOLS_H
@@ -0,0 +1,148 @@
+/**
+ * \file test_association_hungarian.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "data_association/association_hungarian.h"
+#include "data_association/association_nnls.h"
+
+// Wolf includes
+#include "time_stamp.h"
+
+// General includes
+#include <iostream>
+#include <iomanip>      // std::setprecision
+#include <cstdlib>
+#include <algorithm>
+
+using namespace wolf;
+
+/** Cost of an association: distances of the pairs, plus half the gate per unassociated detection or target
+ */
+double associationCost(AssociationSolver& _solver, const std::vector<std::pair<unsigned int, unsigned int> >& _pairs, double _max_dist)
+{
+    double cost = 0;
+    for (auto pair : _pairs)
+        cost += _solver.getScore(pair.first, pair.second);
+    unsigned int n_unassociated = _solver.numDetections() + _solver.numTargets() - 2 * _pairs.size();
+    return cost + n_unassociated * _max_dist / 2;
+}
+
+/** Minimum association cost, by exhaustive search
+ */
+double bruteForceCost(AssociationSolver& _solver, unsigned int _det_i, std::vector<bool>& _used, double _max_dist)
+{
+    if (_det_i == _solver.numDetections())
+    {
+        double cost = 0;
+        for (unsigned int j = 0; j < _solver.numTargets(); j++)
+            if (!_used[j])
+                cost += _max_dist / 2;
+        return cost;
+    }
+    double best = _max_dist / 2 + bruteForceCost(_solver, _det_i + 1, _used, _max_dist); // unassociated
+    for (unsigned int j = 0; j < _solver.numTargets(); j++)
+    {
+        if (_used[j] || _solver.getScore(_det_i, j) >= _max_dist)
+            continue;
+        _used[j] = true;
+        best = std::min(best, _solver.getScore(_det_i, j) + bruteForceCost(_solver, _det_i + 1, _used, _max_dist));
+        _used[j] = false;
+    }
+    return best;
+}
+
+int main()
+{
+    std::cout << std::setprecision(4);
+
+    std::cout << "\n====== Test AssociationHungarian ======" << std::endl;
+
+    const double max_dist = 0.5;
+
+    // Order dependence: NNLS takes the closest pair first, and leaves the other detection unassociated
+    //      t0    t1
+    // d0   0.1   0.2
+    // d1   0.15  0.9
+    AssociationNNLS nnls;
+    AssociationHungarian hungarian;
+    nnls.setMaxDist(max_dist);
+    hungarian.setMaxDist(max_dist);
+    nnls.resize(2, 2);
+    hungarian.resize(2, 2);
+    double scores[2][2] = {{0.1, 0.2}, {0.15, 0.9}};
+    for (unsigned int i = 0; i < 2; i++)
+        for (unsigned int j = 0; j < 2; j++)
+        {
+            nnls.setScore(i, j, scores[i][j]);
+            hungarian.setScore(i, j, scores[i][j]);
+        }
+    std::vector<std::pair<unsigned int, unsigned int> > nnls_pairs, hungarian_pairs;
+    std::vector<bool> nnls_mask, hungarian_mask;
+    nnls.solve(nnls_pairs, nnls_mask);
+    hungarian.solve(hungarian_pairs, hungarian_mask);
+    std::sort(hungarian_pairs.begin(), hungarian_pairs.end());
+    std::cout << "NNLS pairs: " << nnls_pairs.size() << "; Hungarian pairs: " << hungarian_pairs.size() << std::endl;
+
+    if (hungarian_pairs.size() != 2 || hungarian_pairs[0] != std::make_pair(0u, 1u) || hungarian_pairs[1] != std::make_pair(1u, 0u))
+    {
+        std::cout << "TEST ASSOCIATION HUNGARIAN GLOBAL ------> ERROR! wrong pairs" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST ASSOCIATION HUNGARIAN GLOBAL ------> OK!" << std::endl;
+
+    // Random problems: the cost is the optimal one
+    srand(0);
+    for (int trial = 0; trial < 200; trial++)
+    {
+        unsigned int nd = 1 + rand() % 6, nt = 1 + rand() % 6;
+        AssociationHungarian solver;
+        solver.setMaxDist(max_dist);
+        solver.resize(nd, nt);
+        for (unsigned int i = 0; i < nd; i++)
+            for (unsigned int j = 0; j < nt; j++)
+                solver.setScore(i, j, 1.0 * rand() / RAND_MAX);
+        std::vector<std::pair<unsigned int, unsigned int> > pairs;
+        std::vector<bool> mask;
+        solver.solve(pairs, mask);
+
+        std::vector<bool> used(nt, false);
+        double optimal = bruteForceCost(solver, 0, used, max_dist);
+        double cost = associationCost(solver, pairs, max_dist);
+        if (std::abs(cost - optimal) > 1e-9)
+        {
+            std::cout << "TEST ASSOCIATION HUNGARIAN OPTIMAL ------> ERROR! cost " << cost << " optimal " << optimal << std::endl;
+            return -1;
+        }
+    }
+    std::cout << "TEST ASSOCIATION HUNGARIAN OPTIMAL ------> OK!" << std::endl;
+
+    // Large sparse problem: gating splits it into many small components
+    const unsigned int n_large = 500;
+    AssociationHungarian large;
+    large.setMaxDist(max_dist);
+    large.resize(n_large, n_large);
+    for (unsigned int i = 0; i < n_large; i++)
+        for (unsigned int j = 0; j < n_large; j++)
+            large.setScore(i, j, (i / 4 == j / 4) ? 0.4 * rand() / RAND_MAX : 10.);
+    std::vector<std::pair<unsigned int, unsigned int> > large_pairs;
+    std::vector<bool> large_mask;
+    TimeStamp t0, t1;
+    t0.setToNow();
+    large.solve(large_pairs, large_mask);
+    t1.setToNow();
+    std::cout << "sparse problem: " << n_large << " x " << n_large << ", " << large_pairs.size() << " pairs in "
+              << 1e3 * (t1 - t0) << " ms" << std::endl;
+
+    if (large_pairs.size() != n_large)
+    {
+        std::cout << "TEST ASSOCIATION HUNGARIAN SPARSE ------> ERROR! missing pairs" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST ASSOCIATION HUNGARIAN SPARSE ------> OK!" << std::endl;
+
+    return 0;
+}
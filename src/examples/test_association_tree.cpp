@@ -0,0 +1,119 @@
+/**
+ * \file test_association_tree.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "data_association/association_tree.h"
+
+// Wolf includes
+#include "time_stamp.h"
+
+// General includes
+#include <iostream>
+#include <iomanip>      // std::setprecision
+#include <cstdlib>
+#include <algorithm>
+
+using namespace wolf;
+
+/** Fill a tree with scores of _nd detections of _nt targets:
+ * detection i comes from target i, and has some smaller scores with the neighbor targets.
+ */
+void setScores(AssociationTree& _tree, unsigned int _nd, unsigned int _nt)
+{
+    _tree.reset();
+    _tree.resize(_nd, _nt);
+    for (unsigned int i = 0; i < _nd; i++)
+        for (unsigned int j = 0; j < _nt; j++)
+        {
+            double score = 0;
+            if (i == j)
+                score = 0.6 + 0.3 * rand() / RAND_MAX;
+            else if (i + 1 == j || j + 1 == i)
+                score = 0.4 * rand() / RAND_MAX;
+            _tree.setScore(i, j, score);
+        }
+}
+
+int main()
+{
+    std::cout << std::setprecision(4);
+
+    std::cout << "\n====== Test AssociationTree ======" << std::endl;
+
+    srand(0);
+
+    // Small problem: the beam search, wide enough, gives the same pairs as the full tree
+    const unsigned int nd = 6, nt = 7;
+    bool all_equal = true;
+    for (int trial = 0; trial < 20; trial++)
+    {
+        unsigned int seed = rand();
+
+        AssociationTree full_tree;
+        srand(seed);
+        setScores(full_tree, nd, nt);
+        std::vector<std::pair<unsigned int, unsigned int> > full_pairs;
+        std::vector<bool> full_mask;
+        full_tree.solve(full_pairs, full_mask);
+
+        AssociationTree beam_tree;
+        beam_tree.setBeamSearch(1000);
+        srand(seed);
+        setScores(beam_tree, nd, nt);
+        std::vector<std::pair<unsigned int, unsigned int> > beam_pairs;
+        std::vector<bool> beam_mask;
+        beam_tree.solve(beam_pairs, beam_mask);
+
+        std::sort(full_pairs.begin(), full_pairs.end());
+        std::sort(beam_pairs.begin(), beam_pairs.end());
+        if (full_pairs != beam_pairs || full_mask != beam_mask)
+            all_equal = false;
+    }
+    if (!all_equal)
+    {
+        std::cout << "TEST ASSOCIATION BEAM SEARCH EXACT ------> ERROR! different associations" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST ASSOCIATION BEAM SEARCH EXACT ------> OK!" << std::endl;
+
+    // Crowded problem: out of reach for the full tree. A narrow beam finds the same associations as a wide one.
+    const unsigned int nd_crowd = 60, nt_crowd = 60;
+    unsigned int seed = rand();
+    std::vector<std::pair<unsigned int, unsigned int> > crowd_pairs[2];
+    std::vector<bool> crowd_mask[2];
+    const unsigned int beam_width[2] = {2000, 16};
+    for (int k = 0; k < 2; k++)
+    {
+        AssociationTree crowd_tree;
+        crowd_tree.setBeamSearch(beam_width[k], 1e-3);
+        srand(seed);
+        setScores(crowd_tree, nd_crowd, nt_crowd);
+
+        TimeStamp t0, t1;
+        t0.setToNow();
+        crowd_tree.solve(crowd_pairs[k], crowd_mask[k]);
+        t1.setToNow();
+        std::sort(crowd_pairs[k].begin(), crowd_pairs[k].end());
+        std::cout << "crowded scene: " << nd_crowd << " detections, " << nt_crowd << " targets, beam width "
+                  << beam_width[k] << ": " << crowd_pairs[k].size() << " pairs in " << 1e3 * (t1 - t0) << " ms" << std::endl;
+    }
+
+    if (crowd_pairs[0] != crowd_pairs[1] || crowd_mask[0] != crowd_mask[1])
+    {
+        std::cout << "TEST ASSOCIATION BEAM SEARCH CROWDED ------> ERROR! different associations" << std::endl;
+        return -1;
+    }
+    for (auto pair : crowd_pairs[1])
+        if (pair.first != pair.second)
+        {
+            std::cout << "TEST ASSOCIATION BEAM SEARCH CROWDED ------> ERROR! wrong pair" << std::endl;
+            return -1;
+        }
+    std::cout << "TEST ASSOCIATION BEAM SEARCH CROWDED ------> OK!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * \file test_camera_undistortion.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "sensor_camera.h"
+
+// Wolf includes
+#include "pinholeTools.h"
+#include "state_block.h"
+#include "time_stamp.h"
+
+// General includes
+#include <iostream>
+#include <iomanip>      // std::setprecision
+
+using namespace wolf;
+
+/** Max error, in pixels, of the re-distortion of the undistorted pixels.
+ * Computed for the undistortion map of the camera, and for its correction model.
+ */
+void undistortionErrors(SensorCamera* _camera_ptr, const Eigen::Matrix<Scalar, 2, Eigen::Dynamic>& _pixels,
+                        Scalar& _error_map, Scalar& _error_model, Scalar& _time_map, Scalar& _time_model)
+{
+    Eigen::Vector4s k = _camera_ptr->getIntrinsicPtr()->getVector();
+    Eigen::VectorXs d = _camera_ptr->getDistortionVector();
+    Eigen::VectorXs c = _camera_ptr->getCorrectionVector();
+
+    TimeStamp t0, t1;
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> undistorted_map, undistorted_model(2, _pixels.cols());
+    t0.setToNow();
+    _camera_ptr->undistort(_pixels, undistorted_map);
+    t1.setToNow();
+    _time_map = t1 - t0;
+
+    t0.setToNow();
+    for (unsigned int i = 0; i < _pixels.cols(); i++)
+        undistorted_model.col(i) = pinhole::pixellizePoint(k, pinhole::backprojectPoint(k, c, _pixels.col(i)));
+    t1.setToNow();
+    _time_model = t1 - t0;
+
+    _error_map = _error_model = 0;
+    for (unsigned int i = 0; i < _pixels.cols(); i++)
+    {
+        Eigen::Vector2s redistorted_map = pinhole::pixellizePoint(k, pinhole::distortPoint(d, pinhole::depixellizePoint(k, undistorted_map.col(i))));
+        Eigen::Vector2s redistorted_model = pinhole::pixellizePoint(k, pinhole::distortPoint(d, pinhole::depixellizePoint(k, undistorted_model.col(i))));
+        _error_map = std::max(_error_map, (redistorted_map - _pixels.col(i)).norm());
+        _error_model = std::max(_error_model, (redistorted_model - _pixels.col(i)).norm());
+    }
+}
+
+int main()
+{
+    std::cout << std::setprecision(4);
+
+    std::cout << "\n====== Test SensorCamera undistortion map ======" << std::endl;
+
+    IntrinsicsCamera intrinsics;
+    intrinsics.width = 640;
+    intrinsics.height = 480;
+    intrinsics.pinhole_model << 320, 240, 320, 320;
+    intrinsics.distortion.resize(2);
+    intrinsics.distortion << -0.3, 0.1;
+    Eigen::VectorXs extrinsics(7);
+    extrinsics << 0, 0, 0, 0, 0, 0, 1;
+
+    SensorCamera* camera_ptr = (SensorCamera*)SensorCamera::create("camera", extrinsics, &intrinsics);
+
+    // Random pixels in the image
+    const unsigned int N = 10000;
+    srand(0);
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> pixels = Eigen::Matrix<Scalar, 2, Eigen::Dynamic>::Random(2, N);
+    pixels.row(0) = (pixels.row(0).array() + 1) * 320;
+    pixels.row(1) = (pixels.row(1).array() + 1) * 240;
+
+    Scalar error_map, error_model, time_map, time_model;
+    undistortionErrors(camera_ptr, pixels, error_map, error_model, time_map, time_model);
+    std::cout << N << " pixels, max errors: map " << error_map << " pix in " << 1e3 * time_map << " ms; correction model "
+              << error_model << " pix in " << 1e3 * time_model << " ms" << std::endl;
+
+    if (error_map > 0.05 || error_map > error_model)
+    {
+        std::cout << "TEST CAMERA UNDISTORTION MAP ------> ERROR!" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST CAMERA UNDISTORTION MAP ------> OK!" << std::endl;
+
+    // The map follows the intrinsic parameters, e.g. when estimated by the solver
+    Eigen::Vector4s k_new(330, 250, 310, 315);
+    camera_ptr->getIntrinsicPtr()->setVector(k_new);
+    undistortionErrors(camera_ptr, pixels, error_map, error_model, time_map, time_model);
+    std::cout << "new intrinsics, max errors: map " << error_map << " pix; correction model " << error_model << " pix" << std::endl;
+
+    if (error_map > 0.05 || error_map > error_model)
+    {
+        std::cout << "TEST CAMERA UNDISTORTION MAP UPDATE ------> ERROR!" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST CAMERA UNDISTORTION MAP UPDATE ------> OK!" << std::endl;
+
+    delete camera_ptr;
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * \file test_capture_queue.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+//std
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+//Wolf
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "state_block.h"
+#include "capture_queue.h"
+#include "processor_tracker_feature_dummy.h"
+#include "processor_odom_2D.h"
+#include "capture_void.h"
+
+using namespace wolf;
+
+/** Dummy tracker recording which Captures went through its front-end, and on which thread,
+ * and the time stamps of the processed Captures
+ */
+class ProcessorTrackerFeaturePipelined : public ProcessorTrackerFeatureDummy
+{
+    public:
+        std::mutex mutex_;
+        std::set<CaptureBase*> front_ended_;
+        std::thread::id front_end_thread_id_;
+        unsigned int n_processed_ = 0;
+        unsigned int n_not_front_ended_ = 0;
+        unsigned int front_end_delay_ms_ = 0;
+        std::vector<TimeStamp>* processed_time_stamps_ = nullptr;
+
+    protected:
+        virtual void frontEnd(CaptureBase* _capture_ptr)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            front_ended_.insert(_capture_ptr);
+            front_end_thread_id_ = std::this_thread::get_id();
+            std::this_thread::sleep_for(std::chrono::milliseconds(front_end_delay_ms_));
+        }
+
+        virtual void preProcess()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (front_ended_.erase(incoming_ptr_) == 0)
+                n_not_front_ended_++;
+            n_processed_++;
+            if (processed_time_stamps_ != nullptr)
+                processed_time_stamps_->push_back(incoming_ptr_->getTimeStamp());
+        }
+};
+
+int main()
+{
+    std::cout << std::endl << "==================== capture queue test ======================" << std::endl;
+
+    // Wolf problem with a tracker, and a motion processor providing the state of the key frames
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, new StateBlock(Eigen::VectorXs::Zero(2)),
+                                            new StateBlock(Eigen::VectorXs::Zero(1)),
+                                            new StateBlock(Eigen::VectorXs::Zero(2)), 2);
+    ProcessorTrackerFeaturePipelined* processor_ptr = new ProcessorTrackerFeaturePipelined();
+    problem_ptr->addSensor(sensor_ptr);
+    sensor_ptr->addProcessor(processor_ptr);
+
+    // Lock-free queue
+    CaptureQueue queue(2);
+    CaptureBase* capture_1 = new CaptureVoid(TimeStamp(1), sensor_ptr);
+    CaptureBase* capture_2 = new CaptureVoid(TimeStamp(2), sensor_ptr);
+    CaptureBase* capture_3 = new CaptureVoid(TimeStamp(3), sensor_ptr);
+    queue.push(capture_1);
+    queue.push(capture_2);
+    if (queue.push(capture_3) || queue.size() != 2)
+        throw std::runtime_error("Capture pushed to a full queue.");
+    if (queue.front() != capture_1 || queue.pop() != capture_1 || queue.pop() != capture_2 || queue.pop() != nullptr
+            || !queue.empty())
+        throw std::runtime_error("Captures not popped in arrival order.");
+    capture_1->destruct();
+    capture_2->destruct();
+    capture_3->destruct();
+    std::cout << "TEST CAPTURE QUEUE ------> OK!" << std::endl;
+
+    SensorBase* odom_sensor_ptr = new SensorBase(SEN_ODOM_2D, new StateBlock(Eigen::VectorXs::Zero(2)),
+                                                 new StateBlock(Eigen::VectorXs::Zero(1)),
+                                                 new StateBlock(Eigen::VectorXs::Zero(2)), 2);
+    ProcessorOdom2D* odom_processor_ptr = new ProcessorOdom2D();
+    problem_ptr->addSensor(odom_sensor_ptr);
+    odom_sensor_ptr->addProcessor(odom_processor_ptr);
+    odom_processor_ptr->setOrigin(problem_ptr->createFrame(KEY_FRAME, Eigen::Vector3s::Zero(), TimeStamp(0)));
+
+    // Without pipeline, enqueued Captures go to process() as they are
+    for (auto i = 0; i < 3; i++)
+        processor_ptr->enqueue(new CaptureVoid(TimeStamp(0), sensor_ptr));
+    if (processor_ptr->processQueue() != 3 || processor_ptr->n_not_front_ended_ != 3 || processor_ptr->getNumEnqueued() != 0)
+        throw std::runtime_error("Enqueued captures not processed.");
+    std::cout << "TEST QUEUE WITHOUT PIPELINE ------> OK!" << std::endl;
+
+    // Pipeline: a driver thread enqueues, the front-end runs on the worker, process() on this thread
+    processor_ptr->startPipeline();
+    const unsigned int n_captures = 200;
+    std::thread driver([&]()
+    {
+        for (unsigned int i = 0; i < n_captures; i++)
+        {
+            CaptureBase* capture_ptr = new CaptureVoid(TimeStamp(0), sensor_ptr);
+            while (!processor_ptr->enqueue(capture_ptr))
+                std::this_thread::yield(); // full: the driver would drop or wait
+        }
+    });
+    unsigned int n_processed = 0;
+    while (n_processed < n_captures)
+    {
+        n_processed += problem_ptr->processQueues();
+        std::this_thread::yield();
+    }
+    driver.join();
+    if (processor_ptr->n_processed_ != 3 + n_captures || processor_ptr->n_not_front_ended_ != 3
+            || processor_ptr->front_end_thread_id_ == std::this_thread::get_id() || processor_ptr->getNumEnqueued() != 0)
+        throw std::runtime_error("Captures not pipelined.");
+    std::cout << "TEST PIPELINE ------> OK!" << std::endl;
+
+    // Captures enqueued after stopping the pipeline skip the front-end
+    processor_ptr->stopPipeline();
+    processor_ptr->enqueue(new CaptureVoid(TimeStamp(0), sensor_ptr));
+    if (processor_ptr->isPipelined() || processor_ptr->processQueue() != 1 || processor_ptr->n_not_front_ended_ != 4)
+        throw std::runtime_error("Pipeline not stopped.");
+    std::cout << "TEST STOP PIPELINE ------> OK!" << std::endl;
+
+    // The oldest Capture is processed first, even if it is still in a slower front-end
+    SensorBase* slow_sensor_ptr = new SensorBase(SEN_ODOM_2D, new StateBlock(Eigen::VectorXs::Zero(2)),
+                                                 new StateBlock(Eigen::VectorXs::Zero(1)),
+                                                 new StateBlock(Eigen::VectorXs::Zero(2)), 2);
+    ProcessorTrackerFeaturePipelined* slow_processor_ptr = new ProcessorTrackerFeaturePipelined();
+    problem_ptr->addSensor(slow_sensor_ptr);
+    slow_sensor_ptr->addProcessor(slow_processor_ptr);
+    slow_processor_ptr->front_end_delay_ms_ = 50;
+    std::vector<TimeStamp> processed_time_stamps;
+    processor_ptr->processed_time_stamps_ = &processed_time_stamps;
+    slow_processor_ptr->processed_time_stamps_ = &processed_time_stamps;
+    processor_ptr->startPipeline();
+    slow_processor_ptr->startPipeline();
+    slow_processor_ptr->enqueue(new CaptureVoid(TimeStamp(1), slow_sensor_ptr));
+    processor_ptr->enqueue(new CaptureVoid(TimeStamp(2), sensor_ptr));
+    while (processor_ptr->getReadyCapturePtr() == nullptr)
+        std::this_thread::yield();
+    if (problem_ptr->processQueues() != 2 || processed_time_stamps.size() != 2
+            || processed_time_stamps[0].get() != 1 || processed_time_stamps[1].get() != 2)
+        throw std::runtime_error("Captures not processed in time-stamp order.");
+    processor_ptr->processed_time_stamps_ = nullptr;
+    slow_processor_ptr->processed_time_stamps_ = nullptr;
+    std::cout << "TEST PIPELINE ORDER ------> OK!" << std::endl;
+
+    // Captures left in the queues are destroyed with the processor
+    processor_ptr->enqueue(new CaptureVoid(TimeStamp(0), sensor_ptr));
+    processor_ptr->enqueue(new CaptureVoid(TimeStamp(0), sensor_ptr));
+
+    delete problem_ptr;
+
+    return 0;
+}
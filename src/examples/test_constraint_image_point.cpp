@@ -0,0 +1,187 @@
+/**
+ * \file test_constraint_image_point.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "constraint_image_point.h"
+
+// Wolf includes
+#include "problem.h"
+#include "frame_base.h"
+#include "capture_base.h"
+#include "feature_base.h"
+#include "landmark_base.h"
+#include "sensor_camera.h"
+#include "state_block.h"
+#include "state_quaternion.h"
+#include "state_homogeneous_3D.h"
+#include "local_parametrization_base.h"
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+/** Jacobians of the residual w.r.t. the tangent space of each state block, computed
+ * analytically, through the local parametrizations, and numerically, by finite differences of the residual along plus().
+ * Returns the max difference between both.
+ */
+Scalar jacobianError(ConstraintImagePoint* _ctr_ptr)
+{
+    const std::vector<StateBlock*> state_blocks = _ctr_ptr->getStatePtrVector();
+    std::vector<Eigen::VectorXs> states;
+    for (auto sb : state_blocks)
+        states.push_back(sb->getVector());
+
+    auto residual = [&](const std::vector<Eigen::VectorXs>& _states)
+    {
+        std::vector<Eigen::Map<const Eigen::VectorXs> > st_vector;
+        for (auto& st : _states)
+            st_vector.push_back(Eigen::Map<const Eigen::VectorXs>(st.data(), st.size()));
+        return Eigen::VectorXs(_ctr_ptr->evaluateResiduals(st_vector));
+    };
+
+    // Analytic jacobians
+    std::vector<Eigen::Map<const Eigen::VectorXs> > st_vector;
+    std::vector<Eigen::MatrixXs> jacobians;
+    std::vector<Eigen::Map<Eigen::MatrixXs> > jacobians_map;
+    for (auto& st : states)
+    {
+        st_vector.push_back(Eigen::Map<const Eigen::VectorXs>(st.data(), st.size()));
+        jacobians.push_back(Eigen::MatrixXs(2, st.size()));
+    }
+    for (auto& J : jacobians)
+        jacobians_map.push_back(Eigen::Map<Eigen::MatrixXs>(J.data(), J.rows(), J.cols()));
+    _ctr_ptr->evaluateJacobians(st_vector, jacobians_map, std::vector<bool>(states.size(), true));
+
+    Eigen::VectorXs r0 = residual(states);
+    const Scalar dx = 1e-6;
+    Scalar max_error = 0;
+    for (unsigned int b = 0; b < states.size(); b++)
+    {
+        LocalParametrizationBase* local_param_ptr = state_blocks[b]->getLocalParametrizationPtr();
+        unsigned int local_size = (local_param_ptr == nullptr ? states[b].size() : local_param_ptr->getLocalSize());
+
+        // tangent of the global parameters
+        Eigen::MatrixXs X_dx = Eigen::MatrixXs::Identity(states[b].size(), local_size);
+        if (local_param_ptr != nullptr)
+        {
+            Eigen::Map<Eigen::MatrixXs> X_dx_map(X_dx.data(), X_dx.rows(), X_dx.cols());
+            local_param_ptr->computeJacobian(st_vector[b], X_dx_map);
+        }
+        Eigen::MatrixXs J_analytic = jacobians[b] * X_dx;
+
+        Eigen::MatrixXs J_numeric(2, local_size);
+        for (unsigned int i = 0; i < local_size; i++)
+        {
+            std::vector<Eigen::VectorXs> states_plus = states;
+            Eigen::VectorXs delta = Eigen::VectorXs::Zero(local_size);
+            delta(i) = dx;
+            if (local_param_ptr == nullptr)
+                states_plus[b] += delta;
+            else
+            {
+                Eigen::Map<const Eigen::VectorXs> delta_map(delta.data(), local_size);
+                Eigen::Map<Eigen::VectorXs> x_plus_map(states_plus[b].data(), states_plus[b].size());
+                local_param_ptr->plus(st_vector[b], delta_map, x_plus_map);
+            }
+            J_numeric.col(i) = (residual(states_plus) - r0) / dx;
+        }
+        std::cout << "block " << b << " analytic jacobian:\n" << J_analytic << "\nnumeric jacobian:\n" << J_numeric << std::endl;
+        max_error = std::max(max_error, (J_analytic - J_numeric).cwiseAbs().maxCoeff());
+    }
+    return max_error;
+}
+
+int main()
+{
+    std::cout << std::endl << "==================== constraint image point test ======================" << std::endl;
+
+    Problem* problem_ptr = new Problem(FRM_PO_3D);
+
+    // Camera looking forward along the robot's X axis, with radial distortion
+    IntrinsicsCamera intrinsics;
+    intrinsics.width = 640;
+    intrinsics.height = 480;
+    intrinsics.pinhole_model << 320, 240, 320, 320;
+    intrinsics.distortion.resize(2);
+    intrinsics.distortion << -0.3, 0.1;
+    Eigen::VectorXs extrinsics(7);
+    extrinsics << 0.1, 0.2, 0.3, Eigen::Quaternions(Eigen::AngleAxis<Scalar>(-M_PI / 2, Eigen::Vector3s::UnitZ())
+            * Eigen::AngleAxis<Scalar>(-M_PI / 2, Eigen::Vector3s::UnitX())).coeffs();
+    SensorCamera* camera_ptr = new SensorCamera(extrinsics, &intrinsics);
+    problem_ptr->addSensor(camera_ptr);
+
+    // Frame with a generic pose
+    Eigen::VectorXs frame_state(7);
+    frame_state << 1, -2, 0.5, Eigen::Quaternions(Eigen::AngleAxis<Scalar>(0.3, Eigen::Vector3s(1, 2, 3).normalized())).coeffs();
+    FrameBase* frame_ptr = problem_ptr->createFrame(KEY_FRAME, frame_state, TimeStamp(0));
+    CaptureBase* capture_ptr = frame_ptr->addCapture(new CaptureBase(TimeStamp(0), camera_ptr));
+
+    // The same point ahead of the camera, as Euclidean and as homogeneous landmark
+    Eigen::Vector3s point(5, -1, 1);
+    Eigen::Vector4s homogeneous_point;
+    homogeneous_point << point * 0.5, 0.5;
+    LandmarkBase* ep_ptr = problem_ptr->addLandmark(new LandmarkBase(LANDMARK_POINT, new StateBlock(point)));
+    LandmarkBase* hp_ptr = problem_ptr->addLandmark(new LandmarkBase(LANDMARK_POINT, new StateHomogeneous3D(homogeneous_point.normalized())));
+
+    Eigen::Vector2s pixel(300, 200);
+    Eigen::Matrix2s pixel_cov = Eigen::Matrix2s::Identity() * 4;
+    FeatureBase* ep_feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_POINT_IMAGE, pixel, pixel_cov));
+    FeatureBase* hp_feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_POINT_IMAGE, pixel, pixel_cov));
+    ConstraintImagePoint* ep_ctr_ptr = (ConstraintImagePoint*)ep_feature_ptr->addConstraint(new ConstraintImagePoint(ep_feature_ptr, ep_ptr));
+    ConstraintImagePoint* hp_ctr_ptr = (ConstraintImagePoint*)hp_feature_ptr->addConstraint(new ConstraintImagePoint(hp_feature_ptr, hp_ptr));
+
+    bool ok = true;
+
+    // Types and block layout: landmark last
+    if (ep_ctr_ptr->getType() != CTR_IMG_PNT_TO_EP || hp_ctr_ptr->getType() != CTR_IMG_PNT_TO_HP
+            || ep_ctr_ptr->getStatePtrVector()[2] != ep_ptr->getPPtr() || hp_ctr_ptr->getStatePtrVector()[2] != hp_ptr->getPPtr())
+    {
+        std::cout << "TEST TYPES ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST TYPES ------> OK!" << std::endl;
+
+    // Both landmarks are the same point: same residual
+    Eigen::Vector2s u;
+    Eigen::MatrixXs U_p, U_q, U_l;
+    ep_ctr_ptr->expectation(frame_state.head(3), frame_state.tail(4), point, u, U_p, U_q, U_l, false);
+    Eigen::VectorXs ep_residual = ep_ctr_ptr->evaluateResiduals({Eigen::Map<const Eigen::VectorXs>(frame_state.data(), 3),
+                                                                  Eigen::Map<const Eigen::VectorXs>(frame_state.data() + 3, 4),
+                                                                  Eigen::Map<const Eigen::VectorXs>(point.data(), 3)});
+    Eigen::Vector4s h = hp_ptr->getPPtr()->getVector();
+    Eigen::VectorXs hp_residual = hp_ctr_ptr->evaluateResiduals({Eigen::Map<const Eigen::VectorXs>(frame_state.data(), 3),
+                                                                  Eigen::Map<const Eigen::VectorXs>(frame_state.data() + 3, 4),
+                                                                  Eigen::Map<const Eigen::VectorXs>(h.data(), 4)});
+    std::cout << "expected pixel: " << u.transpose() << std::endl;
+    std::cout << "residuals EP: " << ep_residual.transpose() << "  HP: " << hp_residual.transpose() << std::endl;
+    if (u(0) < 0 || u(1) < 0 || u(0) > intrinsics.width || u(1) > intrinsics.height
+            || (ep_residual - (u - pixel) / 2).norm() > 1e-9 || (ep_residual - hp_residual).norm() > 1e-9)
+    {
+        std::cout << "TEST RESIDUALS ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST RESIDUALS ------> OK!" << std::endl;
+
+    // Analytic vs. numeric jacobians
+    Scalar ep_error = jacobianError(ep_ctr_ptr);
+    Scalar hp_error = jacobianError(hp_ctr_ptr);
+    std::cout << "max jacobian error EP: " << ep_error << "  HP: " << hp_error << std::endl;
+    if (ep_error > 1e-3 || hp_error > 1e-3)
+    {
+        std::cout << "TEST JACOBIANS ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST JACOBIANS ------> OK!" << std::endl;
+
+    delete problem_ptr;
+
+    return ok ? 0 : -1;
+}
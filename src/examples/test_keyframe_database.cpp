@@ -0,0 +1,205 @@
+/**
+ * \file test_keyframe_database.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "vocabulary_tree.h"
+#include "keyframe_database.h"
+
+// Wolf includes
+#include "problem.h"
+#include "frame_base.h"
+#include "time_stamp.h"
+
+// General includes
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+using namespace wolf;
+
+/** The descriptors of an image of a place: the descriptors of the place,
+ * with some of them missing and a few bits of the others flipped.
+ */
+std::vector<unsigned char> observePlace(const std::vector<unsigned char>& _place, unsigned int _bytes, std::mt19937& _generator)
+{
+    std::uniform_real_distribution<Scalar> uniform(0, 1);
+    std::uniform_int_distribution<unsigned int> bit(0, _bytes * 8 - 1);
+    std::vector<unsigned char> image;
+    for (unsigned int i = 0; i < _place.size(); i += _bytes)
+    {
+        if (uniform(_generator) < 0.3)
+            continue;
+        std::vector<unsigned char> descriptor(_place.begin() + i, _place.begin() + i + _bytes);
+        for (unsigned int flip = 0; flip < 4; flip++)
+        {
+            unsigned int b = bit(_generator);
+            descriptor[b / 8] ^= 1 << (b % 8);
+        }
+        image.insert(image.end(), descriptor.begin(), descriptor.end());
+    }
+    return image;
+}
+
+int main()
+{
+    std::cout << std::endl << "==================== keyframe database test ======================" << std::endl;
+
+    const unsigned int bytes = 32; // ORB descriptors
+    const unsigned int n_places = 2000;
+    const unsigned int n_descriptors = 200;
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<unsigned int> random_byte(0, 255);
+
+    // Random places
+    std::vector<std::vector<unsigned char> > places(n_places, std::vector<unsigned char>(n_descriptors * bytes));
+    for (auto& place : places)
+        for (auto& b : place)
+            b = random_byte(generator);
+
+    // Vocabulary of 10^3 words, trained on the first places
+    VocabularyTree vocabulary;
+    TimeStamp t_start, t_end;
+    t_start.setToNow();
+    vocabulary.train(std::vector<std::vector<unsigned char> >(places.begin(), places.begin() + 100), bytes, 10, 3);
+    t_end.setToNow();
+    std::cout << "vocabulary of " << vocabulary.numWords() << " words trained in " << t_end - t_start << " s" << std::endl;
+
+    bool ok = true;
+
+    // Save and load
+    const std::string filename = "/tmp/test_keyframe_database.voc";
+    vocabulary.save(filename);
+    VocabularyTree loaded_vocabulary;
+    loaded_vocabulary.load(filename);
+    bool same_words = (loaded_vocabulary.numWords() == vocabulary.numWords());
+    for (unsigned int i = 0; same_words && i < n_descriptors; i++)
+        same_words = (loaded_vocabulary.getWord(&places[0][i * bytes]) == vocabulary.getWord(&places[0][i * bytes]));
+    if (!same_words)
+    {
+        std::cout << "TEST SAVE AND LOAD ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST SAVE AND LOAD ------> OK!" << std::endl;
+
+    // Corrupted files are rejected: huge size in the header, and out-of-range children of the root
+    std::vector<char> file_bytes;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        file_bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::remove(filename.c_str());
+    const unsigned int header_start = 8, n_nodes_start = header_start + 3 * sizeof(std::uint32_t);
+    std::uint32_t n_nodes;
+    std::memcpy(&n_nodes, &file_bytes[n_nodes_start], sizeof(n_nodes));
+    const unsigned int first_child_start = header_start + 5 * sizeof(std::uint32_t) + n_nodes * bytes;
+    std::vector<std::pair<unsigned int, std::uint32_t> > corruptions({{n_nodes_start, 0x7fffffff},
+                                                                      {first_child_start, n_nodes}});
+    unsigned int n_rejected = 0;
+    for (auto& corruption : corruptions)
+    {
+        std::vector<char> corrupted_bytes = file_bytes;
+        std::memcpy(&corrupted_bytes[corruption.first], &corruption.second, sizeof(std::uint32_t));
+        {
+            std::ofstream file(filename, std::ios::binary);
+            file.write(corrupted_bytes.data(), corrupted_bytes.size());
+        }
+        VocabularyTree corrupted_vocabulary;
+        try
+        {
+            corrupted_vocabulary.load(filename);
+        }
+        catch (std::runtime_error& e)
+        {
+            n_rejected++;
+        }
+        std::remove(filename.c_str());
+    }
+    if (n_rejected != corruptions.size())
+    {
+        std::cout << "TEST LOAD CORRUPTED ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST LOAD CORRUPTED ------> OK!" << std::endl;
+
+    // One KeyFrame per place
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    std::vector<FrameBase*> keyframes;
+    KeyFrameDatabase database;
+    BowVector bow;
+    t_start.setToNow();
+    for (unsigned int p = 0; p < n_places; p++)
+    {
+        keyframes.push_back(problem_ptr->createFrame(KEY_FRAME, Eigen::Vector3s::Zero(), TimeStamp(p)));
+        vocabulary.transform(places[p].data(), n_descriptors, bow);
+        database.addKeyFrame(keyframes.back(), bow);
+    }
+    t_end.setToNow();
+    std::cout << database.size() << " KeyFrames inserted in " << t_end - t_start << " s" << std::endl;
+
+    // Query new images of some places
+    const unsigned int n_queries = 100;
+    std::vector<KeyFrameCandidate> candidates;
+    unsigned int n_recognized = 0;
+    Scalar query_time = 0;
+    for (unsigned int q = 0; q < n_queries; q++)
+    {
+        unsigned int p = (q * 97) % n_places;
+        std::vector<unsigned char> image = observePlace(places[p], bytes, generator);
+        t_start.setToNow();
+        vocabulary.transform(image.data(), image.size() / bytes, bow);
+        database.query(bow, 5, 0, candidates);
+        t_end.setToNow();
+        query_time += t_end - t_start;
+        if (!candidates.empty() && candidates.front().frame_ptr == keyframes[p])
+            n_recognized++;
+    }
+    std::cout << "places recognized: " << n_recognized << " of " << n_queries << ", in " << 1000 * query_time / n_queries
+            << " ms per query" << std::endl;
+    if (n_recognized < 0.95 * n_queries)
+    {
+        std::cout << "TEST QUERY ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST QUERY ------> OK!" << std::endl;
+
+    // Scores of the inverted file and of the direct comparison agree
+    vocabulary.transform(places[7].data(), n_descriptors, bow);
+    database.query(bow, 1, 0, candidates);
+    if (candidates.empty() || candidates.front().frame_ptr != keyframes[7]
+            || std::abs(candidates.front().score - KeyFrameDatabase::score(bow, bow)) > 1e-9
+            || std::abs(candidates.front().score - 1) > 1e-9)
+    {
+        std::cout << "TEST SCORE ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST SCORE ------> OK!" << std::endl;
+
+    // Removed KeyFrames are not retrieved any more
+    database.removeKeyFrame(keyframes[7]);
+    database.query(bow, 5, 0, candidates);
+    bool removed = (database.size() == n_places - 1);
+    for (auto& candidate : candidates)
+        removed = removed && (candidate.frame_ptr != keyframes[7]) && (candidate.score < 0.5);
+    if (!removed)
+    {
+        std::cout << "TEST REMOVE ------> ERROR!" << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "TEST REMOVE ------> OK!" << std::endl;
+
+    delete problem_ptr;
+
+    return ok ? 0 : -1;
+}
@@ -8,11 +8,49 @@
 
 #include "local_parametrization_quaternion.h"
 #include "local_parametrization_homogeneous.h"
+#include "state_homogeneous_3D.h"
 
 #include "wolf.h"
 
 #include <iostream>
 
+/** Check the Jacobian of plus() w.r.t. the local delta, at delta = 0, against central differences.
+ * The rows follow the storage order of the global parameters, [x, y, z, w] for quaternions.
+ */
+bool checkJacobian(const wolf::LocalParametrizationBase& _par, const Eigen::VectorXs& _x, const std::string& _name)
+{
+    using namespace Eigen;
+    using namespace wolf;
+
+    MatrixXs J_storage(4, 3);
+    Map<MatrixXs> J(J_storage.data(), 4, 3);
+    Map<const VectorXs> x(_x.data(), 4);
+    _par.computeJacobian(x, J);
+
+    const Scalar eps = 1e-6;
+    MatrixXs J_num(4, 3);
+    VectorXs x_plus(4), x_minus(4);
+    Map<VectorXs> x_plus_map(x_plus.data(), 4), x_minus_map(x_minus.data(), 4);
+    for (int i = 0; i < 3; i++)
+    {
+        VectorXs delta = VectorXs::Zero(3);
+        delta(i) = eps;
+        _par.plus(x, Map<const VectorXs>(delta.data(), 3), x_plus_map);
+        delta(i) = -eps;
+        _par.plus(x, Map<const VectorXs>(delta.data(), 3), x_minus_map);
+        J_num.col(i) = (x_plus - x_minus) / (2 * eps);
+    }
+
+    if ((J_storage - J_num).norm() > 1e-6)
+    {
+        std::cout << "TEST " << _name << " JACOBIAN ------> ERROR!" << std::endl;
+        std::cout << " J = \n" << J_storage << "\n J_num = \n" << J_num << std::endl;
+        return false;
+    }
+    std::cout << "TEST " << _name << " JACOBIAN ------> OK!" << std::endl;
+    return true;
+}
+
 int main(){
 
     using namespace Eigen;
@@ -77,6 +115,17 @@ int main(){
     Hpar.computeJacobian(h_const,J);
     cout << " J = " << J << "\n" << endl;
 
+    bool ok = true;
+    VectorXs qn = q;
+    ok = checkJacobian(Qpar, qn, "GLOBAL D_QUAT") && ok;
+    ok = checkJacobian(Qpar_loc, qn, "LOCAL D_QUAT") && ok;
+    VectorXs hn = h;
+    ok = checkJacobian(Hpar, hn, "HOMOGENEOUS") && ok;
+
+    // The homogeneous state block owns its local parametrization, deleted once by the base class
+    StateHomogeneous3D* state_ptr = new StateHomogeneous3D();
+    delete state_ptr;
+    cout << "TEST HOMOGENEOUS STATE DESTRUCTION ------> OK!" << endl;
 
-    return 0;
+    return ok ? 0 : -1;
 }
@@ -0,0 +1,93 @@
+/**
+ * \file test_mahalanobis_gating.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "data_association/mahalanobis_gating.h"
+
+// General includes
+#include <iostream>
+#include <iomanip>      // std::setprecision
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+using namespace wolf;
+
+/** Random symmetric positive definite 3x3 covariance, with condition numbers up to ~1e6
+ */
+Eigen::Matrix3s randomCovariance()
+{
+    Eigen::Matrix3s A = Eigen::Matrix3s::Random();
+    Eigen::Vector3s sigmas = (3 * Eigen::Vector3s::Random()).array().exp();
+    Eigen::Matrix3s Q = Eigen::HouseholderQR<Eigen::Matrix3s>(A).householderQ();
+    return Q * sigmas.asDiagonal() * sigmas.asDiagonal() * Q.transpose();
+}
+
+int main()
+{
+    std::cout << std::setprecision(4);
+
+    std::cout << "\n====== Test Mahalanobis gating ======" << std::endl;
+
+    srand(0);
+    const unsigned int N = 1000;
+
+    // Random innovations and covariances
+    InnovationBatch3 innovations(3, N);
+    CovarianceBatch3 covariances(6, N);
+    std::vector<Eigen::Matrix3s, Eigen::aligned_allocator<Eigen::Matrix3s> > S(N);
+    for (unsigned int i = 0; i < N; i++)
+    {
+        S[i] = randomCovariance();
+        innovations.col(i) = 10 * Eigen::Vector3s::Random();
+        setBatchCovariance(covariances, i, S[i]);
+    }
+    InnovationBatch3 d = innovations;
+
+    // Batch distances vs. the explicit inverse
+    Eigen::VectorXs squared_distances;
+    squaredMahalanobisDistances(innovations, covariances, squared_distances);
+    if (squared_distances.size() != N)
+    {
+        std::cout << "TEST MAHALANOBIS GATING ------> ERROR! " << squared_distances.size() << " distances for " << N
+                  << " pairs" << std::endl;
+        return -1;
+    }
+    Scalar max_error = 0;
+    for (unsigned int i = 0; i < N; i++)
+    {
+        Eigen::Vector3s di = d.col(i);
+        Scalar expected = di.transpose() * S[i].inverse() * di;
+        max_error = std::max(max_error, std::abs(squared_distances(i) - expected) / expected);
+    }
+    std::cout << "max relative error w.r.t. S.inverse(): " << max_error << std::endl;
+    if (max_error > 1e-6)
+    {
+        std::cout << "TEST MAHALANOBIS GATING ------> ERROR!" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST MAHALANOBIS GATING ------> OK!" << std::endl;
+
+    // Covariances that are not positive definite get an infinite distance
+    innovations = d.leftCols(3);
+    covariances.resize(6, 3);
+    setBatchCovariance(covariances, 0, Eigen::Matrix3s::Identity());
+    setBatchCovariance(covariances, 1, -Eigen::Matrix3s::Identity());
+    setBatchCovariance(covariances, 2, Eigen::Vector3s(1, 1, 0).asDiagonal());
+    squaredMahalanobisDistances(innovations, covariances, squared_distances);
+    if (std::abs(squared_distances(0) - d.col(0).squaredNorm()) > 1e-9 * d.col(0).squaredNorm()
+            || !std::isinf(squared_distances(1)) || !std::isinf(squared_distances(2)))
+    {
+        std::cout << "TEST MAHALANOBIS GATING NOT POSITIVE DEFINITE ------> ERROR! distances "
+                  << squared_distances.transpose() << std::endl;
+        return -1;
+    }
+    std::cout << "TEST MAHALANOBIS GATING NOT POSITIVE DEFINITE ------> OK!" << std::endl;
+
+    return 0;
+}
@@ -7,6 +7,7 @@
 
 // Classes under test
 #include "processor_odom_3D.h"
+#include "processor_odom_2D.h"
 #include "capture_motion2.h"
 
 // Wolf includes
@@ -24,13 +25,61 @@
 #include <iostream>
 #include <iomanip>      // std::setprecision
 
+using namespace wolf;
+
+/** Odometry processor exposing its composition, to check it against finite differences
+ */
+template<class ProcessorOdom>
+class ProcessorOdomTester : public ProcessorOdom
+{
+    public:
+        using ProcessorOdom::deltaPlusDelta;
+        using ProcessorOdom::deltaCovPlusDeltaCov;
+};
+
+/** Random symmetric positive definite matrix
+ */
+Eigen::MatrixXs randomCovariance(int _size)
+{
+    Eigen::MatrixXs M = Eigen::MatrixXs::Random(_size, _size);
+    return M * M.transpose() + 0.1 * Eigen::MatrixXs::Identity(_size, _size);
+}
+
+/** Check the Jacobians of deltaPlusDelta() against central differences,
+ * and the structured deltaCovPlusDeltaCov() against the dense J1*P1*J1' + J2*P2*J2'
+ */
+template<class ProcessorOdom>
+bool checkComposition(ProcessorOdomTester<ProcessorOdom>& _odom, const Eigen::VectorXs& _delta1,
+                      const Eigen::VectorXs& _delta2)
+{
+    const int n = _delta1.size();
+    const Scalar h = 1e-6;
+    Eigen::VectorXs delta(n), delta_plus(n), delta_minus(n);
+    Eigen::MatrixXs J1(n, n), J2(n, n), J1_fd(n, n), J2_fd(n, n);
+    _odom.deltaPlusDelta(_delta1, _delta2, delta, J1, J2);
+    for (int i = 0; i < n; i++)
+    {
+        Eigen::VectorXs dx = Eigen::VectorXs::Unit(n, i) * h;
+        _odom.deltaPlusDelta(_delta1 + dx, _delta2, delta_plus);
+        _odom.deltaPlusDelta(_delta1 - dx, _delta2, delta_minus);
+        J1_fd.col(i) = (delta_plus - delta_minus) / (2 * h);
+        _odom.deltaPlusDelta(_delta1, _delta2 + dx, delta_plus);
+        _odom.deltaPlusDelta(_delta1, _delta2 - dx, delta_minus);
+        J2_fd.col(i) = (delta_plus - delta_minus) / (2 * h);
+    }
+
+    Eigen::MatrixXs P1 = randomCovariance(n), P2 = randomCovariance(n), P(n, n);
+    _odom.deltaCovPlusDeltaCov(P1, P2, J1, J2, P);
+    Eigen::MatrixXs P_dense = J1 * P1 * J1.transpose() + J2 * P2 * J2.transpose();
+
+    return (J1 - J1_fd).norm() < 1e-6 && (J2 - J2_fd).norm() < 1e-6 && (P - P_dense).norm() < 1e-12 * P_dense.norm();
+}
+
 int main()
 {
 
     std::cout << std::setprecision(3);
 
-    using namespace wolf;
-
     // time
     TimeStamp t0, t;
     t0.setToNow();
@@ -146,6 +195,188 @@ int main()
     std::cout << ">" << std::endl;
 
 
+    // Batch integration
+
+    std::cout << "\nIntegrating a batch of data in one call..." << std::endl;
+
+    ProcessorOdom3D* odom3d_single_ptr = new ProcessorOdom3D();
+    ProcessorOdom3D* odom3d_batch_ptr  = new ProcessorOdom3D();
+    sensor_ptr->addProcessor(odom3d_single_ptr);
+    sensor_ptr->addProcessor(odom3d_batch_ptr);
+    odom3d_single_ptr->setOrigin(x0, t0);
+    odom3d_batch_ptr->setOrigin(x0, t0);
+
+    // raw driver block: one sample per row, as it would come from a driver or a memory-mapped file
+    const int n_samples = 10;
+    Scalar raw_block[n_samples * 6];
+    std::vector<TimeStamp> ts_list;
+    for (int i = 0; i < n_samples; i++)
+    {
+        ts_list.push_back(t0 + (i+1)*dt);
+        Eigen::Map<Eigen::VectorXs>(raw_block + 6*i, 6) = data * (i+1) / n_samples;
+    }
+
+    CaptureMotion2* cap_single_ptr = new CaptureMotion2(t0, sensor_ptr, data, data_cov);
+    for (int i = 0; i < n_samples; i++)
+    {
+        cap_single_ptr->setTimeStamp(ts_list[i]);
+        cap_single_ptr->setData(Eigen::Map<Eigen::VectorXs>(raw_block + 6*i, 6));
+        odom3d_single_ptr->process(cap_single_ptr);
+    }
+    odom3d_batch_ptr->process(ts_list, Eigen::Map<Eigen::MatrixXs>(raw_block, n_samples, 6), data_cov);
+
+    std::cout << "State single : " << odom3d_single_ptr->getCurrentState().transpose() << std::endl;
+    std::cout << "State batch  : " << odom3d_batch_ptr->getCurrentState().transpose() << std::endl;
+    if (odom3d_batch_ptr->getBufferPtr()->get().size() != odom3d_single_ptr->getBufferPtr()->get().size())
+        throw std::runtime_error("Batch buffer size different from reference.");
+    if ((odom3d_batch_ptr->getCurrentState() - odom3d_single_ptr->getCurrentState()).norm() > 1e-12)
+        throw std::runtime_error("Batch integrated state different from reference.");
+    else
+        std::cout << "TEST BATCH CHECK ------> OK!" << std::endl;
+
+
+    // Delayed data
+
+    std::cout << "\nIntegrating data received out of order..." << std::endl;
+
+    ProcessorOdom3D* odom3d_ordered_ptr = new ProcessorOdom3D();
+    ProcessorOdom3D* odom3d_delayed_ptr = new ProcessorOdom3D();
+    sensor_ptr->addProcessor(odom3d_ordered_ptr);
+    sensor_ptr->addProcessor(odom3d_delayed_ptr);
+    odom3d_ordered_ptr->setOrigin(x0, t0);
+    odom3d_delayed_ptr->setOrigin(x0, t0);
+
+    // the delayed processor receives every pair of samples swapped
+    std::vector<TimeStamp> ts_ordered, ts_delayed;
+    std::vector<Eigen::VectorXs> data_ordered, data_delayed;
+    for (int i = 0; i < n_samples; i++)
+    {
+        ts_ordered.push_back(ts_list[i]);
+        data_ordered.push_back(Eigen::Map<Eigen::VectorXs>(raw_block + 6*i, 6));
+    }
+    for (int i = 0; i < n_samples; i++)
+    {
+        int j = (i % 2 == 0 ? i+1 : i-1);
+        ts_delayed.push_back(ts_ordered[j]);
+        data_delayed.push_back(data_ordered[j]);
+    }
+    odom3d_ordered_ptr->process(ts_ordered, Eigen::Map<Eigen::MatrixXs>(raw_block, n_samples, 6), data_cov);
+    CaptureMotion2* cap_delayed_ptr = new CaptureMotion2(t0, sensor_ptr, data, data_cov);
+    for (int i = 0; i < n_samples; i++)
+    {
+        cap_delayed_ptr->setTimeStamp(ts_delayed[i]);
+        cap_delayed_ptr->setData(data_delayed[i]);
+        odom3d_delayed_ptr->process(cap_delayed_ptr);
+    }
+
+    std::cout << "Delayed buffer: < ";
+    for (const auto &s : odom3d_delayed_ptr->getBufferPtr()->get() )
+        std::cout << s.ts_ - t0 << ' ';
+    std::cout << ">" << std::endl;
+    std::cout << "State ordered : " << odom3d_ordered_ptr->getCurrentState().transpose() << std::endl;
+    std::cout << "State delayed : " << odom3d_delayed_ptr->getCurrentState().transpose() << std::endl;
+    if (odom3d_delayed_ptr->getBufferPtr()->get().size() != odom3d_ordered_ptr->getBufferPtr()->get().size())
+        throw std::runtime_error("Delayed data lost.");
+    if ((odom3d_delayed_ptr->getCurrentState() - odom3d_ordered_ptr->getCurrentState()).norm() > 1e-12)
+        throw std::runtime_error("Delayed data integrated state different from reference.");
+    if ((odom3d_delayed_ptr->getBufferPtr()->get().back().delta_integr_cov_ - odom3d_ordered_ptr->getBufferPtr()->get().back().delta_integr_cov_).norm() > 1e-12)
+        throw std::runtime_error("Delayed data integrated covariance different from reference.");
+
+    // data older than the maximum delay is dropped
+    odom3d_delayed_ptr->setMaxDelay(dt);
+    cap_delayed_ptr->setTimeStamp(ts_ordered[n_samples-3]);
+    odom3d_delayed_ptr->process(cap_delayed_ptr);
+    if (odom3d_delayed_ptr->getBufferPtr()->get().size() != odom3d_ordered_ptr->getBufferPtr()->get().size()
+            || odom3d_delayed_ptr->getNumDropped() != 1)
+        throw std::runtime_error("Data delayed beyond the maximum delay not dropped.");
+    else
+        std::cout << "TEST DELAYED DATA CHECK ------> OK!" << std::endl;
+
+
+    // Buffer compression
+
+    std::cout << "\nCompressing the buffer..." << std::endl;
+
+    ProcessorOdom3D* odom3d_short_ptr = new ProcessorOdom3D();
+    ProcessorOdom3D* odom3d_still_ptr = new ProcessorOdom3D();
+    sensor_ptr->addProcessor(odom3d_short_ptr);
+    sensor_ptr->addProcessor(odom3d_still_ptr);
+    odom3d_short_ptr->setOrigin(x0, t0);
+    odom3d_still_ptr->setOrigin(x0, t0);
+
+    // bounded length: the oldest motions are merged
+    odom3d_short_ptr->setMaxBufferLength(4);
+    odom3d_short_ptr->process(ts_list, Eigen::Map<Eigen::MatrixXs>(raw_block, n_samples, 6), data_cov);
+
+    std::cout << "Short buffer: < ";
+    for (const auto &s : odom3d_short_ptr->getBufferPtr()->get() )
+        std::cout << s.ts_ - t0 << ' ';
+    std::cout << ">" << std::endl;
+    if (odom3d_short_ptr->getBufferPtr()->get().size() != 4)
+        throw std::runtime_error("Buffer longer than its maximum length.");
+    for (const auto &s : odom3d_short_ptr->getBufferPtr()->get() )
+        if ((odom3d_short_ptr->getState(s.ts_) - odom3d_ordered_ptr->getState(s.ts_)).norm() > 1e-12)
+            throw std::runtime_error("Compressed buffer state different from reference at a retained time stamp.");
+    if ((odom3d_short_ptr->getBufferPtr()->get().back().delta_integr_cov_ - odom3d_ordered_ptr->getBufferPtr()->get().back().delta_integr_cov_).norm() > 1e-12)
+        throw std::runtime_error("Compressed buffer covariance different from reference.");
+
+    // threshold: a robot standing still does not grow the buffer
+    odom3d_still_ptr->setBufferCompressionThreshold(1e-3);
+    Eigen::MatrixXs data_still = Eigen::MatrixXs::Constant(n_samples, 6, 1e-6);
+    odom3d_still_ptr->process(ts_list, data_still, data_cov);
+
+    std::cout << "Still buffer: < ";
+    for (const auto &s : odom3d_still_ptr->getBufferPtr()->get() )
+        std::cout << s.ts_ - t0 << ' ';
+    std::cout << ">" << std::endl;
+    if (odom3d_still_ptr->getBufferPtr()->get().size() != 2)
+        throw std::runtime_error("Buffer of small motions not compressed.");
+    else
+        std::cout << "TEST BUFFER COMPRESSION CHECK ------> OK!" << std::endl;
+
+
+    // Jacobians and covariance composition
+
+    std::cout << "\nChecking the Jacobians and the covariance composition..." << std::endl;
+
+    ProcessorOdomTester<ProcessorOdom2D> odom2d_tester;
+    ProcessorOdomTester<ProcessorOdom3D> odom3d_tester;
+    for (int i = 0; i < 10; i++)
+    {
+        Eigen::VectorXs delta1_2d = Eigen::VectorXs::Random(3), delta2_2d = Eigen::VectorXs::Random(3);
+        if (!checkComposition(odom2d_tester, delta1_2d, delta2_2d))
+            throw std::runtime_error("Bad 2D composition Jacobians or covariance.");
+
+        Eigen::VectorXs delta1_3d(7), delta2_3d(7);
+        delta1_3d << Eigen::Vector3s::Random(), Eigen::Quaternions::UnitRandom().coeffs();
+        delta2_3d << Eigen::Vector3s::Random(), Eigen::Quaternions::UnitRandom().coeffs();
+        if (!checkComposition(odom3d_tester, delta1_3d, delta2_3d))
+            throw std::runtime_error("Bad 3D composition Jacobians or covariance.");
+    }
+
+    // data2delta(): the delta covariance is J*Q*J', with J the Jacobian of the quaternion wrt. the rotation vector
+    for (int i = 0; i < 10; i++)
+    {
+        Eigen::VectorXs data_3d = Eigen::VectorXs::Random(6);
+        if (i == 0)
+            data_3d.tail<3>().setZero(); // small angle approximation
+        Eigen::MatrixXs Q = randomCovariance(6);
+        Eigen::VectorXs delta_3d(7), delta_plus(7), delta_minus(7);
+        Eigen::MatrixXs delta_cov_3d(7, 7), unused_cov(7, 7), J_fd(7, 6);
+        odom3d_tester.data2delta(data_3d, Q, dt, delta_3d, delta_cov_3d);
+        const Scalar h = 1e-6;
+        for (int j = 0; j < 6; j++)
+        {
+            odom3d_tester.data2delta(data_3d + Eigen::VectorXs::Unit(6, j) * h, Q, dt, delta_plus, unused_cov);
+            odom3d_tester.data2delta(data_3d - Eigen::VectorXs::Unit(6, j) * h, Q, dt, delta_minus, unused_cov);
+            J_fd.col(j) = (delta_plus - delta_minus) / (2 * h);
+        }
+        if ((delta_cov_3d - J_fd * Q * J_fd.transpose()).norm() > 1e-6 * delta_cov_3d.norm())
+            throw std::runtime_error("Bad 3D data2delta covariance.");
+    }
+    std::cout << "TEST JACOBIANS CHECK ------> OK!" << std::endl;
+
+
     // Free allocated memory
     problem_ptr->destruct();
 
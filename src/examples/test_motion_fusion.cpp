@@ -0,0 +1,187 @@
+/**
+ * \file test_motion_fusion.cpp
+ *
+ *  Created on: Oct 19, 2016
+ */
+
+// Classes under test
+#include "processor_odom_3D.h"
+#include "capture_motion2.h"
+#include "problem.h"
+
+// Wolf includes
+#include "state_block.h"
+#include "state_quaternion.h"
+#include "wolf.h"
+
+// General includes
+#include <iostream>
+#include <iomanip>      // std::setprecision
+
+int main()
+{
+    std::cout << std::setprecision(3);
+
+    using namespace wolf;
+
+    // time
+    TimeStamp t0, t;
+    t0.setToNow();
+
+    // Origin frame:
+    Eigen::Vector3s pos(0, 0, 0);
+    Eigen::Quaternions quat(Eigen::Quaternions::Identity());
+    Eigen::Vector7s x0;
+    x0 << pos, quat.coeffs();
+
+    // motion data: both sensors observe the same motion of 1 m/s forward
+    Eigen::VectorXs data(6);
+    Eigen::MatrixXs data_cov = 0.01 * Eigen::MatrixXs::Identity(6,6);
+
+    // Create Wolf tree nodes: one slow (e.g. wheel odometry, 40 Hz) and one fast (e.g. IMU, 100 Hz) motion sensor
+    Problem* problem_ptr = new Problem(FRM_PO_3D);
+    SensorBase* sensor_slow_ptr = new SensorBase(SEN_ODOM_2D, new StateBlock(pos, true), new StateQuaternion(quat, true),
+                                                 new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    SensorBase* sensor_fast_ptr = new SensorBase(SEN_ODOM_2D, new StateBlock(pos, true), new StateQuaternion(quat, true),
+                                                 new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom3D* odom_slow_ptr = new ProcessorOdom3D();
+    ProcessorOdom3D* odom_fast_ptr = new ProcessorOdom3D();
+    sensor_slow_ptr->addProcessor(odom_slow_ptr);
+    sensor_fast_ptr->addProcessor(odom_fast_ptr);
+    problem_ptr->addSensor(sensor_slow_ptr);
+    problem_ptr->addSensor(sensor_fast_ptr);
+
+    if (problem_ptr->getProcessorMotionPtr() != nullptr)
+        throw std::runtime_error("Processor motion available before setting the origin.");
+
+    // Both processors share the same origin key frame
+    FrameBase* origin_frame = problem_ptr->createFrame(KEY_FRAME, x0, t0);
+    odom_slow_ptr->setOrigin(origin_frame);
+    odom_fast_ptr->setOrigin(origin_frame);
+
+    // Integrate 0.5 s of data at both rates
+    Scalar dt_slow = 0.025, dt_fast = 0.01;
+    CaptureMotion2* cap_slow_ptr = new CaptureMotion2(t0, sensor_slow_ptr, data, data_cov);
+    CaptureMotion2* cap_fast_ptr = new CaptureMotion2(t0, sensor_fast_ptr, data, data_cov);
+    for (int i = 1; i <= 50; i++)
+    {
+        t = t0 + i * dt_fast;
+        data << dt_fast, 0, 0, 0, 0, 0;
+        cap_fast_ptr->setTimeStamp(t);
+        cap_fast_ptr->setData(data);
+        odom_fast_ptr->process(cap_fast_ptr);
+    }
+    for (int i = 1; i <= 20; i++)
+    {
+        t = t0 + i * dt_slow;
+        data << dt_slow, 0, 0, 0, 0, 0;
+        cap_slow_ptr->setTimeStamp(t);
+        cap_slow_ptr->setData(data);
+        odom_slow_ptr->process(cap_slow_ptr);
+    }
+
+    std::cout << "Slow processor rate: " << odom_slow_ptr->getRate() << " Hz" << std::endl;
+    std::cout << "Fast processor rate: " << odom_fast_ptr->getRate() << " Hz" << std::endl;
+
+    if (problem_ptr->getProcessorMotionPtr() != odom_fast_ptr)
+        throw std::runtime_error("The state is not provided by the fastest processor.");
+
+    // Query state at a time stamp that only the fast processor has sampled
+    TimeStamp t_query = t0 + 0.33;
+    std::cout << "State(" << t_query - t0 << ") : " << problem_ptr->getStateAtTimeStamp(t_query).transpose() << std::endl;
+    if (fabs(problem_ptr->getStateAtTimeStamp(t_query)(0) - 0.33) > 1e-9)
+        throw std::runtime_error("Wrong state at query time stamp.");
+
+    // Create a key frame and notify all processors in one pass
+    TimeStamp t_key = t0 + 0.3;
+    FrameBase* key_frame_ptr = problem_ptr->createFrame(KEY_FRAME, t_key);
+    problem_ptr->keyFrameCallback(key_frame_ptr, nullptr, 0);
+
+    std::cout << "Key frame state    : " << key_frame_ptr->getState().transpose() << std::endl;
+    std::cout << "Key frame captures : " << key_frame_ptr->getCaptureListPtr()->size() << std::endl;
+    for (auto capture_ptr : *(key_frame_ptr->getCaptureListPtr()))
+    {
+        FeatureBase* feature_ptr = capture_ptr->getFeatureListPtr()->front();
+        std::cout << "\tmotion delta : " << feature_ptr->getMeasurement().transpose() << std::endl;
+        if (fabs(feature_ptr->getMeasurement()(0) - 0.3) > 1e-9)
+            throw std::runtime_error("Motion deltas not split at the same key frame.");
+        if (feature_ptr->getConstraintListPtr()->size() != 1)
+            throw std::runtime_error("Motion constraint not created.");
+    }
+    if (key_frame_ptr->getCaptureListPtr()->size() != 2)
+        throw std::runtime_error("Not all motion processors created their constraint.");
+
+    // A key frame ahead of the slow processor's last data
+    data << dt_fast, 0, 0, 0, 0, 0;
+    cap_fast_ptr->setData(data);
+    for (int i = 51; i <= 60; i++)
+    {
+        cap_fast_ptr->setTimeStamp(t0 + i * dt_fast);
+        odom_fast_ptr->process(cap_fast_ptr);
+    }
+    key_frame_ptr = problem_ptr->createFrame(KEY_FRAME, t0 + 0.58);
+    problem_ptr->keyFrameCallback(key_frame_ptr, nullptr, 0);
+    std::cout << "Key frame state    : " << key_frame_ptr->getState().transpose() << std::endl;
+
+    // The slow processor splits its buffer only when its data passes the key frame
+    if (odom_slow_ptr->getNumPendingKeyFrames() != 1 || odom_fast_ptr->getNumPendingKeyFrames() != 0
+            || key_frame_ptr->getCaptureListPtr()->size() != 1)
+        throw std::runtime_error("Key frame ahead of the slow processor's data not deferred.");
+    data << dt_slow, 0, 0, 0, 0, 0;
+    cap_slow_ptr->setData(data);
+    for (int i = 21; i <= 24; i++)
+    {
+        cap_slow_ptr->setTimeStamp(t0 + i * dt_slow);
+        odom_slow_ptr->process(cap_slow_ptr);
+        if ((i < 24) != (odom_slow_ptr->getNumPendingKeyFrames() == 1))
+            throw std::runtime_error("Buffer not split when the slow processor's data passed the key frame.");
+    }
+    std::cout << "Slow processor state after key frame: " << odom_slow_ptr->getCurrentState().transpose() << std::endl;
+
+    // No slow data lost: the deltas before and after the key frame add up to all the data integrated since 0.3 s
+    if (key_frame_ptr->getCaptureListPtr()->size() != 2)
+        throw std::runtime_error("Slow processor did not create its motion constraint.");
+    Scalar slow_delta_before = 0;
+    for (auto capture_ptr : *(key_frame_ptr->getCaptureListPtr()))
+        if (capture_ptr->getSensorPtr() == sensor_slow_ptr)
+            slow_delta_before = capture_ptr->getFeatureListPtr()->front()->getMeasurement()(0);
+    Scalar slow_delta_after = odom_slow_ptr->getMotion().delta_integr_(0);
+    std::cout << "Slow motion deltas : " << slow_delta_before << " + " << slow_delta_after << std::endl;
+    if (fabs(slow_delta_before - 0.275) > 1e-9 || fabs(slow_delta_before + slow_delta_after - 0.3) > 1e-9)
+        throw std::runtime_error("Slow motion data lost at the key frame.");
+
+    // Captures handed over by the sensor drivers, and processed in time-stamp order by the Problem
+    std::list<CaptureMotion2*> captures;
+    Scalar x_slow = odom_slow_ptr->getCurrentState()(0);
+    Scalar x_fast = odom_fast_ptr->getCurrentState()(0);
+    for (int i = 1; i <= 4; i++)
+    {
+        data << dt_slow, 0, 0, 0, 0, 0;
+        captures.push_back(new CaptureMotion2(t0 + 0.6 + i * dt_slow, sensor_slow_ptr, data, data_cov));
+        odom_slow_ptr->enqueue(captures.back());
+        data << 2 * dt_fast, 0, 0, 0, 0, 0;
+        captures.push_back(new CaptureMotion2(t0 + 0.6 + 2 * i * dt_fast, sensor_fast_ptr, data, data_cov));
+        odom_fast_ptr->enqueue(captures.back());
+    }
+    unsigned int n_processed = problem_ptr->processQueues();
+    std::cout << "Processed captures : " << n_processed << std::endl;
+    if (n_processed != 8 || odom_slow_ptr->getNumEnqueued() != 0 || odom_fast_ptr->getNumEnqueued() != 0)
+        throw std::runtime_error("Enqueued captures not processed.");
+    if (fabs(odom_slow_ptr->getCurrentState()(0) - x_slow - 4 * dt_slow) > 1e-9
+            || fabs(odom_fast_ptr->getCurrentState()(0) - x_fast - 8 * dt_fast) > 1e-9)
+        throw std::runtime_error("Wrong state after processing the enqueued captures.");
+    // the processors own their last incoming Capture only
+    captures.pop_back();
+    captures.pop_back();
+    captures.push_back(cap_slow_ptr);
+    captures.push_back(cap_fast_ptr);
+    for (auto capture_ptr : captures)
+        capture_ptr->destruct();
+
+    std::cout << "TEST MOTION FUSION ------> OK!" << std::endl;
+
+    // Free allocated memory
+    problem_ptr->destruct();
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * \file test_pinhole_batch.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "pinholeTools.h"
+
+// Wolf includes
+#include "time_stamp.h"
+
+// General includes
+#include <iostream>
+#include <iomanip>      // std::setprecision
+
+using namespace wolf;
+using namespace pinhole;
+
+int main()
+{
+    std::cout << std::setprecision(4);
+
+    std::cout << "\n====== Test pinhole batch projection ======" << std::endl;
+
+    Eigen::Vector4s k(320, 240, 320, 320);
+    Eigen::Vector2s d(-0.3, 0.1);
+    Eigen::Vector2s c;
+    computeCorrectionModel(k, d, c);
+
+    // Points in front of the camera
+    const unsigned int N = 1000;
+    srand(0);
+    Eigen::Matrix<Scalar, 3, Eigen::Dynamic> v = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>::Random(3, N);
+    v.row(2) = v.row(2).array().abs() + 1;
+
+    // Batch projection
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> u, u_J, U_v;
+    TimeStamp t0, t1;
+    t0.setToNow();
+    projectPoints(k, d, v, u_J, U_v);
+    t1.setToNow();
+    projectPoints(k, d, v, u);
+    std::cout << "batch projection of " << N << " points with Jacobians: " << 1e3 * (t1 - t0) << " ms" << std::endl;
+
+    // One point at a time
+    Scalar max_error_u = 0, max_error_J = 0;
+    Eigen::Vector2s ui;
+    Eigen::Matrix<Scalar, 2, 3> U_vi;
+    t0.setToNow();
+    for (unsigned int i = 0; i < N; i++)
+    {
+        projectPoint(k, d, v.col(i), ui, U_vi);
+        max_error_u = std::max(max_error_u, (ui - u.col(i)).norm());
+        max_error_u = std::max(max_error_u, (ui - u_J.col(i)).norm());
+        max_error_J = std::max(max_error_J, (U_vi - U_v.block<2, 3>(0, 3 * i)).norm());
+    }
+    t1.setToNow();
+    std::cout << "point by point, with Jacobians and checks: " << 1e3 * (t1 - t0) << " ms" << std::endl;
+    std::cout << "max errors: projection " << max_error_u << "; Jacobian " << max_error_J << std::endl;
+
+    if (max_error_u > 1e-9 || max_error_J > 1e-9)
+    {
+        std::cout << "TEST PINHOLE BATCH PROJECTION ------> ERROR!" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST PINHOLE BATCH PROJECTION ------> OK!" << std::endl;
+
+    // Batch back-projection
+    Eigen::Matrix<Scalar, 3, Eigen::Dynamic> p;
+    backprojectPoints(k, c, u, p, 2.0);
+    Scalar max_error_p = 0;
+    for (unsigned int i = 0; i < N; i++)
+        max_error_p = std::max(max_error_p, (backprojectPoint(k, c, u.col(i), 2.0) - p.col(i)).norm());
+    std::cout << "max error: back-projection " << max_error_p << std::endl;
+
+    if (max_error_p > 1e-9)
+    {
+        std::cout << "TEST PINHOLE BATCH BACK-PROJECTION ------> ERROR!" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST PINHOLE BATCH BACK-PROJECTION ------> OK!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * \file test_processor_image_klt.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_image_klt.h"
+
+// Wolf includes
+#include "problem.h"
+#include "sensor_camera.h"
+#include "capture_image.h"
+#include "feature_point_image.h"
+#include "processor_factory.h"
+#include "state_block.h"
+
+// OpenCV includes
+#include <opencv2/imgproc/imgproc.hpp>
+
+// General includes
+#include <iostream>
+#include <map>
+
+using namespace wolf;
+
+/** Textured scene, larger than the images: random rectangles and disks of random gray levels, slightly blurred
+ */
+cv::Mat makeScene(int _width, int _height)
+{
+    cv::RNG rng(1);
+    cv::Mat scene(_height, _width, CV_8UC1, cv::Scalar(128));
+    for (unsigned int i = 0; i < 400; i++)
+    {
+        cv::Point center(rng.uniform(0, _width), rng.uniform(0, _height));
+        int size = rng.uniform(4, 20);
+        cv::Scalar gray(rng.uniform(0, 256));
+        if (i % 2)
+            cv::rectangle(scene, cv::Rect(center.x, center.y, size, size), gray, -1); // filled
+        else
+            cv::circle(scene, center, size / 2, gray, -1); // filled
+    }
+    cv::GaussianBlur(scene, scene, cv::Size(3, 3), 0);
+    return scene;
+}
+
+int main()
+{
+    std::cout << std::endl << "==================== processor image KLT test ======================" << std::endl;
+
+    const unsigned int width = 640, height = 360;
+    const cv::Point2f shift(-2, -1); // image motion of the scene, in pixels per frame
+
+    // Wolf problem with a camera
+    Problem* problem_ptr = new Problem(FRM_PO_3D);
+    Eigen::Vector4s k(320, 180, 320, 320);
+    SensorCamera* camera_ptr = new SensorCamera(new StateBlock(Eigen::Vector3s::Zero()),
+                                                new StateBlock(Eigen::Vector3s::Zero()),
+                                                new StateBlock(k, false), width, height);
+    problem_ptr->addSensor(camera_ptr);
+
+    DetectorDescriptorParamsOrb orb_params;
+    orb_params.type = DD_ORB;
+
+    ProcessorImageKLTParameters params;
+    params.image.width = width;
+    params.image.height = height;
+    params.detector_descriptor_params_ptr = &orb_params;
+    params.matcher.min_normalized_score = 0.75;
+    params.matcher.similarity_norm = cv::NORM_HAMMING;
+    params.matcher.roi_width = 30;
+    params.matcher.roi_height = 30;
+    params.active_search.grid_width = 12;
+    params.active_search.grid_height = 8;
+    params.active_search.separation = 1;
+    params.algorithm.max_new_features = 60;
+    params.algorithm.min_features_for_keyframe = 20;
+    params.max_new_features = params.algorithm.max_new_features;
+
+    // Creation from the factory, with checked params
+    bool bad_params_rejected = false;
+    ProcessorImageParameters bad_params = params;
+    try
+    {
+        ProcessorFactory::get().create("IMAGE KLT", "bad KLT", &bad_params);
+    }
+    catch (std::runtime_error& e)
+    {
+        bad_params_rejected = true;
+    }
+    ProcessorImageKLT* processor_ptr = (ProcessorImageKLT*)ProcessorFactory::get().create("IMAGE KLT", "KLT", &params);
+    camera_ptr->addProcessor(processor_ptr);
+    if (!bad_params_rejected || processor_ptr->getName() != "KLT")
+        throw std::runtime_error("KLT processor not created by the factory.");
+    std::cout << "TEST FACTORY ------> OK!" << std::endl;
+
+    // Images of a scene moving at constant speed: the tracked features must follow it
+    cv::Mat scene = makeScene(width + 100, height + 60);
+    std::map<unsigned int, cv::Point2f> last_points; // by track id
+    for (unsigned int f = 0; f < 10; f++)
+    {
+        cv::Mat image = scene(cv::Rect(50 - (int)(f * shift.x), 40 - (int)(f * shift.y), width, height)).clone();
+        CaptureImage* capture_ptr = new CaptureImage(TimeStamp(0.1 * f), camera_ptr, image);
+        capture_ptr->process();
+
+        std::map<unsigned int, cv::Point2f> points;
+        unsigned int n_tracked = 0;
+        for (auto feature_base_ptr : *(processor_ptr->getLastPtr()->getFeatureListPtr()))
+        {
+            const cv::Point2f& point = ((FeaturePointImage*)feature_base_ptr)->getKeypoint().pt;
+            auto last_point_it = last_points.find(feature_base_ptr->trackId());
+            if (last_point_it != last_points.end())
+            {
+                if (cv::norm(point - last_point_it->second - shift) > 0.5)
+                    throw std::runtime_error("Feature " + std::to_string(feature_base_ptr->trackId()) + " not tracked at frame "
+                            + std::to_string(f) + ".");
+                n_tracked++;
+            }
+            points[feature_base_ptr->trackId()] = point;
+        }
+        if (f > 0 && n_tracked < params.algorithm.min_features_for_keyframe)
+            throw std::runtime_error("Only " + std::to_string(n_tracked) + " features tracked at frame " + std::to_string(f) + ".");
+        last_points.swap(points);
+    }
+    std::cout << "TEST TRACKING ------> OK!" << std::endl;
+
+    delete problem_ptr;
+
+    return 0;
+}
@@ -14,6 +14,7 @@
 #include "sensor_base.h"
 #include "state_block.h"
 #include "processor_tracker_feature_dummy.h"
+#include "processor_odom_2D.h"
 #include "capture_void.h"
 
 int main()
@@ -33,6 +34,15 @@ int main()
     wolf_problem_ptr_->addSensor(sensor_ptr_);
     sensor_ptr_->addProcessor(processor_ptr_);
 
+    // Motion processor providing the state of the key frames
+    SensorBase* odom_sensor_ptr_ = new SensorBase(SEN_ODOM_2D, new StateBlock(Eigen::VectorXs::Zero(2)),
+                                                  new StateBlock(Eigen::VectorXs::Zero(1)),
+                                                  new StateBlock(Eigen::VectorXs::Zero(2)), 2);
+    ProcessorOdom2D* odom_processor_ptr_ = new ProcessorOdom2D();
+    wolf_problem_ptr_->addSensor(odom_sensor_ptr_);
+    odom_sensor_ptr_->addProcessor(odom_processor_ptr_);
+    odom_processor_ptr_->setOrigin(wolf_problem_ptr_->createFrame(KEY_FRAME, Eigen::Vector3s::Zero(), TimeStamp(0)));
+
     std::cout << "sensor & processor created and added to wolf problem" << std::endl;
 
     for (auto i = 0; i < 10; i++)
@@ -7,6 +7,7 @@
 
 //std
 #include <iostream>
+#include <algorithm>
 
 //Wolf
 #include "wolf.h"
@@ -14,6 +15,12 @@
 #include "sensor_base.h"
 #include "state_block.h"
 #include "processor_tracker_landmark_dummy.h"
+#include "processor_odom_2D.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "map_base.h"
+#include "landmark_corner_2D.h"
+#include "state_homogeneous_3D.h"
 #include "capture_void.h"
 
 int main()
@@ -33,11 +40,112 @@ int main()
     wolf_problem_ptr_->addSensor(sensor_ptr_);
     sensor_ptr_->addProcessor(processor_ptr_);
 
+    // Motion processor providing the state of the key frames
+    SensorBase* odom_sensor_ptr_ = new SensorBase(SEN_ODOM_2D, new StateBlock(Eigen::VectorXs::Zero(2)),
+                                                  new StateBlock(Eigen::VectorXs::Zero(1)),
+                                                  new StateBlock(Eigen::VectorXs::Zero(2)), 2);
+    ProcessorOdom2D* odom_processor_ptr_ = new ProcessorOdom2D();
+    wolf_problem_ptr_->addSensor(odom_sensor_ptr_);
+    odom_sensor_ptr_->addProcessor(odom_processor_ptr_);
+    odom_processor_ptr_->setOrigin(wolf_problem_ptr_->createFrame(KEY_FRAME, Eigen::Vector3s::Zero(), TimeStamp(0)));
+
     std::cout << "sensor & processor created and added to wolf problem" << std::endl;
 
     for (auto i = 0; i < 10; i++)
         processor_ptr_->process(new CaptureVoid(TimeStamp(0), sensor_ptr_));
 
+    // Key frame policy: no key frames closer than 1s, and a feature budget per capture
+    auto countKeyFrames = [&]()
+    {
+        unsigned int n = 0;
+        for (auto frame_ptr : *(wolf_problem_ptr_->getTrajectoryPtr()->getFrameListPtr()))
+            if (frame_ptr->isKey())
+                n++;
+        return n;
+    };
+    unsigned int n_key_frames = countKeyFrames();
+    processor_ptr_->setKeyFramePolicy(0, 0, 1.0);
+    processor_ptr_->setTimeBudget(0.01);
+    for (auto i = 0; i < 10; i++)
+        processor_ptr_->process(new CaptureVoid(TimeStamp(0.01 * i), sensor_ptr_));
+    std::cout << "key frames: " << n_key_frames << " before policy, " << countKeyFrames() << " after policy" << std::endl;
+    if (countKeyFrames() != n_key_frames)
+        throw std::runtime_error("Key frame created before the minimum key frame period.");
+    if (processor_ptr_->getMaxNewFeaturesInBudget() < 1 || processor_ptr_->getMaxNewFeaturesInBudget() > 5)
+        throw std::runtime_error("Feature budget out of range.");
+
+    // ... and a key frame at least every 0.05s
+    processor_ptr_->setKeyFramePolicy(0, 0.05, 0);
+    for (auto i = 10; i < 20; i++)
+        processor_ptr_->process(new CaptureVoid(TimeStamp(0.01 * i), sensor_ptr_));
+    std::cout << "key frames: " << countKeyFrames() << " after max period policy" << std::endl;
+    if (countKeyFrames() < n_key_frames + 2)
+        throw std::runtime_error("Key frames not created after the maximum key frame period.");
+
+    // Spatial index of the map
+    MapBase* map_ptr = wolf_problem_ptr_->getMapPtr();
+    map_ptr->setLandmarkIndexCellSize(1.0);
+    unsigned int n_landmarks = map_ptr->getLandmarkListPtr()->size(); // all at the origin
+    LandmarkBase* landmark_far_ptr = map_ptr->addLandmark(new LandmarkCorner2D(new StateBlock(Eigen::Vector2s(10, 10)), new StateBlock(1)));
+    LandmarkBase* landmark_near_ptr = map_ptr->addLandmark(new LandmarkCorner2D(new StateBlock(Eigen::Vector2s(2, 0)), new StateBlock(1)));
+    LandmarkBaseList landmarks_in_range;
+    map_ptr->getLandmarksInRange(Eigen::Vector3s::Zero(), 3, landmarks_in_range);
+    std::cout << "landmarks in range: " << landmarks_in_range.size() << " of " << map_ptr->getLandmarkListPtr()->size() << std::endl;
+    if (landmarks_in_range.size() != n_landmarks + 1)
+        throw std::runtime_error("Wrong landmarks in range.");
+
+    // landmark moved by the solver
+    landmark_far_ptr->getPPtr()->setVector(Eigen::Vector2s(0.5, -0.5));
+    map_ptr->updateLandmarkIndex();
+    landmarks_in_range.clear();
+    map_ptr->getLandmarksInRange(Eigen::Vector3s::Zero(), 3, landmarks_in_range);
+    if (landmarks_in_range.size() != n_landmarks + 2)
+        throw std::runtime_error("Moved landmark not re-indexed.");
+
+    // landmarks at negative cells
+    landmark_far_ptr->getPPtr()->setVector(Eigen::Vector2s(-2.5, -0.5));
+    map_ptr->updateLandmarkIndex();
+    landmarks_in_range.clear();
+    map_ptr->getLandmarksInRange(Eigen::Vector3s(-2, -1, 0), 1, landmarks_in_range);
+    if (landmarks_in_range.size() != 1 || landmarks_in_range.front() != landmark_far_ptr)
+        throw std::runtime_error("Landmark in a negative cell not found.");
+
+    // homogeneous landmark, indexed at its Euclidean position, and not indexed at infinity
+    LandmarkBase* landmark_hp_ptr = map_ptr->addLandmark(new LandmarkBase(LANDMARK_POINT, new StateHomogeneous3D(Eigen::Vector4s(20, 0, 1, 2))));
+    landmarks_in_range.clear();
+    map_ptr->getLandmarksInRange(Eigen::Vector3s(10, 0, 0), 1, landmarks_in_range);
+    if (landmarks_in_range.size() != 1 || landmarks_in_range.front() != landmark_hp_ptr)
+        throw std::runtime_error("Homogeneous landmark not found at its Euclidean position.");
+    landmark_hp_ptr->getPPtr()->setVector(Eigen::Vector4s(1, 0, 0, 0));
+    map_ptr->updateLandmarkIndex();
+    landmarks_in_range.clear();
+    map_ptr->getLandmarksInRange(Eigen::Vector3s(10, 0, 0), 1, landmarks_in_range);
+    if (landmarks_in_range.size() != 1 || landmarks_in_range.front() != landmark_hp_ptr)
+        throw std::runtime_error("Homogeneous landmark at infinity not returned by all queries.");
+    landmark_hp_ptr->getPPtr()->setVector(Eigen::Vector4s(20, 0, 1, 2));
+    map_ptr->updateLandmarkIndex();
+    landmarks_in_range.clear();
+    map_ptr->getLandmarksInRange(Eigen::Vector3s::Zero(), 3, landmarks_in_range);
+    bool hp_found = (std::find(landmarks_in_range.begin(), landmarks_in_range.end(), landmark_hp_ptr) != landmarks_in_range.end());
+    if (hp_found)
+        throw std::runtime_error("Homogeneous landmark back from infinity not re-indexed.");
+    landmark_hp_ptr->destruct();
+    landmark_far_ptr->getPPtr()->setVector(Eigen::Vector2s(0.5, -0.5));
+    map_ptr->updateLandmarkIndex();
+
+    // landmark deleted
+    landmark_near_ptr->destruct();
+    landmarks_in_range.clear();
+    map_ptr->getLandmarksInRange(Eigen::Vector3s::Zero(), 3, landmarks_in_range);
+    if (landmarks_in_range.size() != n_landmarks + 1)
+        throw std::runtime_error("Deleted landmark still indexed.");
+
+    // tracker searching only around the robot
+    processor_ptr_->setLandmarkSearchRange(3);
+    for (auto i = 20; i < 25; i++)
+        processor_ptr_->process(new CaptureVoid(TimeStamp(0.01 * i), sensor_ptr_));
+    std::cout << "landmark spatial index OK" << std::endl;
+
     delete wolf_problem_ptr_;
 
     return 0;
@@ -0,0 +1,153 @@
+/**
+ * \file test_processor_tracker_scan_matching_2D.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_tracker_scan_matching_2D.h"
+
+// Wolf includes
+#include "problem.h"
+#include "processor_factory.h"
+#include "state_block.h"
+
+// General includes
+#include <iostream>
+#include <list>
+
+using namespace wolf;
+
+/** Simulate the ranges of a 360 degrees scan of a rectangular room with a pillar, by ray casting
+ * \param _pose pose of the sensor in the room
+ * \param _n_beams number of beams, from -pi
+ */
+std::vector<float> simulateRanges(const Eigen::Vector3s& _pose, unsigned int _n_beams)
+{
+    // walls of the room [-4,6] x [-3,5], and a pillar [1,2] x [1,1.5]
+    const Scalar xmin = -4, xmax = 6, ymin = -3, ymax = 5;
+    const Scalar pxmin = 1, pxmax = 2, pymin = 1, pymax = 1.5;
+
+    std::vector<float> ranges(_n_beams);
+    for (unsigned int i = 0; i < _n_beams; i++)
+    {
+        Scalar bearing = -M_PI + 2 * M_PI * i / _n_beams;
+        Eigen::Vector2s u(cos(_pose(2) + bearing), sin(_pose(2) + bearing));
+
+        // distance to the room walls
+        Scalar range = 1e3;
+        if (u(0) > 0) range = std::min(range, (xmax - _pose(0)) / u(0));
+        if (u(0) < 0) range = std::min(range, (xmin - _pose(0)) / u(0));
+        if (u(1) > 0) range = std::min(range, (ymax - _pose(1)) / u(1));
+        if (u(1) < 0) range = std::min(range, (ymin - _pose(1)) / u(1));
+
+        // distance to the pillar (slab method)
+        Scalar t0 = -1e3, t1 = 1e3;
+        for (int k = 0; k < 2; k++)
+        {
+            Scalar lo = (k == 0 ? pxmin : pymin), hi = (k == 0 ? pxmax : pymax);
+            if (std::abs(u(k)) < 1e-12)
+            {
+                if (_pose(k) < lo || _pose(k) > hi)
+                    t0 = 1e3;
+                continue;
+            }
+            Scalar ta = (lo - _pose(k)) / u(k), tb = (hi - _pose(k)) / u(k);
+            t0 = std::max(t0, std::min(ta, tb));
+            t1 = std::min(t1, std::max(ta, tb));
+        }
+        if (t0 <= t1 && t0 > 0)
+            range = std::min(range, t0);
+
+        ranges[i] = range;
+    }
+    return ranges;
+}
+
+int main()
+{
+    std::cout << std::endl << "==================== processor tracker scan matching 2D test ======================" << std::endl;
+
+    const unsigned int n_beams = 720;
+
+    // Wolf problem with a laser, and no motion processor
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    laserscanutils::LaserScanParams scan_params({-M_PI, M_PI, 2 * M_PI / n_beams, 0.1, 0.1, 30, 0.01, 0.001});
+    SensorLaser2D* sensor_ptr = new SensorLaser2D(new StateBlock(Eigen::VectorXs::Zero(2)),
+                                                  new StateBlock(Eigen::VectorXs::Zero(1)), scan_params);
+    problem_ptr->addSensor(sensor_ptr);
+
+    ProcessorParamsScanMatching2D params;
+    params.matcher.resolution = 0.05;
+    params.matcher.hit_std_dev = 0.05;
+    params.matcher.linear_window = 0.5;
+    params.matcher.angular_window = 0.2;
+    params.matcher.n_levels = 4;
+    params.matcher.min_score = 0.3;
+    params.n_keyframes = 3;
+    params.keyframe_distance = 0.3;
+    params.keyframe_angle = 0.2;
+    params.position_std_dev = 0.02;
+    params.angle_std_dev = 0.01;
+
+    // Creation from the factory, with checked params
+    bool bad_params_rejected = false;
+    ProcessorParamsBase bad_params;
+    try
+    {
+        ProcessorFactory::get().create("SCAN MATCHING 2D", "bad scan matcher", &bad_params);
+    }
+    catch (std::runtime_error& e)
+    {
+        bad_params_rejected = true;
+    }
+    ProcessorTrackerScanMatching2D* processor_ptr = (ProcessorTrackerScanMatching2D*)problem_ptr->installProcessor(
+            "SCAN MATCHING 2D", "scan matcher", sensor_ptr, &params);
+    if (!bad_params_rejected || processor_ptr == nullptr || processor_ptr->getName() != "scan matcher")
+        throw std::runtime_error("Scan matching processor not created by the factory.");
+    std::cout << "TEST FACTORY ------> OK!" << std::endl;
+
+    // The robot moves along x. Without motion processor, each scan is matched from the last KeyFrame pose.
+    Eigen::Vector3s pose(0, 0, 0);
+    for (unsigned int i = 0; i < 20; i++)
+    {
+        pose(0) = 0.1 * i;
+        pose(2) = 0.01 * i;
+        processor_ptr->process(new CaptureLaser2D(TimeStamp(0.1 * i), sensor_ptr, simulateRanges(pose, n_beams)));
+        if (i > 0 && processor_ptr->getLastScore() < params.matcher.min_score)
+            throw std::runtime_error("Scan " + std::to_string(i) + " not matched.");
+    }
+    FrameBase* keyframe_ptr = problem_ptr->getLastKeyFramePtr();
+    Eigen::Vector3s keyframe_state = keyframe_ptr->getState();
+    Scalar t = keyframe_ptr->getTimeStamp().get();
+    Eigen::Vector3s keyframe_pose(t, 0, 0.1 * t); // true pose at time t
+    if (processor_ptr->getNumKeyScans() != params.n_keyframes
+            || (keyframe_state.head<2>() - keyframe_pose.head<2>()).norm() > 2 * params.matcher.resolution
+            || std::abs(pi2pi(keyframe_state(2) - keyframe_pose(2))) > 0.02)
+        throw std::runtime_error("Bad KeyFrame pose from scan matching.");
+    std::cout << "TEST TRACKING WITHOUT MOTION PROCESSOR ------> OK!" << std::endl;
+
+    // Removed KeyFrames leave the local map, and tracking goes on with the remaining ones
+    std::list<FrameBase*> old_keyframes;
+    for (auto frame_ptr : *(problem_ptr->getTrajectoryPtr()->getFrameListPtr()))
+        if (frame_ptr->isKey() && frame_ptr != keyframe_ptr)
+            old_keyframes.push_back(frame_ptr);
+    for (auto frame_ptr : old_keyframes)
+        frame_ptr->destruct();
+    if (processor_ptr->getNumKeyScans() != 1)
+        throw std::runtime_error("Scans of removed KeyFrames still in the local map.");
+    for (unsigned int i = 20; i < 25; i++)
+    {
+        pose(0) = 0.1 * i;
+        pose(2) = 0.01 * i;
+        processor_ptr->process(new CaptureLaser2D(TimeStamp(0.1 * i), sensor_ptr, simulateRanges(pose, n_beams)));
+        if (processor_ptr->getLastScore() < params.matcher.min_score)
+            throw std::runtime_error("Scan " + std::to_string(i) + " not matched after removing KeyFrames.");
+    }
+    std::cout << "TEST KEYFRAME REMOVAL ------> OK!" << std::endl;
+
+    delete problem_ptr;
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * \file test_scan_matcher_2D.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "correlative_scan_matcher_2D.h"
+
+// Wolf includes
+#include "time_stamp.h"
+#include "wolf.h"
+
+// General includes
+#include <iostream>
+#include <iomanip>      // std::setprecision
+
+using namespace wolf;
+
+/** Simulate a 2D scan of a rectangular room with a pillar, by ray casting
+ * \param _pose pose of the sensor in the room
+ * \param _n_beams number of beams over 360 degrees
+ * \return 2xN points in the sensor frame
+ */
+Eigen::Matrix<Scalar, 2, Eigen::Dynamic> simulateScan(const Eigen::Vector3s& _pose, unsigned int _n_beams)
+{
+    // walls of the room [-4,6] x [-3,5], and a pillar [1,2] x [1,1.5]
+    const Scalar xmin = -4, xmax = 6, ymin = -3, ymax = 5;
+    const Scalar pxmin = 1, pxmax = 2, pymin = 1, pymax = 1.5;
+
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> points(2, _n_beams);
+    for (unsigned int i = 0; i < _n_beams; i++)
+    {
+        Scalar bearing = -M_PI + 2 * M_PI * i / _n_beams;
+        Eigen::Vector2s u(cos(_pose(2) + bearing), sin(_pose(2) + bearing));
+
+        // distance to the room walls
+        Scalar range = 1e3;
+        if (u(0) > 0) range = std::min(range, (xmax - _pose(0)) / u(0));
+        if (u(0) < 0) range = std::min(range, (xmin - _pose(0)) / u(0));
+        if (u(1) > 0) range = std::min(range, (ymax - _pose(1)) / u(1));
+        if (u(1) < 0) range = std::min(range, (ymin - _pose(1)) / u(1));
+
+        // distance to the pillar (slab method)
+        Scalar t0 = -1e3, t1 = 1e3;
+        for (int k = 0; k < 2; k++)
+        {
+            Scalar lo = (k == 0 ? pxmin : pymin), hi = (k == 0 ? pxmax : pymax);
+            if (std::abs(u(k)) < 1e-12)
+            {
+                if (_pose(k) < lo || _pose(k) > hi)
+                    t0 = 1e3;
+                continue;
+            }
+            Scalar ta = (lo - _pose(k)) / u(k), tb = (hi - _pose(k)) / u(k);
+            t0 = std::max(t0, std::min(ta, tb));
+            t1 = std::min(t1, std::max(ta, tb));
+        }
+        if (t0 <= t1 && t0 > 0)
+            range = std::min(range, t0);
+
+        points.col(i) << range * cos(bearing), range * sin(bearing);
+    }
+    return points;
+}
+
+int main()
+{
+    std::cout << std::setprecision(4);
+
+    std::cout << "\n====== Test CorrelativeScanMatcher2D ======" << std::endl;
+
+    ScanMatcherParams2D params;
+    params.resolution = 0.05;
+    params.hit_std_dev = 0.05;
+    params.linear_window = 0.5;
+    params.angular_window = 0.2;
+    params.n_levels = 4;
+    params.min_score = 0.3;
+
+    CorrelativeScanMatcher2D matcher(params);
+
+    // Map: one scan taken at the origin of the map frame
+    Eigen::Vector3s map_pose(0, 0, 0);
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> map_points = simulateScan(map_pose, 720);
+    matcher.getGrid().reset(map_points.rowwise().minCoeff(), map_points.rowwise().maxCoeff(), params.n_levels);
+    matcher.getGrid().insertPoints(map_points);
+    matcher.getGrid().computeLevels();
+
+    // Scan taken from a displaced pose
+    Eigen::Vector3s true_pose(0.3, -0.2, 0.1);
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> scan_points = simulateScan(true_pose, 720);
+
+    // Guess from odometry, with some error
+    Eigen::Vector3s pose_guess(0.1, 0.05, 0.0);
+    Eigen::Vector3s pose;
+    Scalar score;
+
+    TimeStamp t0, t1;
+    t0.setToNow();
+    bool matched = matcher.match(scan_points, pose_guess, pose, score);
+    t1.setToNow();
+
+    std::cout << "true pose   : " << true_pose.transpose() << std::endl;
+    std::cout << "pose guess  : " << pose_guess.transpose() << std::endl;
+    std::cout << "found pose  : " << pose.transpose() << " score: " << score << std::endl;
+    std::cout << "match time  : " << 1e3 * (t1 - t0) << " ms" << std::endl;
+
+    if (!matched)
+    {
+        std::cout << "TEST SCAN MATCHING FOUND ------> ERROR! no match" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST SCAN MATCHING FOUND ------> OK!" << std::endl;
+
+    Eigen::Vector3s error = pose - true_pose;
+    error(2) = pi2pi(error(2));
+    if (error.head<2>().norm() > 2 * params.resolution || std::abs(error(2)) > 0.02)
+    {
+        std::cout << "TEST SCAN MATCHING POSE ------> ERROR! error: " << error.transpose() << std::endl;
+        return -1;
+    }
+    std::cout << "TEST SCAN MATCHING POSE ------> OK!" << std::endl;
+
+    // Branch and bound must find the same score as the exhaustive search
+    ScanMatcherParams2D params_brute = params;
+    params_brute.n_levels = 0;
+    CorrelativeScanMatcher2D matcher_brute(params_brute);
+    matcher_brute.getGrid().reset(map_points.rowwise().minCoeff(), map_points.rowwise().maxCoeff(), params_brute.n_levels);
+    matcher_brute.getGrid().insertPoints(map_points);
+    matcher_brute.getGrid().computeLevels();
+    Eigen::Vector3s pose_brute;
+    Scalar score_brute;
+    t0.setToNow();
+    matcher_brute.match(scan_points, pose_guess, pose_brute, score_brute);
+    t1.setToNow();
+    std::cout << "brute pose  : " << pose_brute.transpose() << " score: " << score_brute << std::endl;
+    std::cout << "brute time  : " << 1e3 * (t1 - t0) << " ms" << std::endl;
+
+    if (std::abs(score_brute - score) > 1e-5)
+    {
+        std::cout << "TEST SCAN MATCHING BRANCH AND BOUND ------> ERROR! scores differ" << std::endl;
+        return -1;
+    }
+    std::cout << "TEST SCAN MATCHING BRANCH AND BOUND ------> OK!" << std::endl;
+
+    // A scan far out of the search window must be rejected
+    Eigen::Vector3s pose_far;
+    Scalar score_far;
+    if (matcher.match(scan_points, Eigen::Vector3s(3, 3, 1.5), pose_far, score_far))
+    {
+        std::cout << "TEST SCAN MATCHING REJECTION ------> ERROR! score: " << score_far << std::endl;
+        return -1;
+    }
+    std::cout << "TEST SCAN MATCHING REJECTION ------> OK!" << std::endl;
+
+    return 0;
+}
@@ -23,7 +23,7 @@ class FeaturePointImage : public FeatureBase
     protected:
 
         cv::KeyPoint keypoint_;
-        cv::Mat descriptor_;
+        cv::Mat descriptor_; ///< a row of the descriptors of its CaptureImage, not a copy
         bool is_known_;
 
     public:
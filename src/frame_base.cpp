@@ -40,6 +40,10 @@ FrameBase::~FrameBase()
 	//std::cout << "deleting FrameBase " << id() << std::endl;
     is_deleting_ = true;
 
+    // Let the processors forget this key frame
+    if (getProblem() != nullptr && type_id_ == KEY_FRAME)
+        getProblem()->keyFrameRemovedCallback(this);
+
 	// Remove Frame State Blocks
 	if (p_ptr_ != nullptr)
 	{
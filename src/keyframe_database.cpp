@@ -0,0 +1,127 @@
+/**
+ * \file keyframe_database.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "keyframe_database.h"
+
+// std includes
+#include <algorithm>
+
+namespace wolf
+{
+
+KeyFrameDatabase::KeyFrameDatabase()
+{
+}
+
+KeyFrameDatabase::~KeyFrameDatabase()
+{
+}
+
+void KeyFrameDatabase::addKeyFrame(FrameBase* _frame_ptr, const BowVector& _bow)
+{
+    assert(keyframes_.find(_frame_ptr) == keyframes_.end() && "KeyFrameDatabase::addKeyFrame: KeyFrame already in the database");
+
+    unsigned int slot;
+    if (free_slots_.empty())
+    {
+        slot = slot_frames_.size();
+        slot_frames_.push_back(_frame_ptr);
+        scores_.push_back(0);
+    }
+    else
+    {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        slot_frames_[slot] = _frame_ptr;
+    }
+    keyframes_[_frame_ptr] = std::make_pair(slot, _bow);
+
+    if (!_bow.empty() && _bow.back().first >= inverted_file_.size())
+        inverted_file_.resize(_bow.back().first + 1);
+    for (auto& word_weight : _bow)
+        inverted_file_[word_weight.first].push_back(Entry({slot, word_weight.second}));
+}
+
+void KeyFrameDatabase::removeKeyFrame(FrameBase* _frame_ptr)
+{
+    auto keyframe_it = keyframes_.find(_frame_ptr);
+    if (keyframe_it == keyframes_.end())
+        return;
+
+    unsigned int slot = keyframe_it->second.first;
+    for (auto& word_weight : keyframe_it->second.second)
+    {
+        std::vector<Entry>& entries = inverted_file_[word_weight.first];
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [slot](const Entry& _e) { return _e.slot == slot; }),
+                      entries.end());
+    }
+    slot_frames_[slot] = nullptr;
+    free_slots_.push_back(slot);
+    keyframes_.erase(keyframe_it);
+}
+
+unsigned int KeyFrameDatabase::query(const BowVector& _bow, unsigned int _max_results, Scalar _min_score,
+                                     std::vector<KeyFrameCandidate>& _results) const
+{
+    _results.clear();
+
+    // accumulate the scores of the KeyFrames sharing words with the query
+    touched_slots_.clear();
+    for (auto& word_weight : _bow)
+    {
+        if (word_weight.first >= inverted_file_.size())
+            continue;
+        for (auto& entry : inverted_file_[word_weight.first])
+        {
+            if (scores_[entry.slot] == 0)
+                touched_slots_.push_back(entry.slot);
+            scores_[entry.slot] += std::min(word_weight.second, entry.weight);
+        }
+    }
+
+    for (auto slot : touched_slots_)
+    {
+        if (scores_[slot] >= _min_score)
+            _results.push_back(KeyFrameCandidate({slot_frames_[slot], scores_[slot]}));
+        scores_[slot] = 0;
+    }
+
+    // best first
+    auto better = [](const KeyFrameCandidate& _a, const KeyFrameCandidate& _b) { return _a.score > _b.score; };
+    if (_results.size() > _max_results)
+    {
+        std::partial_sort(_results.begin(), _results.begin() + _max_results, _results.end(), better);
+        _results.resize(_max_results);
+    }
+    else
+        std::sort(_results.begin(), _results.end(), better);
+
+    return _results.size();
+}
+
+Scalar KeyFrameDatabase::score(const BowVector& _bow_1, const BowVector& _bow_2)
+{
+    Scalar s = 0;
+    auto it_1 = _bow_1.begin();
+    auto it_2 = _bow_2.begin();
+    while (it_1 != _bow_1.end() && it_2 != _bow_2.end())
+    {
+        if (it_1->first < it_2->first)
+            it_1++;
+        else if (it_2->first < it_1->first)
+            it_2++;
+        else
+        {
+            s += std::min(it_1->second, it_2->second);
+            it_1++;
+            it_2++;
+        }
+    }
+    return s;
+}
+
+} // namespace wolf
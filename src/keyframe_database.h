@@ -0,0 +1,103 @@
+/**
+ * \file keyframe_database.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef KEYFRAME_DATABASE_H_
+#define KEYFRAME_DATABASE_H_
+
+// Wolf includes
+#include "wolf.h"
+#include "vocabulary_tree.h"
+
+// std includes
+#include <map>
+
+namespace wolf
+{
+
+/** \brief A KeyFrame retrieved by KeyFrameDatabase::query(), with its similarity score in [0,1]
+ */
+struct KeyFrameCandidate
+{
+        FrameBase* frame_ptr;
+        Scalar score;
+};
+
+/** \brief Place recognition database of KeyFrames, indexed by their bag-of-words vectors
+ *
+ * The bag-of-words vectors are computed with a VocabularyTree.
+ * The database keeps an inverted file: for each word, the KeyFrames where it appears, with its weight.
+ * A query only visits the KeyFrames that share words with the queried image,
+ * so that it scales with thousands of KeyFrames.
+ *
+ * The similarity of two L1-normalized bag-of-words vectors v and w is
+ *
+ *   s(v,w) = 1 - 0.5 * |v - w|_1 = sum_i min(v_i, w_i),
+ *
+ * which is 1 for equal vectors, and 0 for vectors without common words.
+ *
+ * KeyFrames are inserted one by one, as they are created, with addKeyFrame().
+ * The database does not own the Frames: remove them with removeKeyFrame() before destroying them.
+ */
+class KeyFrameDatabase
+{
+    protected:
+        /** \brief Entry of the inverted file: a KeyFrame and the weight of the word in it
+         */
+        struct Entry
+        {
+                unsigned int slot; ///< slot of the KeyFrame
+                Scalar weight;
+        };
+
+        std::vector<std::vector<Entry> > inverted_file_;///< entries of each word
+        std::vector<FrameBase*> slot_frames_;           ///< KeyFrame of each slot. nullptr: free slot
+        std::vector<unsigned int> free_slots_;
+        std::map<FrameBase*, std::pair<unsigned int, BowVector> > keyframes_; ///< slot and bag-of-words of each KeyFrame
+
+        // Workspace of the queries
+        mutable std::vector<Scalar> scores_;            ///< score of each slot
+        mutable std::vector<unsigned int> touched_slots_;
+
+    public:
+        KeyFrameDatabase();
+        virtual ~KeyFrameDatabase();
+
+        /** \brief Insert a KeyFrame with its bag-of-words vector
+         */
+        void addKeyFrame(FrameBase* _frame_ptr, const BowVector& _bow);
+
+        /** \brief Remove a KeyFrame
+         */
+        void removeKeyFrame(FrameBase* _frame_ptr);
+
+        /** \brief Number of KeyFrames in the database
+         */
+        unsigned int size() const;
+
+        /** \brief Retrieve the KeyFrames most similar to an image
+         * \param _bow the bag-of-words vector of the image
+         * \param _max_results the max number of KeyFrames returned
+         * \param _min_score the minimum score of the KeyFrames returned
+         * \param _results the returned KeyFrames, best first
+         * \return the number of KeyFrames returned
+         */
+        unsigned int query(const BowVector& _bow, unsigned int _max_results, Scalar _min_score,
+                           std::vector<KeyFrameCandidate>& _results) const;
+
+        /** \brief Similarity score of two bag-of-words vectors
+         */
+        static Scalar score(const BowVector& _bow_1, const BowVector& _bow_2);
+};
+
+inline unsigned int KeyFrameDatabase::size() const
+{
+    return keyframes_.size();
+}
+
+} // namespace wolf
+
+#endif /* KEYFRAME_DATABASE_H_ */
@@ -0,0 +1,97 @@
+/**
+ * \file keypoint_buckets.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "keypoint_buckets.h"
+#include "descriptorTools.h"
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace wolf {
+
+KeypointBuckets::KeypointBuckets() :
+        roi_width_(1), roi_height_(1), n_buckets_h_(1), n_buckets_v_(1), keypoints_ptr_(nullptr), bucket_start_(2, 0)
+{
+}
+
+void KeypointBuckets::setParameters(unsigned int _image_width, unsigned int _image_height,
+                                    unsigned int _roi_width, unsigned int _roi_height)
+{
+    roi_width_ = _roi_width;
+    roi_height_ = _roi_height;
+    n_buckets_h_ = (_image_width + _roi_width - 1) / _roi_width;
+    n_buckets_v_ = (_image_height + _roi_height - 1) / _roi_height;
+    bucket_start_.assign(n_buckets_h_ * n_buckets_v_ + 1, 0);
+    bucket_keypoints_.clear();
+    keypoints_ptr_ = nullptr;
+}
+
+void KeypointBuckets::bucket(const std::vector<cv::KeyPoint>& _keypoints, const cv::Mat& _descriptors)
+{
+    keypoints_ptr_ = &_keypoints;
+
+    // counting sort of the keypoints by bucket
+    std::fill(bucket_start_.begin(), bucket_start_.end(), 0);
+    keypoint_bucket_.resize(_keypoints.size());
+    for (unsigned int i = 0; i < _keypoints.size(); i++)
+    {
+        unsigned int bh = std::min((unsigned int)(_keypoints[i].pt.x / roi_width_), n_buckets_h_ - 1);
+        unsigned int bv = std::min((unsigned int)(_keypoints[i].pt.y / roi_height_), n_buckets_v_ - 1);
+        keypoint_bucket_[i] = bh + n_buckets_h_ * bv;
+        bucket_start_[keypoint_bucket_[i] + 1]++;
+    }
+    for (unsigned int b = 1; b < bucket_start_.size(); b++)
+        bucket_start_[b] += bucket_start_[b - 1];
+    bucket_keypoints_.resize(_keypoints.size());
+    bucket_end_.assign(bucket_start_.begin(), bucket_start_.end() - 1);
+    for (unsigned int i = 0; i < _keypoints.size(); i++)
+        bucket_keypoints_[bucket_end_[keypoint_bucket_[i]]++] = i;
+
+    // descriptors in the same order, so that the matching of each bucket streams through them
+    descriptor::sortRows(_descriptors, bucket_keypoints_, bucket_descriptors_);
+}
+
+int KeypointBuckets::findBest(const uchar* _target_descriptor, Scalar _u, Scalar _v, const std::vector<bool>& _excluded,
+                              int _norm, Scalar& _best_distance) const
+{
+    const Scalar half_width = roi_width_ / 2;
+    const Scalar half_height = roi_height_ / 2;
+
+    // buckets overlapping the roi
+    int bh_min = std::max((int)std::floor((_u - half_width) / roi_width_), 0);
+    int bh_max = std::min((int)std::floor((_u + half_width) / roi_width_), (int)n_buckets_h_ - 1);
+    int bv_min = std::max((int)std::floor((_v - half_height) / roi_height_), 0);
+    int bv_max = std::min((int)std::floor((_v + half_height) / roi_height_), (int)n_buckets_v_ - 1);
+
+    // best free candidate in the roi
+    int best_idx = -1;
+    _best_distance = std::numeric_limits<Scalar>::max();
+    for (int bv = bv_min; bv <= bv_max; bv++)
+        for (int bh = bh_min; bh <= bh_max; bh++)
+        {
+            unsigned int b = bh + n_buckets_h_ * bv;
+            for (unsigned int k = bucket_start_[b]; k < bucket_start_[b + 1]; k++)
+            {
+                unsigned int idx = bucket_keypoints_[k];
+                const cv::Point2f& candidate = (*keypoints_ptr_)[idx].pt;
+                if (_excluded[idx] || std::abs(candidate.x - _u) > half_width || std::abs(candidate.y - _v) > half_height)
+                    continue;
+                Scalar distance = descriptor::distance(_target_descriptor, bucket_descriptors_.ptr<uchar>(k),
+                                                       bucket_descriptors_.cols, _norm);
+                if (distance < _best_distance)
+                {
+                    _best_distance = distance;
+                    best_idx = idx;
+                }
+            }
+        }
+    return best_idx;
+}
+
+} // namespace wolf
@@ -0,0 +1,90 @@
+/**
+ * \file keypoint_buckets.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef KEYPOINT_BUCKETS_H_
+#define KEYPOINT_BUCKETS_H_
+
+// Wolf includes
+#include "wolf.h"
+
+// OpenCV includes
+#include <opencv2/core/core.hpp>
+#include <opencv2/features2d/features2d.hpp>
+
+// std includes
+#include <vector>
+
+namespace wolf {
+
+/**
+ * \brief Keypoints of an image, bucketed in cells of the size of a search roi.
+ *
+ * The roi centered at any pixel overlaps at most 2x2 buckets,
+ * so that the candidates of a search are found without visiting all the keypoints.
+ *
+ * The descriptors are copied in bucket order, so that the matching of each bucket
+ * streams through contiguous memory, see descriptor::sortRows().
+ *
+ * Use it like this:
+ *   - Call setParameters() once, with the image size and the roi size.
+ *   - Call bucket() once per image, with its keypoints and descriptors.
+ *   - Call findBest() for each descriptor to search in the image.
+ */
+class KeypointBuckets
+{
+    private:
+        unsigned int roi_width_, roi_height_;
+        unsigned int n_buckets_h_, n_buckets_v_;
+        const std::vector<cv::KeyPoint>* keypoints_ptr_;
+        std::vector<unsigned int> bucket_start_;    ///< position of the first keypoint of each bucket in bucket_keypoints_
+        std::vector<unsigned int> bucket_keypoints_;///< keypoint indices, sorted by bucket
+        cv::Mat bucket_descriptors_;                ///< keypoint descriptors, sorted by bucket
+        std::vector<unsigned int> keypoint_bucket_; ///< workspace: bucket of each keypoint
+        std::vector<unsigned int> bucket_end_;      ///< workspace: end of each bucket during the sort
+
+    public:
+        /**
+         * \brief Void constructor
+         *
+         * Calling this constructor requires the use of setParameters() to configure.
+         */
+        KeypointBuckets();
+
+        /**
+         * \brief Set the size of the image and of the search roi, which is also the size of the buckets
+         * \param _image_width image width, in pixels
+         * \param _image_height image height, in pixels
+         * \param _roi_width search roi width, in pixels
+         * \param _roi_height search roi height, in pixels
+         */
+        void setParameters(unsigned int _image_width, unsigned int _image_height,
+                           unsigned int _roi_width, unsigned int _roi_height);
+
+        /**
+         * \brief Bucket the keypoints of an image, and sort their descriptors by bucket
+         * \param _keypoints the keypoints. They must outlive the calls to findBest().
+         * \param _descriptors their descriptors, one per row
+         */
+        void bucket(const std::vector<cv::KeyPoint>& _keypoints, const cv::Mat& _descriptors);
+
+        /**
+         * \brief Find the keypoint of the roi centered at a pixel whose descriptor is closest to a target descriptor
+         * \param _target_descriptor the descriptor to search
+         * \param _u horizontal coordinate of the roi center
+         * \param _v vertical coordinate of the roi center
+         * \param _excluded keypoints that are not candidates, e.g. those already matched, by keypoint index
+         * \param _norm the norm of the descriptor distance, e.g. cv::NORM_HAMMING
+         * \param _best_distance returns the distance of the best keypoint
+         * \return the index of the best keypoint, or -1 if there is no candidate in the roi
+         */
+        int findBest(const uchar* _target_descriptor, Scalar _u, Scalar _v, const std::vector<bool>& _excluded,
+                     int _norm, Scalar& _best_distance) const;
+};
+
+} // namespace wolf
+
+#endif /* KEYPOINT_BUCKETS_H_ */
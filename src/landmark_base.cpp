@@ -26,6 +26,10 @@ LandmarkBase::~LandmarkBase()
 	//std::cout << "deleting LandmarkBase " << nodeId() << std::endl;
     is_deleting_ = true;
 
+    // Remove from the Map's spatial index, unless the whole Map is being deleted
+    if (upperNodePtr() != nullptr && !upperNodePtr()->isDeleting())
+        upperNodePtr()->unindexLandmark(this);
+
     // Remove Frame State Blocks
     if (p_ptr_ != nullptr)
     {
@@ -0,0 +1,38 @@
+/**
+ * \file landmark_point_3D.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "landmark_point_3D.h"
+#include "state_block.h"
+
+namespace wolf {
+
+LandmarkPoint3D::LandmarkPoint3D(StateBlock* _p_ptr, const cv::Mat& _descriptor) :
+        LandmarkBase(LANDMARK_POINT, _p_ptr), cv_descriptor_(_descriptor.clone())
+{
+    assert((_p_ptr->getSize() == 3 || _p_ptr->getSize() == 4) && "Position must be 3D Euclidean or homogeneous");
+    setType("POINT 3D");
+}
+
+LandmarkPoint3D::~LandmarkPoint3D()
+{
+    //
+}
+
+bool LandmarkPoint3D::isHomogeneous() const
+{
+    return p_ptr_->getSize() == 4;
+}
+
+Eigen::Vector3s LandmarkPoint3D::getPosition() const
+{
+    Eigen::VectorXs p = p_ptr_->getVector();
+    if (isHomogeneous())
+        return p.head<3>() / p(3);
+    return p;
+}
+
+} // namespace wolf
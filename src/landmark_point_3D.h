@@ -0,0 +1,68 @@
+/**
+ * \file landmark_point_3D.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef LANDMARK_POINT_3D_H_
+#define LANDMARK_POINT_3D_H_
+
+//Wolf includes
+#include "landmark_base.h"
+
+//OpenCV includes
+#include <opencv2/core/core.hpp>
+
+namespace wolf {
+
+/** \brief 3D point landmark with an image descriptor
+ *
+ * The position is either Euclidean, a StateBlock of size 3 (EP),
+ * or homogeneous, a StateHomogeneous3D of size 4 (HP).
+ * A homogeneous point can be initialized from a single image, with an uncertain depth,
+ * and can lie at infinity.
+ */
+class LandmarkPoint3D : public LandmarkBase
+{
+    protected:
+        cv::Mat cv_descriptor_; ///< descriptor of the image point at the landmark creation
+
+    public:
+        /** \brief Constructor with the position state pointer and the descriptor
+         * \param _p_ptr StateBlock pointer to the position, of size 3 (Euclidean) or 4 (homogeneous)
+         * \param _descriptor image descriptor of the landmark
+         **/
+        LandmarkPoint3D(StateBlock* _p_ptr, const cv::Mat& _descriptor);
+
+        /** \brief Default destructor (not recommended)
+         *
+         * Default destructor (please use destruct() instead of delete for guaranteeing the wolf tree integrity)
+         **/
+        virtual ~LandmarkPoint3D();
+
+        const cv::Mat& getCvDescriptor() const;
+        void setCvDescriptor(const cv::Mat& _descriptor);
+
+        /** \brief Is the position in homogeneous coordinates
+         **/
+        bool isHomogeneous() const;
+
+        /** \brief Euclidean position. Not defined for points at infinity.
+         **/
+        Eigen::Vector3s getPosition() const;
+};
+
+inline const cv::Mat& LandmarkPoint3D::getCvDescriptor() const
+{
+    return cv_descriptor_;
+}
+
+inline void LandmarkPoint3D::setCvDescriptor(const cv::Mat& _descriptor)
+{
+    cv_descriptor_ = _descriptor;
+}
+
+} // namespace wolf
+
+#endif /* LANDMARK_POINT_3D_H_ */
@@ -0,0 +1,114 @@
+/**
+ * \file laser_scan_pool.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef LASER_SCAN_POOL_H_
+#define LASER_SCAN_POOL_H_
+
+//laserscanutils includes
+#include "laser_scan_utils/laser_scan.h"
+
+// STL
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace wolf {
+
+/** \brief Pool of recycled laser scans.
+ *
+ * Each SensorLaser2D owns one pool, shared with all the CaptureLaser2D it produces.
+ * A Capture acquires a scan from the pool at construction and gives it back at destruction.
+ *
+ * Recycled scans keep the memory of their range and point buffers,
+ * so that once the pool has warmed up, filling a new scan from the driver data
+ * and running the laserscanutils algorithms on it does not allocate.
+ *
+ * The pool is shared through a std::shared_ptr so that it outlives the sensor
+ * if some captures are destroyed after it (e.g. at Problem destruction).
+ *
+ * The pool is thread-safe: captures are typically created by the sensor driver thread,
+ * and destroyed by the thread owning the Problem.
+ */
+class LaserScanPool
+{
+    public:
+        LaserScanPool() { }
+        ~LaserScanPool();
+
+        LaserScanPool(const LaserScanPool&) = delete;
+        LaserScanPool& operator=(const LaserScanPool&) = delete;
+
+        /** \brief Get an empty scan from the pool, or a new one if the pool is empty.
+         *
+         * Recycled scans are cleared, keeping the capacity of their buffers.
+         */
+        laserscanutils::LaserScan* acquire();
+
+        /** \brief Give a scan back to the pool.
+         */
+        void release(laserscanutils::LaserScan* _scan_ptr);
+
+        /** \brief Number of scans waiting to be recycled
+         */
+        unsigned int size() const;
+
+    private:
+        std::vector<laserscanutils::LaserScan*> free_scans_;
+        mutable std::mutex mutex_; ///< protects free_scans_
+
+        static void clear(laserscanutils::LaserScan* _scan_ptr);
+};
+
+typedef std::shared_ptr<LaserScanPool> LaserScanPoolPtr;
+
+inline LaserScanPool::~LaserScanPool()
+{
+    for (auto scan_ptr : free_scans_)
+        delete scan_ptr;
+}
+
+inline laserscanutils::LaserScan* LaserScanPool::acquire()
+{
+    laserscanutils::LaserScan* scan_ptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_scans_.empty())
+            return new laserscanutils::LaserScan();
+
+        scan_ptr = free_scans_.back();
+        free_scans_.pop_back();
+    }
+    clear(scan_ptr);
+    return scan_ptr;
+}
+
+inline void LaserScanPool::release(laserscanutils::LaserScan* _scan_ptr)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_scans_.push_back(_scan_ptr);
+}
+
+inline unsigned int LaserScanPool::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_scans_.size();
+}
+
+inline void LaserScanPool::clear(laserscanutils::LaserScan* _scan_ptr)
+{
+    // std::vector::clear() keeps the capacity
+    _scan_ptr->ranges_raw_.clear();
+    _scan_ptr->ranges_.clear();
+    _scan_ptr->jumps_indexes_.clear();
+    _scan_ptr->jumps_mask_.clear();
+    // Eigen matrices cannot keep a capacity: ranges2xy() sizes the points again
+    _scan_ptr->points_.resize(Eigen::NoChange, 0);
+}
+
+} // namespace wolf
+
+#endif /* LASER_SCAN_POOL_H_ */
@@ -55,10 +55,10 @@ bool LocalParametrizationHomogeneous::computeJacobian(const Eigen::Map<const Eig
     assert(_h.size() == global_size_ && "Wrong size of input quaternion.");
     assert(_jacobian.rows() == global_size_ && _jacobian.cols() == local_size_ && "Wrong size of Jacobian matrix.");
 
-    _jacobian << -_h(0), -_h(1), -_h(2),
-                  _h(3),  _h(2), -_h(1),
+    _jacobian <<  _h(3),  _h(2), -_h(1),
                  -_h(2),  _h(3),  _h(0),
-                  _h(1), -_h(0),  _h(3);
+                  _h(1), -_h(0),  _h(3),
+                 -_h(0), -_h(1), -_h(2);
     _jacobian /= 2;
     return true;
 }
@@ -59,18 +59,18 @@ bool LocalParametrizationQuaternion::computeJacobian(const Eigen::Map<const Eige
     using namespace Eigen;
     if (delta_reference_ == DQ_GLOBAL) // See comments in method plus()
     {
-        _jacobian << -_q(0), -_q(1), -_q(2),
-                      _q(3),  _q(2), -_q(1),
+        _jacobian <<  _q(3),  _q(2), -_q(1),
                      -_q(2),  _q(3),  _q(0),
-                      _q(1), -_q(0),  _q(3);
+                      _q(1), -_q(0),  _q(3),
+                     -_q(0), -_q(1), -_q(2);
         _jacobian /= 2;
     }
     else
     {
-        _jacobian << -_q(0), -_q(1), -_q(2),
-                      _q(3), -_q(2),  _q(1),
+        _jacobian <<  _q(3), -_q(2),  _q(1),
                       _q(2),  _q(3), -_q(0),
-                     -_q(1),  _q(0),  _q(3);
+                     -_q(1),  _q(0),  _q(3),
+                     -_q(0), -_q(1), -_q(2);
         _jacobian /= 2;
     }
     return true;
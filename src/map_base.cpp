@@ -1,12 +1,18 @@
 #include "map_base.h"
 //#include "problem.h"
 #include "landmark_base.h"
+#include "state_block.h"
+
+//std includes
+#include <cmath>
+#include <algorithm>
 
 
 namespace wolf {
 
 MapBase::MapBase() :
-    NodeLinked(MID, "MAP")
+    NodeLinked(MID, "MAP"),
+    cell_size_(0)
 {
     //std::cout << "MapBase::MapBase(): " << __LINE__ << std::endl;
 }
@@ -20,6 +26,7 @@ LandmarkBase* MapBase::addLandmark(LandmarkBase* _landmark_ptr)
 {
     addDownNode(_landmark_ptr);
     _landmark_ptr->registerNewStateBlocks();
+    indexLandmark(_landmark_ptr);
     return _landmark_ptr;
 }
 
@@ -27,7 +34,10 @@ void MapBase::addLandmarkList(LandmarkBaseList _landmark_list)
 {
     addDownNodeList(_landmark_list);
     for (auto landmark_ptr : _landmark_list)
+    {
         landmark_ptr->registerNewStateBlocks();
+        indexLandmark(landmark_ptr);
+    }
 }
 
 void MapBase::removeLandmark(LandmarkBase* _landmark_ptr)
@@ -40,4 +50,156 @@ void MapBase::removeLandmark(const LandmarkBaseIter& _landmark_iter)
     removeDownNode(_landmark_iter);
 }
 
+void MapBase::setLandmarkIndexCellSize(const Scalar& _cell_size)
+{
+    cell_size_ = _cell_size;
+
+    // rebuild the index
+    cells_.clear();
+    landmark_cells_.clear();
+    not_indexed_.clear();
+    for (auto landmark_ptr : *getLandmarkListPtr())
+        indexLandmark(landmark_ptr);
+}
+
+void MapBase::updateLandmarkIndex()
+{
+    if (cell_size_ <= 0)
+        return;
+
+    CellKey key;
+    for (auto landmark_cell_it = landmark_cells_.begin(); landmark_cell_it != landmark_cells_.end();)
+    {
+        if (!computeCell(landmark_cell_it->first, key))
+        {
+            // e.g. a homogeneous point gone to infinity
+            eraseFromCell(landmark_cell_it->first, landmark_cell_it->second);
+            not_indexed_.push_back(landmark_cell_it->first);
+            landmark_cell_it = landmark_cells_.erase(landmark_cell_it);
+            continue;
+        }
+        if (key != landmark_cell_it->second)
+        {
+            eraseFromCell(landmark_cell_it->first, landmark_cell_it->second);
+            cells_[key].push_back(landmark_cell_it->first);
+            landmark_cell_it->second = key;
+        }
+        landmark_cell_it++;
+    }
+
+    // homogeneous points back from infinity
+    for (auto landmark_it = not_indexed_.begin(); landmark_it != not_indexed_.end();)
+    {
+        if (computeCell(*landmark_it, key))
+        {
+            cells_[key].push_back(*landmark_it);
+            landmark_cells_[*landmark_it] = key;
+            landmark_it = not_indexed_.erase(landmark_it);
+        }
+        else
+            landmark_it++;
+    }
+}
+
+void MapBase::getLandmarksInRange(const Eigen::VectorXs& _position, const Scalar& _range, LandmarkBaseList& _landmarks)
+{
+    if (cell_size_ <= 0)
+    {
+        _landmarks.insert(_landmarks.end(), getLandmarkListPtr()->begin(), getLandmarkListPtr()->end());
+        return;
+    }
+
+    // visit the cells overlapping the square around the query position
+    long int i_min = std::floor((_position(0) - _range) / cell_size_);
+    long int i_max = std::floor((_position(0) + _range) / cell_size_);
+    long int j_min = std::floor((_position(1) - _range) / cell_size_);
+    long int j_max = std::floor((_position(1) + _range) / cell_size_);
+    Scalar range2 = _range * _range;
+    Eigen::Vector2s p;
+    for (long int i = i_min; i <= i_max; i++)
+        for (long int j = j_min; j <= j_max; j++)
+        {
+            auto cell_it = cells_.find(cellKey(i, j));
+            if (cell_it == cells_.end())
+                continue;
+            for (auto landmark_ptr : cell_it->second)
+            {
+                // indexed Landmarks have a position, unless moved since the last updateLandmarkIndex()
+                if (getPlanePosition(landmark_ptr, p) && (p - _position.head<2>()).squaredNorm() < range2)
+                    _landmarks.push_back(landmark_ptr);
+            }
+        }
+
+    _landmarks.insert(_landmarks.end(), not_indexed_.begin(), not_indexed_.end());
+}
+
+void MapBase::unindexLandmark(LandmarkBase* _landmark_ptr)
+{
+    auto landmark_cell_it = landmark_cells_.find(_landmark_ptr);
+    if (landmark_cell_it != landmark_cells_.end())
+    {
+        eraseFromCell(_landmark_ptr, landmark_cell_it->second);
+        landmark_cells_.erase(landmark_cell_it);
+    }
+    else
+        not_indexed_.remove(_landmark_ptr);
+}
+
+void MapBase::indexLandmark(LandmarkBase* _landmark_ptr)
+{
+    if (cell_size_ <= 0)
+        return;
+
+    CellKey key;
+    if (computeCell(_landmark_ptr, key))
+    {
+        cells_[key].push_back(_landmark_ptr);
+        landmark_cells_[_landmark_ptr] = key;
+    }
+    else
+        not_indexed_.push_back(_landmark_ptr);
+}
+
+bool MapBase::computeCell(LandmarkBase* _landmark_ptr, CellKey& _key) const
+{
+    Eigen::Vector2s p;
+    if (!getPlanePosition(_landmark_ptr, p))
+        return false;
+
+    _key = cellKey(std::floor(p(0) / cell_size_), std::floor(p(1) / cell_size_));
+    return true;
+}
+
+bool MapBase::getPlanePosition(LandmarkBase* _landmark_ptr, Eigen::Vector2s& _position) const
+{
+    // lines have homogeneous line parameters, not a position
+    if (_landmark_ptr->getPPtr() == nullptr || _landmark_ptr->getPPtr()->getSize() < 2
+            || _landmark_ptr->getType() == LANDMARK_LINE_2D)
+        return false;
+
+    const Scalar* p = _landmark_ptr->getPPtr()->getPtr();
+    if (_landmark_ptr->getPPtr()->getSize() == 4)
+    {
+        // homogeneous point: far beyond any cell if w is too small
+        if (std::abs(p[3]) * 1e6 <= std::abs(p[0]) + std::abs(p[1]) + std::abs(p[2]))
+            return false;
+        _position << p[0] / p[3], p[1] / p[3];
+        return true;
+    }
+    _position << p[0], p[1];
+    return true;
+}
+
+void MapBase::eraseFromCell(LandmarkBase* _landmark_ptr, const CellKey& _key)
+{
+    std::vector<LandmarkBase*>& cell = cells_[_key];
+    auto it = std::find(cell.begin(), cell.end(), _landmark_ptr);
+    if (it != cell.end())
+    {
+        // swap with last, no need to keep the order
+        *it = cell.back();
+        cell.pop_back();
+    }
+}
+
 } // namespace wolf
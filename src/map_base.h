@@ -13,10 +13,26 @@ class LandmarkBase;
 #include "node_linked.h"
 
 //std includes
+#include <unordered_map>
+#include <vector>
 
 namespace wolf {
 
-//class MapBase
+/** \brief Map of Landmarks
+ *
+ * ### Spatial index:
+ * The Map can keep a grid index of the Landmark positions on the x-y plane, see setLandmarkIndexCellSize().
+ * Then, getLandmarksInRange() visits only the grid cells around the queried position,
+ * and data association costs stop growing with the total size of the Map.
+ *
+ * The index is kept up to date when Landmarks are added or deleted.
+ * Landmarks moved by the solver are re-indexed by updateLandmarkIndex(), which the solver manager calls after each solve.
+ * Only the Landmarks that changed of cell are moved in the grid.
+ *
+ * Homogeneous positions (x,y,z,w), of size 4, are indexed at their Euclidean position (x/w,y/w).
+ * Landmarks without position state block, lines, and homogeneous points at infinity are not indexed,
+ * and are returned by all queries.
+ */
 class MapBase : public NodeLinked<Problem,LandmarkBase>
 {
     public:
@@ -44,7 +60,46 @@ class MapBase : public NodeLinked<Problem,LandmarkBase>
         void removeLandmark(LandmarkBase* _landmark_ptr);
 
         LandmarkBaseList* getLandmarkListPtr();
-        
+
+        /** \brief Enable the spatial index of Landmarks
+         * \param _cell_size size of the grid cells. 0 disables the index.
+         *
+         * Choose a cell size in the order of the query ranges.
+         */
+        void setLandmarkIndexCellSize(const Scalar& _cell_size);
+
+        /** \brief Re-index the Landmarks that have moved. Call this after solving.
+         *
+         * Landmarks reaching or leaving the infinity are also moved to or from the non-indexed ones.
+         */
+        void updateLandmarkIndex();
+
+        /** \brief Get the Landmarks within a range
+         * \param _position query position. Only the x and y coordinates are used.
+         * \param _range query range
+         * \param _landmarks returned list of Landmarks at a distance smaller than _range on the x-y plane, plus the non-indexed ones.
+         *
+         * Without index, all Landmarks are returned.
+         */
+        void getLandmarksInRange(const Eigen::VectorXs& _position, const Scalar& _range, LandmarkBaseList& _landmarks);
+
+        /** \brief Remove a Landmark from the index. Called by the Landmark's destructor.
+         */
+        void unindexLandmark(LandmarkBase* _landmark_ptr);
+
+    private:
+        typedef unsigned long long int CellKey;
+
+        Scalar cell_size_;                                                   ///< size of the index cells. 0: no index
+        std::unordered_map<CellKey, std::vector<LandmarkBase*>> cells_;      ///< Landmarks in each cell
+        std::unordered_map<LandmarkBase*, CellKey> landmark_cells_;         ///< cell of each indexed Landmark
+        LandmarkBaseList not_indexed_;                                       ///< Landmarks without position
+
+        void indexLandmark(LandmarkBase* _landmark_ptr);
+        bool computeCell(LandmarkBase* _landmark_ptr, CellKey& _key) const;
+        bool getPlanePosition(LandmarkBase* _landmark_ptr, Eigen::Vector2s& _position) const;
+        CellKey cellKey(const long int& _i, const long int& _j) const;
+        void eraseFromCell(LandmarkBase* _landmark_ptr, const CellKey& _key);
 };
 
 inline LandmarkBaseList* MapBase::getLandmarkListPtr()
@@ -52,6 +107,12 @@ inline LandmarkBaseList* MapBase::getLandmarkListPtr()
     return getDownNodeListPtr();
 }
 
+inline MapBase::CellKey MapBase::cellKey(const long int& _i, const long int& _j) const
+{
+    // the 32 low bits of each index, in two's complement. Shifting unsigned values is well defined for negative indices.
+    return ((CellKey)(unsigned int)_i << 32) | (CellKey)(unsigned int)_j;
+}
+
 } // namespace wolf
 
 #endif
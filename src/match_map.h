@@ -0,0 +1,142 @@
+/**
+ * \file match_map.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_MATCH_MAP_H_
+#define SRC_MATCH_MAP_H_
+
+// STL
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace wolf {
+
+/** \brief Flat map of matches, keyed by Feature pointer.
+ *
+ * This container stores the correspondences of the trackers,
+ * e.g. FeatureMatchMap and LandmarkMatchMap (see wolf.h).
+ * It offers the subset of the std::map interface used by the trackers,
+ *   - match_map[feature_ptr] = match;
+ *   - match_map.find(feature_ptr), match_map.erase(feature_ptr)
+ *   - for (auto& match : match_map) { match.first; match.second; }
+ *
+ * but the matches are stored contiguously in a vector sorted by key, instead of in tree nodes:
+ *   - No allocation per match: clear() keeps the memory for the next frame.
+ *   - Lookups are binary searches over contiguous memory.
+ *   - Advancing the tracker is a swap of two tables, see ProcessorTrackerFeature::advance().
+ *
+ * Inserting a new key is linear in the worst case, but the trackers insert
+ * matches for freshly created Features, which most often go at the back.
+ */
+template <typename Key, typename Match>
+class MatchMap
+{
+    public:
+        typedef std::pair<Key, Match> value_type;
+        typedef typename std::vector<value_type>::iterator iterator;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    public:
+        MatchMap() { }
+
+        Match& operator[](const Key& _key);
+
+        iterator find(const Key& _key);
+        const_iterator find(const Key& _key) const;
+        std::size_t count(const Key& _key) const;
+
+        std::size_t erase(const Key& _key);
+        iterator erase(iterator _it);
+
+        iterator begin() { return matches_.begin(); }
+        iterator end() { return matches_.end(); }
+        const_iterator begin() const { return matches_.begin(); }
+        const_iterator end() const { return matches_.end(); }
+
+        std::size_t size() const { return matches_.size(); }
+        bool empty() const { return matches_.empty(); }
+        void clear() { matches_.clear(); }
+        void reserve(std::size_t _n) { matches_.reserve(_n); }
+        void swap(MatchMap& _other) { matches_.swap(_other.matches_); }
+
+    private:
+        std::vector<value_type> matches_; ///< matches sorted by key
+
+        iterator lowerBound(const Key& _key);
+        const_iterator lowerBound(const Key& _key) const;
+};
+
+template <typename Key, typename Match>
+inline Match& MatchMap<Key, Match>::operator[](const Key& _key)
+{
+    // fast path: new keys usually go to the back
+    if (matches_.empty() || std::less<Key>()(matches_.back().first, _key))
+    {
+        matches_.emplace_back(_key, Match());
+        return matches_.back().second;
+    }
+
+    iterator it = lowerBound(_key);
+    if (it == matches_.end() || it->first != _key)
+        it = matches_.insert(it, value_type(_key, Match()));
+    return it->second;
+}
+
+template <typename Key, typename Match>
+inline typename MatchMap<Key, Match>::iterator MatchMap<Key, Match>::find(const Key& _key)
+{
+    iterator it = lowerBound(_key);
+    return (it != matches_.end() && it->first == _key) ? it : matches_.end();
+}
+
+template <typename Key, typename Match>
+inline typename MatchMap<Key, Match>::const_iterator MatchMap<Key, Match>::find(const Key& _key) const
+{
+    const_iterator it = lowerBound(_key);
+    return (it != matches_.end() && it->first == _key) ? it : matches_.end();
+}
+
+template <typename Key, typename Match>
+inline std::size_t MatchMap<Key, Match>::count(const Key& _key) const
+{
+    return find(_key) == matches_.end() ? 0 : 1;
+}
+
+template <typename Key, typename Match>
+inline std::size_t MatchMap<Key, Match>::erase(const Key& _key)
+{
+    iterator it = find(_key);
+    if (it == matches_.end())
+        return 0;
+    matches_.erase(it);
+    return 1;
+}
+
+template <typename Key, typename Match>
+inline typename MatchMap<Key, Match>::iterator MatchMap<Key, Match>::erase(iterator _it)
+{
+    return matches_.erase(_it);
+}
+
+template <typename Key, typename Match>
+inline typename MatchMap<Key, Match>::iterator MatchMap<Key, Match>::lowerBound(const Key& _key)
+{
+    return std::lower_bound(matches_.begin(), matches_.end(), _key,
+                            [](const value_type& _match, const Key& _k) { return std::less<Key>()(_match.first, _k); });
+}
+
+template <typename Key, typename Match>
+inline typename MatchMap<Key, Match>::const_iterator MatchMap<Key, Match>::lowerBound(const Key& _key) const
+{
+    return std::lower_bound(matches_.begin(), matches_.end(), _key,
+                            [](const value_type& _match, const Key& _k) { return std::less<Key>()(_match.first, _k); });
+}
+
+} // namespace wolf
+
+#endif /* SRC_MATCH_MAP_H_ */
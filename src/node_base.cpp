@@ -4,6 +4,6 @@
 namespace wolf {
 
 //init static node counter
-unsigned int NodeBase::node_id_count_ = 0;
+std::atomic<unsigned int> NodeBase::node_id_count_(0);
 
 } // namespace wolf
@@ -10,7 +10,7 @@ class Problem;
 #include "wolf.h"
 
 // std includes
-
+#include <atomic>
 
 namespace wolf {
 
@@ -61,7 +61,7 @@ namespace wolf {
 class NodeBase
 {
     private:
-        static unsigned int node_id_count_; ///< Object counter (acts as simple ID factory)
+        static std::atomic<unsigned int> node_id_count_; ///< Object counter (acts as simple ID factory). Atomic: Captures are created by the sensor driver threads
 
     protected:
         unsigned int node_id_;   ///< Node id. It is unique over the whole Wolf Tree
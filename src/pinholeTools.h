@@ -507,6 +507,130 @@ namespace pinhole {
             }
 
 
+            /**
+             * Distortion factors of a set of squared radii, for the model s = 1 + d_0 * r^2 + d_1 * r^4 + d_2 * r^6 + ...
+             * \param d the distortion parameters vector
+             * \param r2 the squared radii, as a 1xN array
+             * \param s the distortion factors, as a 1xN array
+             * \param s_min factors below this value are set to 1, see distortFactor()
+             */
+            template<class VD>
+            void distortFactors(const VD & d, const Eigen::Array<Scalar, 1, Eigen::Dynamic> & r2,
+                                Eigen::Array<Scalar, 1, Eigen::Dynamic> & s, Scalar s_min = 0.6) {
+                s.setOnes(r2.size());
+                if (d.size() == 0) return;
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> r2i = r2;
+                for (Eigen::Index i = 0; i < d.size(); i++) {
+                    s += d(i) * r2i; //                   s = 1 + d_0 * r^2 + d_1 * r^4 + d_2 * r^6 + ...
+                    r2i *= r2;
+                }
+                s = (s < s_min).select(1.0, s);
+            }
+
+            /**
+             * Project a set of points into a pin-hole camera with radial distortion
+             *
+             * Same as projectPoint(), for all columns of \a v at once.
+             *
+             * \param k the vector of intrinsic parameters, k = [u0, v0, au, av]
+             * \param d the radial distortion parameters vector
+             * \param v the 3D points to project, as a 3xN matrix
+             * \param u the projected and distorted points, as a 2xN matrix
+             */
+            template<class VK, class VD, class MV>
+            void projectPoints(const VK & k, const VD & d, const MV & v, Eigen::Matrix<Scalar, 2, Eigen::Dynamic> & u) {
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> iz = v.row(2).array().inverse();
+                Eigen::Array<Scalar, 2, Eigen::Dynamic> up = v.template topRows<2>().array().rowwise() * iz;
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> s;
+                distortFactors(d, up.matrix().colwise().squaredNorm().array(), s);
+
+                u.resize(2, v.cols());
+                u.row(0) = (k(0) + k(2) * s * up.row(0)).matrix();
+                u.row(1) = (k(1) + k(3) * s * up.row(1)).matrix();
+            }
+
+            /**
+             * Project a set of points into a pin-hole camera with radial distortion, with Jacobians
+             *
+             * Same as projectPoint(), for all columns of \a v at once.
+             * The Jacobian of the i-th point is the 2x3 block of \a U_v starting at column 3*i,
+             * so that the Jacobians of all points are contiguous in memory.
+             *
+             * \param k the vector of intrinsic parameters, k = [u0, v0, au, av]
+             * \param d the radial distortion parameters vector
+             * \param v the 3D points to project, as a 3xN matrix
+             * \param u the projected and distorted points, as a 2xN matrix
+             * \param U_v the Jacobians of \a u wrt \a v, as a 2x3N matrix
+             */
+            template<class VK, class VD, class MV>
+            void projectPoints(const VK & k, const VD & d, const MV & v, Eigen::Matrix<Scalar, 2, Eigen::Dynamic> & u,
+                               Eigen::Matrix<Scalar, 2, Eigen::Dynamic> & U_v) {
+                const unsigned int N = v.cols();
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> iz = v.row(2).array().inverse();
+                Eigen::Array<Scalar, 2, Eigen::Dynamic> up = v.template topRows<2>().array().rowwise() * iz;
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> r2 = up.matrix().colwise().squaredNorm().array();
+
+                // distortion factor s, and its derivative wrt r2
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> s = Eigen::Array<Scalar, 1, Eigen::Dynamic>::Ones(N);
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> S_r2 = Eigen::Array<Scalar, 1, Eigen::Dynamic>::Zero(N);
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> r2i = Eigen::Array<Scalar, 1, Eigen::Dynamic>::Ones(N);
+                for (Eigen::Index i = 0; i < d.size(); i++) {
+                    S_r2 += (i + 1) * d(i) * r2i; //    S_r2 = d_0 + 2 * d1 * r^2 + 3 * d_2 * r^4 +  ...
+                    r2i *= r2;
+                    s += d(i) * r2i; //                 s = 1 + d_0 * r^2 + d_1 * r^4 + d_2 * r^6 + ...
+                }
+                if (d.size() > 0)
+                    s = (s < 0.5).select(1.0, s); // see distortPoint()
+
+                u.resize(2, N);
+                u.row(0) = (k(0) + k(2) * s * up.row(0)).matrix();
+                u.row(1) = (k(1) + k(3) * s * up.row(1)).matrix();
+
+                // UD_up = [a b ; c e]
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> a = 2 * S_r2 * up.row(0) * up.row(0) + s;
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> b = 2 * S_r2 * up.row(1) * up.row(0);
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> c = b;
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> e = 2 * S_r2 * up.row(1) * up.row(1) + s;
+
+                // U_v = U_ud * UD_up * UP_v, with UP_v = [1/z 0 -x/z^2 ; 0 1/z -y/z^2] and U_ud = diag(au, av).
+                // Seen as 6xN, each column of U_v holds the 2x3 Jacobian of one point, column-major.
+                U_v.resize(2, 3 * N);
+                Eigen::Map<Eigen::Matrix<Scalar, 6, Eigen::Dynamic> > J(U_v.data(), 6, N);
+                J.row(0) = (k(2) * a * iz).matrix();
+                J.row(1) = (k(3) * c * iz).matrix();
+                J.row(2) = (k(2) * b * iz).matrix();
+                J.row(3) = (k(3) * e * iz).matrix();
+                J.row(4) = (-k(2) * (a * up.row(0) + b * up.row(1)) * iz).matrix();
+                J.row(5) = (-k(3) * (c * up.row(0) + e * up.row(1)) * iz).matrix();
+            }
+
+            /**
+             * Back-Project a set of pixels from a pin-hole camera with radial distortion
+             *
+             * Same as backprojectPoint(), for all columns of \a u at once.
+             *
+             * \param k the vector of intrinsic parameters, k = [u0, v0, au, av]
+             * \param c the radial undistortion parameters vector
+             * \param u the 2D pixels, as a 2xN matrix
+             * \param p the back-projected 3D points, as a 3xN matrix
+             * \param depth the depth prior
+             */
+            template<class VK, class VC, class MU>
+            void backprojectPoints(const VK & k, const VC & c, const MU & u, Eigen::Matrix<Scalar, 3, Eigen::Dynamic> & p,
+                                   const Scalar depth = 1.0) {
+                Eigen::Array<Scalar, 2, Eigen::Dynamic> ud(2, u.cols());
+                ud.row(0) = (u.row(0).array() - k(0)) / k(2);
+                ud.row(1) = (u.row(1).array() - k(1)) / k(3);
+                Eigen::Array<Scalar, 1, Eigen::Dynamic> s;
+                distortFactors(c, ud.matrix().colwise().squaredNorm().array(), s);
+
+                p.resize(3, u.cols());
+                p.row(0) = (depth * s * ud.row(0)).matrix();
+                p.row(1) = (depth * s * ud.row(1)).matrix();
+                p.row(2).setConstant(depth);
+            }
+
+
             /**
              * Determine if a pixel is inside the region of interest
              * \param pix the pixel to test
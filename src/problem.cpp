@@ -35,7 +35,12 @@ Problem::Problem(FrameStructure _frame_structure) :
 
 Problem::~Problem()
 {
+    // stop the front-end workers before destroying any processor, since they call virtual processor methods
+    for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
+        for (auto processor : (*sensor->getProcessorListPtr()))
+            processor->stopPipeline();
     hardware_ptr_->destruct();
+    hardware_ptr_ = nullptr; // the processors are gone: the frames destroyed next must not call them back
     trajectory_ptr_->destruct();
     map_ptr_->destruct();
 }
@@ -81,10 +86,6 @@ ProcessorBase* Problem::installProcessor(std::string _prc_type, //
     if (prc_ptr->isMotion() && origin_setted_)
         ((ProcessorMotion*)prc_ptr)->setOrigin(getLastKeyFramePtr());
 
-    // setting the main processor motion
-    if (processor_motion_ptr_ == nullptr)
-        processor_motion_ptr_ = (ProcessorMotion*)prc_ptr;
-
     return prc_ptr;
 }
 
@@ -110,9 +111,31 @@ void Problem::setProcessorMotion(ProcessorMotion* _processor_motion_ptr)
     processor_motion_ptr_ = _processor_motion_ptr;
 }
 
-FrameBase* Problem::createFrame(FrameKeyType _frame_type, const TimeStamp& _time_stamp)
+ProcessorMotion* Problem::getProcessorMotionPtr()
 {
     if (processor_motion_ptr_ != nullptr)
+        return processor_motion_ptr_;
+
+    // pick the fastest of all motion processors
+    ProcessorMotion* fastest_ptr = nullptr;
+    Scalar max_rate = -1;
+    for (auto sensor_ptr : (*hardware_ptr_->getSensorListPtr()))
+        for (auto processor_ptr : (*sensor_ptr->getProcessorListPtr()))
+            if (processor_ptr->isMotion())
+            {
+                ProcessorMotion* motion_ptr = (ProcessorMotion*)processor_ptr;
+                if (motion_ptr->isOriginSet() && motion_ptr->getRate() > max_rate)
+                {
+                    fastest_ptr = motion_ptr;
+                    max_rate = motion_ptr->getRate();
+                }
+            }
+    return fastest_ptr;
+}
+
+FrameBase* Problem::createFrame(FrameKeyType _frame_type, const TimeStamp& _time_stamp)
+{
+    if (getProcessorMotionPtr() != nullptr)
         return createFrame(_frame_type, getStateAtTimeStamp(_time_stamp), _time_stamp);
     switch (trajectory_ptr_->getFrameStructure())
     {
@@ -173,24 +196,27 @@ FrameBase* Problem::createFrame(FrameKeyType _frame_type, const Eigen::VectorXs&
 
 Eigen::VectorXs Problem::getCurrentState()
 {
-    if (processor_motion_ptr_ != nullptr)
-        return processor_motion_ptr_->getCurrentState();
+    ProcessorMotion* processor_motion_ptr = getProcessorMotionPtr();
+    if (processor_motion_ptr != nullptr)
+        return processor_motion_ptr->getCurrentState();
     else
         throw std::runtime_error("WolfProblem::getCurrentState: processor motion not set!");
 }
 
 Eigen::VectorXs Problem::getCurrentState(TimeStamp& _ts)
 {
-    if (processor_motion_ptr_ != nullptr)
-        return processor_motion_ptr_->getState(_ts);
+    ProcessorMotion* processor_motion_ptr = getProcessorMotionPtr();
+    if (processor_motion_ptr != nullptr)
+        return processor_motion_ptr->getState(_ts);
     else
         throw std::runtime_error("WolfProblem::getCurrentState: processor motion not set!");
 }
 
 void Problem::getCurrentState(Eigen::VectorXs& state)
 {
-    if (processor_motion_ptr_ != nullptr)
-        processor_motion_ptr_->getCurrentState(state);
+    ProcessorMotion* processor_motion_ptr = getProcessorMotionPtr();
+    if (processor_motion_ptr != nullptr)
+        processor_motion_ptr->getCurrentState(state);
     else
         throw std::runtime_error("WolfProblem::getCurrentState: processor motion not set!");
 }
@@ -198,24 +224,27 @@ void Problem::getCurrentState(Eigen::VectorXs& state)
 
 void Problem::getCurrentState(Eigen::VectorXs& state, TimeStamp& _ts)
 {
-    if (processor_motion_ptr_ != nullptr)
-        processor_motion_ptr_->getCurrentState(state, _ts);
+    ProcessorMotion* processor_motion_ptr = getProcessorMotionPtr();
+    if (processor_motion_ptr != nullptr)
+        processor_motion_ptr->getCurrentState(state, _ts);
     else
         throw std::runtime_error("WolfProblem::getCurrentState: processor motion not set!");
 }
 
 void Problem::getStateAtTimeStamp(const TimeStamp& _ts, Eigen::VectorXs& state)
 {
-    if (processor_motion_ptr_ != nullptr)
-        processor_motion_ptr_->getState(_ts, state);
+    ProcessorMotion* processor_motion_ptr = getProcessorMotionPtr();
+    if (processor_motion_ptr != nullptr)
+        processor_motion_ptr->getState(_ts, state);
     else
         throw std::runtime_error("WolfProblem::getCurrentState: processor motion not set!");
 }
 
 Eigen::VectorXs Problem::getStateAtTimeStamp(const TimeStamp& _ts)
 {
-    if (processor_motion_ptr_ != nullptr)
-        return processor_motion_ptr_->getState(_ts);
+    ProcessorMotion* processor_motion_ptr = getProcessorMotionPtr();
+    if (processor_motion_ptr != nullptr)
+        return processor_motion_ptr->getState(_ts);
     else
         throw std::runtime_error("WolfProblem::getCurrentState: processor motion not set!");
 }
@@ -227,10 +256,55 @@ bool Problem::permitKeyFrame(ProcessorBase* _processor_ptr)
 
 void Problem::keyFrameCallback(FrameBase* _keyframe_ptr, ProcessorBase* _processor_ptr, const Scalar& _time_tolerance)
 {
+    // motion processors first: split all motion buffers and create all motion constraints
     for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
         for (auto processor : (*sensor->getProcessorListPtr()))
-            if (processor->id() != _processor_ptr->id())
+            if (processor != _processor_ptr && processor->isMotion())
                 processor->keyFrameCallback(_keyframe_ptr, _time_tolerance);
+
+    // then the rest
+    for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
+        for (auto processor : (*sensor->getProcessorListPtr()))
+            if (processor != _processor_ptr && !processor->isMotion())
+                processor->keyFrameCallback(_keyframe_ptr, _time_tolerance);
+}
+
+void Problem::keyFrameRemovedCallback(FrameBase* _keyframe_ptr)
+{
+    if (hardware_ptr_ == nullptr)
+        return;
+    for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
+        for (auto processor : (*sensor->getProcessorListPtr()))
+            processor->keyFrameRemovedCallback(_keyframe_ptr);
+}
+
+unsigned int Problem::processQueues()
+{
+    unsigned int n = 0;
+    while (true)
+    {
+        // find the processor with the oldest enqueued Capture, be it through its front-end or not
+        ProcessorBase* oldest_processor_ptr = nullptr;
+        TimeStamp oldest_ts;
+        for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
+            for (auto processor : (*sensor->getProcessorListPtr()))
+            {
+                CaptureBase* capture_ptr = processor->getOldestCapturePtr();
+                if (capture_ptr != nullptr && (oldest_processor_ptr == nullptr || capture_ptr->getTimeStamp() < oldest_ts))
+                {
+                    oldest_processor_ptr = processor;
+                    oldest_ts = capture_ptr->getTimeStamp();
+                }
+            }
+
+        if (oldest_processor_ptr == nullptr)
+            return n;
+
+        // wait for its front-end, so that it is not overtaken by a newer Capture of another processor
+        oldest_processor_ptr->waitReadyCapturePtr();
+        oldest_processor_ptr->process(oldest_processor_ptr->popReadyCapture());
+        n++;
+    }
 }
 
 LandmarkBase* Problem::addLandmark(LandmarkBase* _lmk_ptr)
@@ -156,10 +156,23 @@ class Problem : public NodeBase
          *
          * Set the processor motion. It will provide the state.
          *
+         * If no processor motion is set, or if it is set to nullptr,
+         * the state is provided by the motion processor with the highest data rate. See getProcessorMotionPtr().
          */
         void setProcessorMotion(ProcessorMotion* _processor_motion_ptr);
         void setProcessorMotion(std::string _unique_processor_name);
 
+        /** \brief Get the processor motion providing the state
+         *
+         * Several motion processors (e.g. wheel odometry and IMU) may be installed,
+         * each of them pre-integrating its own data between the same key frames.
+         *
+         * This returns the processor motion set with setProcessorMotion(), if any.
+         * Otherwise, it returns the motion processor with the highest data rate among those with a valid origin,
+         * or nullptr if there is none.
+         */
+        ProcessorMotion* getProcessorMotionPtr();
+
         /** \brief Create Frame of the correct size
          *
          * This acts as a Frame factory, but also takes care to update related lists in WolfProblem
@@ -192,9 +205,37 @@ class Problem : public NodeBase
         /** \brief New key frame callback
          *
          * New key frame callback: It should be called by any processor that creates a new keyframe. It calls the keyFrameCallback of the rest of processors.
+         *
+         * All motion processors are called first, so that they all split their buffers at the new keyframe
+         * and create their motion constraints before any other processor gets to query the state.
+         *
+         * _processor_ptr can be nullptr if the keyframe was not created by a processor.
          */
         void keyFrameCallback(FrameBase* _keyframe_ptr, ProcessorBase* _processor_ptr, const Scalar& _time_tolerance);
 
+        /** \brief Removed key frame callback
+         *
+         * Called by a key frame being destroyed. It calls the keyFrameRemovedCallback of all processors,
+         * so that none of them keeps a dangling pointer to it.
+         */
+        void keyFrameRemovedCallback(FrameBase* _keyframe_ptr);
+
+        /** \brief Process the Captures enqueued in all processors
+         * \return the number of processed Captures.
+         *
+         * Captures enqueued by the sensor drivers (see ProcessorBase::enqueue()) are processed
+         * one at a time, always taking the oldest enqueued Capture across all processors.
+         * If it is still in the front-end of its processor, this waits for it,
+         * so that a newer Capture already through another front-end does not overtake it.
+         * This way, the Captures waiting in the queues are processed in time-stamp order,
+         * regardless of their arrival order. A Capture enqueued after a newer one was processed is still processed late.
+         *
+         * Only the front-ends run in parallel, on the worker thread of each pipelined processor (see ProcessorBase::startPipeline()).
+         * The back-ends, i.e. process(), modify the wolf tree, and run here one after the other.
+         * Call this from the thread owning the Problem.
+         */
+        unsigned int processQueues();
+
         LandmarkBase* addLandmark(LandmarkBase* _lmk_ptr);
 
         void addLandmarkList(LandmarkBaseList _lmk_list);
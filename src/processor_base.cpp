@@ -1,4 +1,5 @@
 #include "processor_base.h"
+#include "capture_base.h"
 
 namespace wolf {
 
@@ -7,14 +8,144 @@ unsigned int ProcessorBase::processor_id_count_ = 0;
 ProcessorBase::ProcessorBase(ProcessorType _tp) :
         NodeLinked(MID, "PROCESSOR"),
         processor_id_(++processor_id_count_),
-        type_id_(_tp)
+        type_id_(_tp),
+        front_end_queue_(),
+        queue_(),
+        pipeline_running_(false)
 {
     //
 }
 
 ProcessorBase::~ProcessorBase()
 {
-    //
+    stopPipeline();
+
+    // Captures never processed are not in the wolf tree: delete them here
+    CaptureBase* capture_ptr;
+    while ((capture_ptr = popReadyCapture()) != nullptr)
+        capture_ptr->destruct();
+}
+
+bool ProcessorBase::enqueue(CaptureBase* _capture_ptr)
+{
+    if (!front_end_queue_.push(_capture_ptr))
+        return false;
+
+    if (pipeline_running_)
+    {
+        // take the lock so that the worker cannot miss the notification between its check and its wait
+        { std::lock_guard<std::mutex> lock(pipeline_mutex_); }
+        pipeline_condition_.notify_one();
+    }
+    return true;
+}
+
+CaptureBase* ProcessorBase::getReadyCapturePtr() const
+{
+    // Captures through the front-end are older than those waiting for it.
+    // Without worker, the back-end takes the latter as they are.
+    CaptureBase* capture_ptr = queue_.front();
+    if (capture_ptr == nullptr && !pipeline_running_)
+        capture_ptr = front_end_queue_.front();
+    return capture_ptr;
+}
+
+CaptureBase* ProcessorBase::getOldestCapturePtr()
+{
+    // the worker moves a Capture from one queue to the other under the lock
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    CaptureBase* capture_ptr = queue_.front();
+    if (capture_ptr == nullptr)
+        capture_ptr = front_end_queue_.front();
+    return capture_ptr;
+}
+
+CaptureBase* ProcessorBase::waitReadyCapturePtr()
+{
+    std::unique_lock<std::mutex> lock(pipeline_mutex_);
+    ready_condition_.wait(lock, [this] { return !queue_.empty() || front_end_queue_.empty() || !pipeline_running_; });
+    lock.unlock();
+    return getReadyCapturePtr();
+}
+
+CaptureBase* ProcessorBase::popReadyCapture()
+{
+    CaptureBase* capture_ptr = queue_.pop();
+    if (capture_ptr != nullptr)
+    {
+        if (pipeline_running_)
+        {
+            // there is room in queue_ for the worker
+            { std::lock_guard<std::mutex> lock(pipeline_mutex_); }
+            pipeline_condition_.notify_one();
+        }
+        return capture_ptr;
+    }
+    if (!pipeline_running_)
+        return front_end_queue_.pop();
+    return nullptr;
+}
+
+unsigned int ProcessorBase::processQueue()
+{
+    unsigned int n = 0;
+    CaptureBase* capture_ptr;
+    while ((capture_ptr = popReadyCapture()) != nullptr)
+    {
+        process(capture_ptr);
+        n++;
+    }
+    return n;
+}
+
+void ProcessorBase::startPipeline()
+{
+    if (pipeline_running_)
+        return;
+    pipeline_running_ = true;
+    front_end_thread_ = std::thread(&ProcessorBase::frontEndLoop, this);
+}
+
+void ProcessorBase::stopPipeline()
+{
+    if (!pipeline_running_)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(pipeline_mutex_);
+        pipeline_running_ = false;
+    }
+    pipeline_condition_.notify_one();
+    ready_condition_.notify_one();
+    front_end_thread_.join();
+}
+
+void ProcessorBase::frontEndLoop()
+{
+    std::unique_lock<std::mutex> lock(pipeline_mutex_, std::defer_lock);
+    while (true)
+    {
+        // wait for a Capture
+        lock.lock();
+        pipeline_condition_.wait(lock, [this] { return !front_end_queue_.empty() || !pipeline_running_; });
+        lock.unlock();
+        if (!pipeline_running_)
+            return;
+
+        // The Capture is popped only once it is in queue_, so that it is never out of both queues
+        CaptureBase* capture_ptr = front_end_queue_.front();
+        frontEnd(capture_ptr);
+
+        // wait for room in queue_
+        lock.lock();
+        pipeline_condition_.wait(lock, [this] { return queue_.size() < queue_.capacity() || !pipeline_running_; });
+        if (!pipeline_running_)
+            return; // the Capture stays in front_end_queue_, and the back-end takes it as it is
+
+        queue_.push(capture_ptr);
+        front_end_queue_.pop();
+        lock.unlock();
+        ready_condition_.notify_one();
+    }
 }
 
 bool ProcessorBase::permittedKeyFrame()
@@ -10,6 +10,13 @@ class NodeTerminus;
 //Wolf includes
 #include "wolf.h"
 #include "node_linked.h"
+#include "capture_queue.h"
+
+// std includes
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace wolf {
 
@@ -21,9 +28,29 @@ struct ProcessorParamsBase
 {
         std::string type;
         std::string name;
+
+        virtual ~ProcessorParamsBase() = default; ///< polymorphic, so that creators can check the type of their params
 };
 
-//class ProcessorBase
+/** \brief Base class for all processors
+ *
+ * ### Asynchronous acquisition and pipelined processing:
+ * Captures can be handed over from a sensor driver thread through enqueue(),
+ * and processed later by processQueue() or Problem::processQueues() from the thread owning the Problem.
+ *
+ * The processing of each Capture can be split in two stages, so that they run concurrently:
+ *   - The front-end: frontEnd() works on the Capture alone, before it enters the wolf tree,
+ *     e.g. detecting and describing the features of an image.
+ *   - The back-end: process() tracks the Capture against the tree, creates KeyFrames and constraints,
+ *     and calls back the other processors.
+ *
+ * After startPipeline(), the front-end of each enqueued Capture runs on a worker thread,
+ * and the Capture is passed to the back-end through a second lock-free queue.
+ * The back-end of a Capture thus overlaps with the front-end of the next one.
+ * The wolf tree is only touched by the back-end, on the thread owning the Problem.
+ *
+ * Without pipeline, enqueued Captures go directly to the back-end, and frontEnd() is not called.
+ */
 class ProcessorBase : public NodeLinked<SensorBase, NodeTerminus>
 {
     public:
@@ -40,6 +67,62 @@ class ProcessorBase : public NodeLinked<SensorBase, NodeTerminus>
 
         virtual void process(CaptureBase* _capture_ptr) = 0;
 
+        /** \brief Hand over a Capture for later processing.
+         * \return false if the queue is full. Then the Capture is not taken.
+         *
+         * This can be called from a thread different from the one owning the Problem,
+         * e.g. the sensor driver. Only one thread can enqueue Captures to each processor.
+         */
+        bool enqueue(CaptureBase* _capture_ptr);
+
+        /** \brief Process all enqueued Captures that are through the front-end, in arrival order.
+         * \return the number of processed Captures.
+         *
+         * Call this from the thread owning the Problem.
+         * See also Problem::processQueues() to process the queues of all processors.
+         */
+        unsigned int processQueue();
+
+        /** \brief Oldest enqueued Capture ready for process(), without popping it
+         * \return the Capture, or nullptr if none is ready.
+         */
+        CaptureBase* getReadyCapturePtr() const;
+
+        /** \brief Oldest enqueued Capture, through the front-end or not, without popping it
+         * \return the Capture, or nullptr if none is enqueued.
+         */
+        CaptureBase* getOldestCapturePtr();
+
+        /** \brief Wait until the oldest enqueued Capture is through the front-end
+         * \return the Capture, ready for process(), or nullptr if none is enqueued.
+         *
+         * It returns at once if the pipeline is not running.
+         */
+        CaptureBase* waitReadyCapturePtr();
+
+        /** \brief Pop the oldest enqueued Capture ready for process()
+         * \return the Capture, or nullptr if none is ready.
+         */
+        CaptureBase* popReadyCapture();
+
+        /** \brief Number of enqueued Captures not yet popped, in the front-end or ready
+         */
+        unsigned int getNumEnqueued() const;
+
+        /** \brief Run the front-end of the enqueued Captures on a worker thread
+         */
+        void startPipeline();
+
+        /** \brief Stop the front-end worker thread
+         *
+         * Captures still waiting for the front-end are passed to the back-end as they are.
+         * Call this before destroying the processor outside of Problem::~Problem(),
+         * so that the worker does not call frontEnd() on a half-destroyed processor.
+         */
+        void stopPipeline();
+
+        bool isPipelined() const;
+
         /** \brief Vote for KeyFrame generation
          *
          * If a KeyFrame criterion is validated, this function returns true,
@@ -53,16 +136,47 @@ class ProcessorBase : public NodeLinked<SensorBase, NodeTerminus>
 
         virtual bool keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tolerance) = 0;
 
+        /** \brief Removed key frame callback
+         *
+         * Called by the Problem when a key frame is about to be destroyed.
+         * Overload it to forget any pointer to the key frame held by the processor.
+         */
+        virtual void keyFrameRemovedCallback(FrameBase* _keyframe_ptr);
+
         SensorBase* getSensorPtr();
 
         virtual bool isMotion();
 
+    protected:
+        /** \brief Front-end processing of an enqueued Capture
+         *
+         * Called on the worker thread in pipelined mode, see startPipeline().
+         * It may only work on the Capture itself, which is not yet in the wolf tree,
+         * and on members not used by process(): the back-end modifies the tree and the processor concurrently.
+         *
+         * Overload it to move expensive, tree-independent work out of process(),
+         * e.g. caching the features of the whole image. process() must give the same result if it was not called.
+         */
+        virtual void frontEnd(CaptureBase* _capture_ptr);
+
+    private:
+        void frontEndLoop();
+
     private:
         static unsigned int processor_id_count_;
 
     protected:
         unsigned int processor_id_;
         ProcessorType type_id_;
+
+    private:
+        CaptureQueue front_end_queue_;  ///< Captures waiting for the front-end. Pushed by enqueue(), popped by the worker.
+        CaptureQueue queue_;            ///< Captures through the front-end. Pushed by the worker, popped by the back-end.
+        std::thread front_end_thread_;
+        std::mutex pipeline_mutex_;
+        std::condition_variable pipeline_condition_; ///< wakes up the worker on new Captures, space in queue_, or stop
+        std::condition_variable ready_condition_;    ///< wakes up the back-end waiting in waitReadyCapturePtr()
+        std::atomic<bool> pipeline_running_;
 };
 
 inline bool ProcessorBase::isMotion()
@@ -70,6 +184,16 @@ inline bool ProcessorBase::isMotion()
     return false;
 }
 
+inline void ProcessorBase::keyFrameRemovedCallback(FrameBase* _keyframe_ptr)
+{
+    //
+}
+
+inline void ProcessorBase::frontEnd(CaptureBase* _capture_ptr)
+{
+    //
+}
+
 }
 
 //#include "problem.h"
@@ -81,6 +205,16 @@ inline unsigned int ProcessorBase::id()
     return processor_id_;
 }
 
+inline unsigned int ProcessorBase::getNumEnqueued() const
+{
+    return front_end_queue_.size() + queue_.size();
+}
+
+inline bool ProcessorBase::isPipelined() const
+{
+    return pipeline_running_;
+}
+
 inline SensorBase* ProcessorBase::getSensorPtr()
 {
     return upperNodePtr();
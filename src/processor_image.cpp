@@ -6,55 +6,23 @@
 // other includes
 #include <bitset>
 #include <algorithm>
+#include <limits>
 
 namespace wolf
 {
 
-ProcessorImage::ProcessorImage(ProcessorImageParameters _params) :
-    ProcessorTrackerFeature(PRC_TRACKER_IMAGE, _params.algorithm.max_new_features),
-    matcher_ptr_(nullptr), detector_descriptor_ptr_(nullptr), params_(_params),
+ProcessorImage::ProcessorImage(ProcessorImageParameters _params, ProcessorType _tp) :
+    ProcessorTrackerFeature(_tp, _params.algorithm.max_new_features),
+    matcher_ptr_(nullptr), detector_descriptor_ptr_(nullptr), front_end_detector_descriptor_ptr_(nullptr), params_(_params),
     active_search_grid_()
 {
     setType("IMAGE");
-    // 1. detector-descriptor params
-    DetectorDescriptorParamsBase* _dd_params = _params.detector_descriptor_params_ptr;
-    switch (_dd_params->type){
-        case DD_BRISK:
-            {
-            DetectorDescriptorParamsBrisk* params_brisk = (DetectorDescriptorParamsBrisk*) _dd_params;
-            detector_descriptor_ptr_ = new cv::BRISK(params_brisk->threshold, //
-                                                     params_brisk->octaves, //
-                                                     params_brisk->pattern_scale);
-
-            detector_descriptor_params_.pattern_radius_ = std::max((unsigned int)((_dd_params->nominal_pattern_radius)*pow(2,params_brisk->octaves)),
-                                                                   (unsigned int)((_dd_params->nominal_pattern_radius)*params_brisk->pattern_scale));
-
-            detector_descriptor_params_.size_bits_ = detector_descriptor_ptr_->descriptorSize() * 8;
-
-            break;
-            }
-        case DD_ORB:
-            {
-            DetectorDescriptorParamsOrb* params_orb = (DetectorDescriptorParamsOrb*) _dd_params;
-            detector_descriptor_ptr_ = new cv::ORB(params_orb->nfeatures, //
-                                                   params_orb->scaleFactor, //
-                                                   params_orb->nlevels, //
-                                                   params_orb->edgeThreshold, //
-                                                   params_orb->firstLevel, //
-                                                   params_orb->WTA_K, //
-                                                   params_orb->scoreType, //
-                                                   params_orb->patchSize);
-
-            detector_descriptor_params_.pattern_radius_ =
-                    (unsigned int)( (_dd_params->nominal_pattern_radius) * pow(params_orb->scaleFactor, params_orb->nlevels-1) );
-
-            detector_descriptor_params_.size_bits_ = detector_descriptor_ptr_->descriptorSize() * 8;
-
-            break;
-            }
-        default:
-            throw std::runtime_error("Unknown detector-descriptor type");
-    }
+    // 1. detector-descriptor
+    detector_descriptor_ptr_ = descriptor::createDetectorDescriptor(_params.detector_descriptor_params_ptr,
+                                                                    detector_descriptor_params_.pattern_radius_);
+    front_end_detector_descriptor_ptr_ = descriptor::createDetectorDescriptor(_params.detector_descriptor_params_ptr,
+                                                                              detector_descriptor_params_.pattern_radius_);
+    detector_descriptor_params_.size_bits_ = detector_descriptor_ptr_->descriptorSize() * 8;
 
     // 2. active search params
     active_search_grid_.setParameters(_params.image.width, _params.image.height,
@@ -65,22 +33,37 @@ ProcessorImage::ProcessorImage(ProcessorImageParameters _params) :
     // 3. matcher params
     matcher_ptr_ = new cv::BFMatcher(_params.matcher.similarity_norm);
 
+    // 4. buckets of the whole-image tracking
+    incoming_buckets_.setParameters(_params.image.width, _params.image.height,
+                                    _params.matcher.roi_width, _params.matcher.roi_height);
+
+    // 5. key frame policy
+    setKeyFramePolicy(_params);
 }
 
 //Destructor
 ProcessorImage::~ProcessorImage()
 {
-
+    delete matcher_ptr_;
+    delete detector_descriptor_ptr_;
+    delete front_end_detector_descriptor_ptr_;
 }
 
 void ProcessorImage::preProcess()
 {
     image_incoming_ = ((CaptureImage*)incoming_ptr_)->getImage();
+    gray_incoming_ = ((CaptureImage*)incoming_ptr_)->getGrayImage();
 
     if (last_ptr_ == nullptr)
-        image_last_ = ((CaptureImage*)incoming_ptr_)->getImage();
+    {
+        image_last_ = image_incoming_;
+        gray_last_ = gray_incoming_;
+    }
     else
+    {
         image_last_ = ((CaptureImage*)last_ptr_)->getImage();
+        gray_last_ = ((CaptureImage*)last_ptr_)->getGrayImage();
+    }
 
     active_search_grid_.renew();
 
@@ -97,6 +80,21 @@ void ProcessorImage::preProcess()
     tracker_candidates_.clear();
 }
 
+void ProcessorImage::frontEnd(CaptureBase* _capture_ptr)
+{
+    CaptureImage* capture_ptr = (CaptureImage*)_capture_ptr;
+    if (params_.algorithm.detect_whole_image && params_.algorithm.track_whole_image)
+        capture_ptr->describe(front_end_detector_descriptor_ptr_);
+    else
+        capture_ptr->getGrayImage();
+}
+
+void ProcessorImage::describe(CaptureImage* _capture_ptr)
+{
+    if (!_capture_ptr->hasKeypoints(front_end_detector_descriptor_ptr_))
+        _capture_ptr->describe(detector_descriptor_ptr_);
+}
+
 void ProcessorImage::postProcess()
 {
     drawFeatures(last_ptr_);
@@ -152,7 +150,7 @@ bool ProcessorImage::correctFeatureDrift(const FeatureBase* _origin_feature, con
         roi_y = (feat_last_ptr->getKeypoint().pt.y) - (roi_width / 2);
         cv::Rect roi(roi_x, roi_y, roi_width, roi_heigth);
 
-        if (detect(image_incoming_, roi, correction_keypoints, correction_descriptors))
+        if (detect(gray_incoming_, roi, correction_keypoints, correction_descriptors))
         {
 
             //the matcher is now inside the match function
@@ -223,10 +221,13 @@ unsigned int ProcessorImage::detect(cv::Mat _image, cv::Rect& _roi, std::vector<
 
 unsigned int ProcessorImage::detectNewFeatures(const unsigned int& _max_new_features)
 {
+    if (params_.algorithm.detect_whole_image)
+        return detectNewFeaturesWholeImage(_max_new_features);
+
     std::cout << "\n---------------- detectNewFeatures -------------" << std::endl;
+
     cv::Rect roi;
     std::vector<cv::KeyPoint> new_keypoints;
-    cv::Mat new_descriptors;
     cv::KeyPointsFilter keypoint_filter;
     unsigned int n_new_features = 0;
 
@@ -234,8 +235,9 @@ unsigned int ProcessorImage::detectNewFeatures(const unsigned int& _max_new_feat
     {
         if (active_search_grid_.pickRoi(roi))
         {
+            cv::Mat new_descriptors; // the new feature keeps a row of it, see trackFeatures()
         	detector_roi_.push_back(roi);
-            if (detect(image_last_, roi, new_keypoints, new_descriptors))
+            if (detect(gray_last_, roi, new_keypoints, new_descriptors))
             {
                 keypoint_filter.retainBest(new_keypoints,1);
                 FeaturePointImage* point_ptr = new FeaturePointImage(new_keypoints[0], new_descriptors.row(0), false);
@@ -265,6 +267,27 @@ unsigned int ProcessorImage::detectNewFeatures(const unsigned int& _max_new_feat
     return n_new_features;
 }
 
+unsigned int ProcessorImage::detectNewFeaturesWholeImage(const unsigned int& _max_new_features)
+{
+    CaptureImage* capture_ptr = (CaptureImage*)last_ptr_;
+    describe(capture_ptr);
+    const std::vector<cv::KeyPoint>& keypoints = capture_ptr->getKeypoints();
+    const cv::Mat& descriptors = capture_ptr->getDescriptors();
+
+    // best keypoint of each empty cell
+    active_search_grid_.pickBestInEmptyRois(keypoints, _max_new_features, new_keypoints_);
+
+    for (auto idx : new_keypoints_)
+    {
+        FeaturePointImage* point_ptr = new FeaturePointImage(keypoints[idx], descriptors.row(idx), false);
+        point_ptr->setTrackId(point_ptr->id());
+        addNewFeatureLast(point_ptr);
+        active_search_grid_.hitCell(keypoints[idx]);
+    }
+
+    return new_keypoints_.size();
+}
+
 void ProcessorImage::resetVisualizationFlag(FeatureBaseList& _feature_list_last)
 {
     for (auto feature_base_last_ptr : _feature_list_last)
@@ -277,6 +300,9 @@ void ProcessorImage::resetVisualizationFlag(FeatureBaseList& _feature_list_last)
 unsigned int ProcessorImage::trackFeatures(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
                                            FeatureMatchMap& _feature_matches)
 {
+    if (params_.algorithm.track_whole_image)
+        return trackFeaturesWholeImage(_feature_list_in, _feature_list_out, _feature_matches);
+
     std::cout << "\n---------------- trackFeatures ----------------" << std::endl;
 
     unsigned int roi_width = params_.matcher.roi_width;
@@ -284,7 +310,6 @@ unsigned int ProcessorImage::trackFeatures(const FeatureBaseList& _feature_list_
     unsigned int roi_x;
     unsigned int roi_y;
     std::vector<cv::KeyPoint> candidate_keypoints;
-    cv::Mat candidate_descriptors;
     std::vector<cv::DMatch> cv_matches;
 
     std::cout << "Number of features to track: " << _feature_list_in.size() << std::endl;
@@ -302,11 +327,14 @@ unsigned int ProcessorImage::trackFeatures(const FeatureBaseList& _feature_list_
 
         cv::Mat target_descriptor = feature_ptr->getDescriptor();
 
+        // a new matrix for each roi: the tracked feature keeps a row of it, which must not be overwritten by the next roi
+        cv::Mat candidate_descriptors;
+
         //lists used to debug
         tracker_target_.push_back(feature_ptr->getKeypoint().pt);
         tracker_roi_.push_back(roi);
 
-        if (detect(image_incoming_, roi, candidate_keypoints, candidate_descriptors))
+        if (detect(gray_incoming_, roi, candidate_keypoints, candidate_descriptors))
         {
             //the matcher is now inside the match function
             Scalar normalized_score = match(target_descriptor,candidate_descriptors,candidate_keypoints,cv_matches);
@@ -341,8 +369,64 @@ unsigned int ProcessorImage::trackFeatures(const FeatureBaseList& _feature_list_
     return _feature_list_out.size();
 }
 
-Scalar ProcessorImage::match(cv::Mat _target_descriptor, cv::Mat _candidate_descriptors,
-                             std::vector<cv::KeyPoint> _candidate_keypoints, std::vector<cv::DMatch>& _cv_matches)
+Scalar ProcessorImage::descriptorDistance(const cv::Mat& _descriptor_1, const cv::Mat& _descriptor_2) const
+{
+    return descriptor::distance(_descriptor_1.ptr<uchar>(), _descriptor_2.ptr<uchar>(), _descriptor_1.cols,
+                                params_.matcher.similarity_norm);
+}
+
+unsigned int ProcessorImage::trackFeaturesWholeImage(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
+                                                     FeatureMatchMap& _feature_matches)
+{
+    CaptureImage* capture_ptr = (CaptureImage*)incoming_ptr_;
+    describe(capture_ptr);
+    const std::vector<cv::KeyPoint>& keypoints = capture_ptr->getKeypoints();
+    const cv::Mat& descriptors = capture_ptr->getDescriptors();
+    incoming_buckets_.bucket(keypoints, descriptors);
+    keypoint_matched_.assign(keypoints.size(), false);
+
+    const Scalar half_width = params_.matcher.roi_width / 2;
+    const Scalar half_height = params_.matcher.roi_height / 2;
+
+    for (auto feature_base_ptr : _feature_list_in)
+    {
+        FeaturePointImage* feature_ptr = (FeaturePointImage*)feature_base_ptr;
+        active_search_grid_.hitCell(feature_ptr->getKeypoint());
+
+        const cv::Point2f& target = feature_ptr->getKeypoint().pt;
+        const uchar* target_descriptor = feature_ptr->getDescriptor().ptr<uchar>();
+
+        //lists used to debug
+        tracker_target_.push_back(target);
+        tracker_roi_.push_back(cv::Rect(target.x - half_width, target.y - half_height,
+                                        params_.matcher.roi_width, params_.matcher.roi_height));
+
+        // best candidate in the roi
+        Scalar best_distance;
+        int best_idx = incoming_buckets_.findBest(target_descriptor, target.x, target.y, keypoint_matched_,
+                                                  params_.matcher.similarity_norm, best_distance);
+        if (best_idx < 0)
+            continue;
+
+        Scalar normalized_score = 1 - best_distance / detector_descriptor_params_.size_bits_;
+        if (normalized_score > params_.matcher.min_normalized_score)
+        {
+            keypoint_matched_[best_idx] = true;
+            FeaturePointImage* incoming_point_ptr = new FeaturePointImage(keypoints[best_idx],
+                                                                          descriptors.row(best_idx),
+                                                                          feature_ptr->isKnown());
+            _feature_list_out.push_back(incoming_point_ptr);
+
+            incoming_point_ptr->setTrackId(feature_ptr->trackId());
+
+            _feature_matches[incoming_point_ptr] = FeatureMatch({feature_base_ptr, normalized_score});
+        }
+    }
+    return _feature_list_out.size();
+}
+
+Scalar ProcessorImage::match(const cv::Mat& _target_descriptor, const cv::Mat& _candidate_descriptors,
+                             const std::vector<cv::KeyPoint>& _candidate_keypoints, std::vector<cv::DMatch>& _cv_matches)
 {
     std::cout << " --> " << _candidate_keypoints.size() << " candidates";
 
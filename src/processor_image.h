@@ -7,6 +7,8 @@
 #include "feature_point_image.h"
 #include "state_block.h"
 #include "active_search.h"
+#include "keypoint_buckets.h"
+#include "descriptorTools.h"
 #include "processor_tracker_feature.h"
 #include "constraint_epipolar.h"
 
@@ -24,39 +26,7 @@
 
 namespace wolf {
 
-enum DetectorDescriptorType
-{
-    DD_BRISK,
-    DD_ORB
-};
-
-struct DetectorDescriptorParamsBase
-{
-        DetectorDescriptorType type;
-        unsigned int nominal_pattern_radius = 18; ///< Radius of the pattern before scaling
-        //should this be here? doesn't it depend on the descriptor?
-};
-
-struct DetectorDescriptorParamsBrisk : public DetectorDescriptorParamsBase
-{
-        unsigned int threshold=30; ///< on the keypoint strength to declare it key-point
-        unsigned int octaves=0; ///< Multi-scale evaluation. 0: no multi-scale
-        float pattern_scale=1.0f; ///< Scale of the base pattern wrt the nominal one
-};
-
-struct DetectorDescriptorParamsOrb : public DetectorDescriptorParamsBase
-{
-        unsigned int nfeatures=500;
-        float scaleFactor=1.2f;
-        unsigned int nlevels=1;//8
-        unsigned int edgeThreshold=4; //31
-        unsigned int firstLevel=0;
-        unsigned int WTA_K=2;
-        unsigned int scoreType=cv::ORB::HARRIS_SCORE;
-        unsigned int patchSize=31;
-};
-
-struct ProcessorImageParameters : public ProcessorParamsBase
+struct ProcessorImageParameters : public ProcessorParamsTracker
 {
         struct Image
         {
@@ -98,6 +68,8 @@ struct ProcessorImageParameters : public ProcessorParamsBase
         {
                 unsigned int max_new_features; ///< Max nbr. of features to detect in one frame
                 unsigned int min_features_for_keyframe; ///< minimum nbr. of features to vote for keyframe
+                bool detect_whole_image = true; ///< detect new features in one pass over the image, instead of once per active search roi
+                bool track_whole_image = true; ///< track features against one detection of the whole image, instead of one detection per roi
         }algorithm;
 };
 
@@ -108,11 +80,13 @@ class ProcessorImage : public ProcessorTrackerFeature
         //cv::FeatureDetector* detector_ptr_;
         //cv::DescriptorExtractor* descriptor_ptr_;
         cv::DescriptorMatcher* matcher_ptr_;
-        cv::Feature2D* detector_descriptor_ptr_;
+        cv::Feature2D* detector_descriptor_ptr_;            ///< detector-descriptor of the back-end, i.e. of process()
+        cv::Feature2D* front_end_detector_descriptor_ptr_;  ///< another one with the same parameters, only used by frontEnd()
     protected:
         ProcessorImageParameters params_;       // Struct with parameters of the processors
         ActiveSearchGrid active_search_grid_;   // Active Search
         cv::Mat image_last_, image_incoming_;   // Images of the "last" and "incoming" Captures
+        cv::Mat gray_last_, gray_incoming_;     // Grayscale images of the "last" and "incoming" Captures, cached in the Captures
         struct
         {
                 unsigned int pattern_radius_; ///< radius of the pattern used to detect a key-point at pattern_scale = 1.0 and octaves = 0
@@ -126,8 +100,15 @@ class ProcessorImage : public ProcessorTrackerFeature
         std::list<cv::Point> tracker_target_;
         std::list<cv::Point> tracker_candidates_;
 
+        // Workspace of the whole-image detection
+        std::vector<unsigned int> new_keypoints_;
+
+        // Workspace of the whole-image tracking
+        KeypointBuckets incoming_buckets_;          ///< keypoints of the incoming image, bucketed by tracking roi
+        std::vector<bool> keypoint_matched_;        ///< incoming keypoints already matched to a feature
+
     public:
-        ProcessorImage(ProcessorImageParameters _params);
+        ProcessorImage(ProcessorImageParameters _params, ProcessorType _tp = PRC_TRACKER_IMAGE);
         virtual ~ProcessorImage();
 
     protected:
@@ -137,6 +118,14 @@ class ProcessorImage : public ProcessorTrackerFeature
          */
         void preProcess();
 
+        /** \brief Caches the grayscale image in the Capture and, in whole-image mode, its keypoints and descriptors.
+         *
+         * The keypoints and descriptors are computed with front_end_detector_descriptor_ptr_, since the back-end
+         * keeps running detector_descriptor_ptr_ on the previous Captures meanwhile, e.g. in detect() to correct the drift.
+         * OpenCV detectors are not safe to share between threads. See also describe().
+         */
+        virtual void frontEnd(CaptureBase* _capture_ptr);
+
         /**
          * \brief Does the drawing of the features.
          *
@@ -179,8 +168,20 @@ class ProcessorImage : public ProcessorTrackerFeature
          */
         virtual ConstraintBase* createConstraint(FeatureBase* _feature_ptr, FeatureBase* _feature_other_ptr);
 
+        /**
+         * \brief Distance between two descriptors, with the norm of the matcher
+         */
+        Scalar descriptorDistance(const cv::Mat& _descriptor_1, const cv::Mat& _descriptor_2) const;
+
     private:
 
+        /**
+         * \brief Keypoints and descriptors of the whole image of a Capture, unless they are already cached in it.
+         *
+         * Those cached by frontEnd() are taken as they are: both detector-descriptors have the same parameters.
+         */
+        void describe(CaptureImage* _capture_ptr);
+
         /**
          * \brief Detects keypoints its descriptors in a specific roi of the image
          * \param _image input image in which the algorithm will search
@@ -192,6 +193,27 @@ class ProcessorImage : public ProcessorTrackerFeature
         virtual unsigned int detect(cv::Mat _image, cv::Rect& _roi, std::vector<cv::KeyPoint>& _new_keypoints,
                                          cv::Mat& new_descriptors);
 
+        /**
+         * \brief Detects new features in the whole \b last image at once, and keeps the best one of each empty active search cell.
+         * \param _max_new_features maximum number of new features. 0 means no limit.
+         * \return the number of detected features
+         *
+         * The detector and descriptor run once per image, instead of once per ROI as in the loop over pickRoi().
+         * If the whole-image tracking already described the \b last image when it was \b incoming, they do not run at all.
+         */
+        unsigned int detectNewFeaturesWholeImage(const unsigned int& _max_new_features);
+
+        /**
+         * \brief Tracks the features against one detection of the whole \b incoming image.
+         *
+         * Same inputs and outputs as trackFeatures().
+         * The incoming keypoints are bucketed in cells of the size of the tracking roi, see KeypointBuckets,
+         * so that the candidates of each feature are found by visiting at most 2x2 buckets.
+         * A keypoint matched to a feature is not a candidate for the next features.
+         */
+        unsigned int trackFeaturesWholeImage(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
+                                             FeatureMatchMap& _feature_correspondences);
+
     private:
         /**
          * \brief Trims the roi of a matrix which exceeds the boundaries of the image
@@ -213,7 +235,7 @@ class ProcessorImage : public ProcessorTrackerFeature
          */
         virtual void adaptRoi(cv::Mat& _image_roi, cv::Mat _image, cv::Rect& _roi);
 
-        virtual Scalar match(cv::Mat _target_descriptor, cv::Mat _candidate_descriptors, std::vector<cv::KeyPoint> _candidate_keypoints, std::vector<cv::DMatch>& _cv_matches);
+        virtual Scalar match(const cv::Mat& _target_descriptor, const cv::Mat& _candidate_descriptors, const std::vector<cv::KeyPoint>& _candidate_keypoints, std::vector<cv::DMatch>& _cv_matches);
 
 
 
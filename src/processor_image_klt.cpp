@@ -0,0 +1,150 @@
+/**
+ * \file processor_image_klt.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "processor_image_klt.h"
+
+namespace wolf
+{
+
+ProcessorImageKLT::ProcessorImageKLT(ProcessorImageKLTParameters _params) :
+        ProcessorImage(_params, PRC_TRACKER_IMAGE_KLT), params_klt_(_params),
+        window_size_(_params.klt.window_size, _params.klt.window_size)
+{
+    setType("IMAGE KLT");
+}
+
+void ProcessorImageKLT::preProcess()
+{
+    ProcessorImage::preProcess();
+
+    // The incoming Capture of the previous call is now last: keep its pyramid
+    std::swap(pyramid_last_, pyramid_incoming_);
+    cv::buildOpticalFlowPyramid(gray_incoming_, pyramid_incoming_, window_size_, params_klt_.klt.pyramid_levels);
+}
+
+void ProcessorImageKLT::frontEnd(CaptureBase* _capture_ptr)
+{
+    ((CaptureImage*)_capture_ptr)->getGrayImage();
+}
+
+unsigned int ProcessorImageKLT::trackFeatures(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
+                                              FeatureMatchMap& _feature_matches)
+{
+    points_last_.clear();
+    for (auto feature_base_ptr : _feature_list_in)
+    {
+        FeaturePointImage* feature_ptr = (FeaturePointImage*)feature_base_ptr;
+        points_last_.push_back(feature_ptr->getKeypoint().pt);
+        active_search_grid_.hitCell(feature_ptr->getKeypoint());
+    }
+    if (points_last_.empty())
+        return 0;
+
+    // Forward tracking, and backward tracking to validate
+    cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01);
+    cv::calcOpticalFlowPyrLK(pyramid_last_, pyramid_incoming_, points_last_, points_incoming_, status_, errors_,
+                             window_size_, params_klt_.klt.pyramid_levels, criteria);
+    points_back_ = points_last_;
+    cv::calcOpticalFlowPyrLK(pyramid_incoming_, pyramid_last_, points_incoming_, points_back_, status_back_, errors_,
+                             window_size_, params_klt_.klt.pyramid_levels, criteria, cv::OPTFLOW_USE_INITIAL_FLOW);
+
+    unsigned int i = 0;
+    for (auto feature_base_ptr : _feature_list_in)
+    {
+        const cv::Point2f& point = points_incoming_[i];
+        Scalar error = cv::norm(points_back_[i] - points_last_[i]);
+        if (status_[i] && status_back_[i] && error <= params_klt_.klt.max_error && point.x >= 0 && point.y >= 0
+                && point.x < params_.image.width && point.y < params_.image.height)
+        {
+            FeaturePointImage* feature_ptr = (FeaturePointImage*)feature_base_ptr;
+            cv::KeyPoint keypoint = feature_ptr->getKeypoint();
+            keypoint.pt = point;
+            FeaturePointImage* incoming_point_ptr = new FeaturePointImage(keypoint, feature_ptr->getDescriptor(),
+                                                                          feature_ptr->isKnown());
+            _feature_list_out.push_back(incoming_point_ptr);
+
+            incoming_point_ptr->setTrackId(feature_ptr->trackId());
+
+            _feature_matches[incoming_point_ptr] = FeatureMatch({feature_base_ptr, 1 - error / params_klt_.klt.max_error});
+        }
+        i++;
+    }
+    return _feature_list_out.size();
+}
+
+unsigned int ProcessorImageKLT::detectNewFeatures(const unsigned int& _max_new_features)
+{
+    correctDriftAtKeyFrame();
+    return ProcessorImage::detectNewFeatures(_max_new_features);
+}
+
+void ProcessorImageKLT::correctDriftAtKeyFrame()
+{
+    // Describe all tracked features in one go. The class_id of the keypoints keeps the index of their feature,
+    // because the descriptor drops the keypoints too close to the image border.
+    std::vector<FeaturePointImage*> features;
+    keypoints_tracked_.clear();
+    for (auto feature_base_ptr : *(last_ptr_->getFeatureListPtr()))
+    {
+        FeaturePointImage* feature_ptr = (FeaturePointImage*)feature_base_ptr;
+        keypoints_tracked_.push_back(feature_ptr->getKeypoint());
+        keypoints_tracked_.back().class_id = features.size();
+        features.push_back(feature_ptr);
+    }
+    if (features.empty())
+        return;
+
+    cv::Mat descriptors;
+    detector_descriptor_ptr_->compute(gray_last_, keypoints_tracked_, descriptors);
+
+    for (unsigned int k = 0; k < keypoints_tracked_.size(); k++)
+    {
+        FeaturePointImage* feature_ptr = features[keypoints_tracked_[k].class_id];
+        Scalar normalized_score = 1 - descriptorDistance(feature_ptr->getDescriptor(), descriptors.row(k))
+                / detector_descriptor_params_.size_bits_;
+
+        // The KeyFrame becomes the origin of the tracks: its descriptors are the reference from now on
+        feature_ptr->getDescriptor() = descriptors.row(k);
+
+        if (normalized_score <= params_.matcher.min_normalized_score)
+        {
+            // Drifted: do not constrain it to the origin, and start a new track
+            matches_origin_from_last_.erase(feature_ptr);
+            feature_ptr->setTrackId(feature_ptr->id());
+        }
+    }
+
+    // The features already tracked in incoming follow their feature in last
+    for (auto& match : matches_last_from_incoming_)
+    {
+        FeaturePointImage* last_feature_ptr = (FeaturePointImage*)match.second.feature_ptr_;
+        ((FeaturePointImage*)match.first)->getDescriptor() = last_feature_ptr->getDescriptor();
+        match.first->setTrackId(last_feature_ptr->trackId());
+    }
+}
+
+ProcessorBase* ProcessorImageKLT::create(const std::string& _unique_name, const ProcessorParamsBase* _params)
+{
+    const ProcessorImageKLTParameters* params = dynamic_cast<const ProcessorImageKLTParameters*>(_params);
+    if (params == nullptr)
+        throw std::runtime_error("ProcessorImageKLT::create: params are not of type ProcessorImageKLTParameters");
+    ProcessorImageKLT* prc_ptr = new ProcessorImageKLT(*params);
+    prc_ptr->setName(_unique_name);
+    return prc_ptr;
+}
+
+} // namespace wolf
+
+
+// Register in the ProcessorFactory
+#include "processor_factory.h"
+namespace wolf {
+namespace
+{
+const bool registered_prc_image_klt = ProcessorFactory::get().registerCreator("IMAGE KLT", ProcessorImageKLT::create);
+}
+} // namespace wolf
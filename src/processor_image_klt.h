@@ -0,0 +1,105 @@
+/**
+ * \file processor_image_klt.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef PROCESSOR_IMAGE_KLT_H_
+#define PROCESSOR_IMAGE_KLT_H_
+
+// Wolf includes
+#include "processor_image.h"
+
+// OpenCV includes
+#include <opencv2/video/tracking.hpp>
+
+namespace wolf
+{
+
+struct ProcessorImageKLTParameters : public ProcessorImageParameters
+{
+        struct Klt
+        {
+                unsigned int window_size = 21;  ///< side of the tracked patch, in pixels
+                unsigned int pyramid_levels = 3; ///< levels of the image pyramid, above the image itself
+                Scalar max_error = 1.0;         ///< max distance between a point and its forward-backward tracking, in pixels
+        }klt;
+};
+
+/** \brief Point feature tracker with pyramidal Lucas-Kanade optical flow
+ *
+ * This tracker detects new features like ProcessorImage, at KeyFrames, using the ActiveSearchGrid.
+ * Between KeyFrames, it tracks them with cv::calcOpticalFlowPyrLK instead of detecting and describing
+ * the incoming image, which is much cheaper between consecutive frames of a video:
+ *   - The image pyramid of each Capture is built once, when it is \b incoming, and reused when it is \b last.
+ *   - All features are tracked in one call, from \b last to \b incoming, and then back from \b incoming to \b last.
+ *     A feature is lost if it does not come back to its position in \b last within klt.max_error pixels.
+ *   - The tracked features carry the descriptor of the feature they come from, i.e. the one computed at the origin KeyFrame.
+ *
+ * The drift is corrected at KeyFrames only, since this is where the descriptors are computed:
+ * the tracked features of the new KeyFrame are described in one go, and compared to the descriptor they carry.
+ * Those that drifted (score below matcher.min_normalized_score) are not constrained to the origin,
+ * and start a new track from the KeyFrame. Hence correctFeatureDrift() does not reject anything between KeyFrames.
+ */
+class ProcessorImageKLT : public ProcessorImage
+{
+    protected:
+        ProcessorImageKLTParameters params_klt_;
+        cv::Size window_size_;
+        std::vector<cv::Mat> pyramid_last_, pyramid_incoming_; ///< image pyramids of the "last" and "incoming" Captures
+
+        // Workspace
+        std::vector<cv::Point2f> points_last_, points_incoming_, points_back_;
+        std::vector<unsigned char> status_, status_back_;
+        std::vector<float> errors_;
+        std::vector<cv::KeyPoint> keypoints_tracked_;
+
+    public:
+        ProcessorImageKLT(ProcessorImageKLTParameters _params);
+        virtual ~ProcessorImageKLT();
+
+    protected:
+        /**
+         * \brief Does the work of ProcessorImage::preProcess(), and builds the pyramid of the \b incoming image.
+         */
+        virtual void preProcess();
+
+        /** \brief Caches the grayscale image in the Capture. The detector is left to the back-end, see detectNewFeatures().
+         */
+        virtual void frontEnd(CaptureBase* _capture_ptr);
+
+        virtual unsigned int trackFeatures(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
+                                           FeatureMatchMap& _feature_correspondences);
+
+        /** \brief Accept the optical flow correspondence. The drift is corrected at KeyFrames, see detectNewFeatures().
+         */
+        virtual bool correctFeatureDrift(const FeatureBase* _origin_feature, const FeatureBase* _last_feature, FeatureBase* _incoming_feature);
+
+        /** \brief Correct the drift of the tracked features of \b last, and detect new Features in it.
+         */
+        virtual unsigned int detectNewFeatures(const unsigned int& _max_new_features);
+
+    private:
+        /** \brief Describe the tracked features of \b last, and restart the tracks that drifted from their origin.
+         */
+        void correctDriftAtKeyFrame();
+
+    public:
+        static ProcessorBase* create(const std::string& _unique_name, const ProcessorParamsBase* _params);
+};
+
+inline ProcessorImageKLT::~ProcessorImageKLT()
+{
+    //
+}
+
+inline bool ProcessorImageKLT::correctFeatureDrift(const FeatureBase* _origin_feature, const FeatureBase* _last_feature,
+                                                   FeatureBase* _incoming_feature)
+{
+    return true;
+}
+
+} // namespace wolf
+
+#endif /* PROCESSOR_IMAGE_KLT_H_ */
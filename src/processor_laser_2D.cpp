@@ -125,7 +125,7 @@ void ProcessorLaser2D::establishConstraintsMHTree()
         std::map<unsigned int, unsigned int> ft_lk_pairs;
         std::vector<bool> associated_mask;
         Scalar sq24 = sqrt(2) / 4;
-        Eigen::MatrixXs corners(3,4);
+        Eigen::Matrix<Scalar, 3, 4> corners;
                     // Center seen from corners (see LandmarkContainer.h)
                     // A                                         // B                                         // C                                         // D
         corners <<  sq24 * (CONTAINER_LENGTH + CONTAINER_WIDTH), sq24 * (CONTAINER_LENGTH + CONTAINER_WIDTH), sq24 * (CONTAINER_LENGTH + CONTAINER_WIDTH), sq24 * (CONTAINER_LENGTH + CONTAINER_WIDTH),
@@ -134,24 +134,35 @@ void ProcessorLaser2D::establishConstraintsMHTree()
 //        corners << -CONTAINER_LENGTH / 2, CONTAINER_LENGTH / 2, CONTAINER_LENGTH / 2,-CONTAINER_LENGTH / 2,
 //                   -CONTAINER_WIDTH / 2, -CONTAINER_WIDTH / 2,  CONTAINER_WIDTH / 2,  CONTAINER_WIDTH / 2,
 //                    M_PI / 4,             3 * M_PI / 4,        -3 * M_PI / 4,        -M_PI / 4;
-        Eigen::MatrixXs rotated_corners = corners;
-        Eigen::VectorXs squared_mahalanobis_distances;
+        Eigen::Vector3s d;
+        Eigen::Matrix3s Sigma_d;
+
+        // LANDMARKS WITHIN THE SCAN RANGE (containers are indexed by their center)
+        LandmarkBaseList landmarks_in_range;
+        getProblem()->getMapPtr()->getLandmarksInRange(capture_laser_ptr_->getFramePtr()->getPPtr()->getVector(),
+                                                       sensor_laser_ptr_->getScanParams().range_max_ + CONTAINER_LENGTH,
+                                                       landmarks_in_range);
 
         // COMPUTING ALL EXPECTED FEATURES
         std::map<LandmarkBase*, Eigen::Vector4s> expected_features;
         std::map<LandmarkBase*, Eigen::Matrix3s> expected_features_covs;
-        unsigned int i = 0;
-        for (auto j_it = getProblem()->getMapPtr()->getLandmarkListPtr()->begin(); j_it != getProblem()->getMapPtr()->getLandmarkListPtr()->end(); j_it++, i++)
-            computeExpectedFeature(*j_it, expected_features[*j_it], expected_features_covs[*j_it]);
+        for (auto landmark_ptr : landmarks_in_range)
+            computeExpectedFeature(landmark_ptr, expected_features[landmark_ptr], expected_features_covs[landmark_ptr]);
 
         // SETTING ASSOCIATION TREE
         std::map<unsigned int, FeatureCorner2D*> features_map;
         std::map<unsigned int, LandmarkBase*> landmarks_map;
         std::map<unsigned int, unsigned int> landmarks_index_map;
 
-        //tree object allocation and sizing
+        //tree object allocation and sizing: one target per landmark, but containers have 4 targets
+        unsigned int n_targets = 0;
+        for (auto landmark_ptr : landmarks_in_range)
+            n_targets += (landmark_ptr->getType() == LANDMARK_CONTAINER ? 4 : 1);
         AssociationTree tree;
-        tree.resize( capture_laser_ptr_->getFeatureListPtr()->size() , getProblem()->getMapPtr()->getLandmarkListPtr()->size() );
+        tree.setBeamSearch(ASSOCIATION_BEAM_WIDTH, ASSOCIATION_PRUNE_RATIO);
+        tree.resize( capture_laser_ptr_->getFeatureListPtr()->size() , n_targets );
+        innovations_.resize(3, n_targets);
+        innovations_covs_.resize(6, n_targets);
 
         //set independent probabilities between feature-landmark pairs
         ii=0;
@@ -159,8 +170,32 @@ void ProcessorLaser2D::establishConstraintsMHTree()
         {
             features_map[ii] = (FeatureCorner2D*)(*feature_it);
             //std::cout << "Feature: " << (*i_it)->nodeId() << std::endl << (*i_it)->getMeasurement().head(3).transpose() << std::endl;
+
+            // Squared Mahalanobis distances of the feature to all targets, computed in one batch
+            jj = 0;
+            for (auto landmark_ptr : landmarks_in_range)
+            {
+                computeInnovation(*feature_it, expected_features[landmark_ptr], expected_features_covs[landmark_ptr], d, Sigma_d);
+                if (landmark_ptr->getType() == LANDMARK_CONTAINER)
+                {
+                    // Corners seen from feature coordinates
+                    for (unsigned int c = 0; c < 4; c++, jj++)
+                    {
+                        innovations_.col(jj) = d - corners.col(c);
+                        setBatchCovariance(innovations_covs_, jj, Sigma_d);
+                    }
+                }
+                else
+                {
+                    innovations_.col(jj) = d;
+                    setBatchCovariance(innovations_covs_, jj, Sigma_d);
+                    jj++;
+                }
+            }
+            squaredMahalanobisDistances(innovations_, innovations_covs_, squared_mahalanobis_distances_);
+
             jj = 0;
-            for (auto landmark_it = getProblem()->getMapPtr()->getLandmarkListPtr()->begin(); landmark_it != getProblem()->getMapPtr()->getLandmarkListPtr()->end(); landmark_it++, jj++)
+            for (auto landmark_it = landmarks_in_range.begin(); landmark_it != landmarks_in_range.end(); landmark_it++, jj++)
             {
                 if ((*landmark_it)->getType() == LANDMARK_CORNER)
                 {
@@ -170,7 +205,7 @@ void ProcessorLaser2D::establishConstraintsMHTree()
                     //If aperture difference is small enough, proceed with Mahalanobis distance. Otherwise Set prob to 0 to force unassociation
                     if (fabs(pi2pi(((FeatureCorner2D*)(*feature_it))->getAperture() - (*landmark_it)->getDescriptor(0))) < MAX_ACCEPTED_APERTURE_DIFF)
                     {
-                        dm2 = computeSquaredMahalanobisDistances(*feature_it, expected_features[*landmark_it], expected_features_covs[*landmark_it], Eigen::MatrixXs::Zero(3,1))(0);//Mahalanobis squared
+                        dm2 = squared_mahalanobis_distances_(jj);//Mahalanobis squared
                         prob = (dm2 < 5*5 ? 5*erfc( sqrt(dm2/2) ) : 0); //prob = erfc( sqrt(dm2/2) ); //prob = erfc( sqrt(dm2)/1.4142136 );// sqrt(2) = 1.4142136
                         tree.setScore(ii,jj,prob);
                     }
@@ -180,23 +215,14 @@ void ProcessorLaser2D::establishConstraintsMHTree()
                 else if ((*landmark_it)->getType() == LANDMARK_CONTAINER)
                 {
                     //std::cout << "Landmark: " << (*j_it)->nodeId() << " - jj: " << jj << " " << jj+1 << " " << jj+2 << " " << jj+3 << std::endl;
-                    // Resize tree (expected 1 target for each landmark but containers have 4 targets)
-                    if (feature_it == capture_laser_ptr_->getFeatureListPtr()->begin())
-                        tree.resize( tree.numDetections() , tree.numTargets()+3 );
-
                     //If aperture difference is small enough, proceed with Mahalanobis distance. Otherwise Set prob to 0 to force unassociation
                     if (fabs(pi2pi(((FeatureCorner2D*)(*feature_it))->getAperture() - 3 * M_PI / 2)) < MAX_ACCEPTED_APERTURE_DIFF)
                     {
-                        // Rotate corners (seen from feature coordinates)
-                        //rotated_corners.topRows(2) = Eigen::Rotation2D<Scalar>(expected_features[*landmark_it](2)).matrix() * corners.topRows(2);
-                        rotated_corners = corners;
-                        squared_mahalanobis_distances = computeSquaredMahalanobisDistances((*feature_it), expected_features[*landmark_it], expected_features_covs[*landmark_it], rotated_corners);
-
                         for (unsigned int c = 0; c < 4; c++, jj++)
                         {
                             landmarks_map[jj] = (*landmark_it);
                             landmarks_index_map[jj] = c;
-                            prob = (squared_mahalanobis_distances(c) < 5.*5. ? 5*erfc( sqrt(squared_mahalanobis_distances(c)/2) ) : 0); //prob = erfc( sqrt(dm2/2) ); //prob = erfc( sqrt(dm2)/1.4142136 );// sqrt(2) = 1.4142136
+                            prob = (squared_mahalanobis_distances_(jj) < 5.*5. ? 5*erfc( sqrt(squared_mahalanobis_distances_(jj)/2) ) : 0); //prob = erfc( sqrt(dm2/2) ); //prob = erfc( sqrt(dm2)/1.4142136 );// sqrt(2) = 1.4142136
                             tree.setScore(ii,jj,prob);
                         }
                         jj--;
@@ -377,10 +403,8 @@ void ProcessorLaser2D::computeExpectedFeature(LandmarkBase* _landmark_ptr, Eigen
     expected_feature_cov_ = Jlr * Sigma.selfadjointView<Eigen::Upper>() * Jlr.transpose();
 }
 
-Eigen::VectorXs ProcessorLaser2D::computeSquaredMahalanobisDistances(const FeatureBase* _feature_ptr, const LandmarkBase* _landmark_ptr, const Eigen::MatrixXs& _mu)
+void ProcessorLaser2D::computeInnovation(const FeatureBase* _feature_ptr, const LandmarkBase* _landmark_ptr, Eigen::Vector3s& _d, Eigen::Matrix3s& _Sigma_d)
 {
-    assert(_mu.rows() == 3 && "mahalanobis distance with bad number of mu components");
-
     FrameBase* frame_ptr = capture_laser_ptr_->getFramePtr();
 
     Eigen::Vector2s p_robot = frame_ptr->getPPtr()->getVector();
@@ -403,9 +427,8 @@ Eigen::VectorXs ProcessorLaser2D::computeSquaredMahalanobisDistances(const Featu
     Eigen::Vector2s p_robot_landmark = p_robot - p_landmark;
 
     // ------------------------ d
-    Eigen::Vector3s d;
-    d.head(2) = p_feature + R_sr.transpose()*p_robot_landmark + R_sensor.transpose()*p_sensor;
-    d(2) = pi2pi(o_feature - o_landmark + o_robot + o_sensor);
+    _d.head(2) = p_feature + R_sr.transpose()*p_robot_landmark + R_sensor.transpose()*p_sensor;
+    _d(2) = pi2pi(o_feature - o_landmark + o_robot + o_sensor);
 
 //    std::cout << "robot = " << p_robot.transpose() << o_robot << std::endl;
 //    std::cout << "sensor = " << p_sensor.transpose() << o_sensor << std::endl;
@@ -441,41 +464,23 @@ Eigen::VectorXs ProcessorLaser2D::computeSquaredMahalanobisDistances(const Featu
     getProblem()->getCovarianceBlock(frame_ptr->getPPtr(), frame_ptr->getOPtr(), Sigma, 3,5);
     getProblem()->getCovarianceBlock(frame_ptr->getOPtr(), frame_ptr->getOPtr(), Sigma, 5,5);
 
-    // MAHALANOBIS DISTANCES
-    Eigen::Matrix3s iSigma_d = (Sigma_feature + Jlr * Sigma.selfadjointView<Eigen::Upper>() * Jlr.transpose()).inverse();
-
-    Eigen::VectorXs squared_mahalanobis_distances(_mu.cols());
-
-    for (unsigned int i = 0; i < _mu.cols(); i++)
-        squared_mahalanobis_distances(i) = (d - _mu.col(i)).transpose() * iSigma_d * (d - _mu.col(i));
-
-    return squared_mahalanobis_distances;
+    _Sigma_d = Sigma_feature + Jlr * Sigma.selfadjointView<Eigen::Upper>() * Jlr.transpose();
 }
 
-Eigen::VectorXs ProcessorLaser2D::computeSquaredMahalanobisDistances(const FeatureBase* _feature_ptr, const Eigen::Vector4s& _expected_feature, const Eigen::Matrix3s& _expected_feature_cov, const Eigen::MatrixXs& _mu)
+void ProcessorLaser2D::computeInnovation(const FeatureBase* _feature_ptr, const Eigen::Vector4s& _expected_feature, const Eigen::Matrix3s& _expected_feature_cov, Eigen::Vector3s& _d, Eigen::Matrix3s& _Sigma_d)
 {
-    assert(_mu.rows() == 3 && "mahalanobis distance with bad number of mu components");
-
     const Eigen::Vector2s& p_feature = _feature_ptr->getMeasurement().head(2);
     const Scalar&      o_feature = _feature_ptr->getMeasurement()(2);
 
     // ------------------------ d
-    Eigen::Vector3s d;
-    d.head(2) = p_feature - _expected_feature.head(2);
-    d(2) = pi2pi(o_feature - _expected_feature(2));
+    _d.head(2) = p_feature - _expected_feature.head(2);
+    _d(2) = pi2pi(o_feature - _expected_feature(2));
 
 //    std::cout << "feature = " << p_feature.transpose() << o_feature << std::endl;
 //    std::cout << "d = " << d.transpose() << std::endl;
 
     // ------------------------ Sigma_d
-    Eigen::Matrix3s iSigma_d = (_feature_ptr->getMeasurementCovariance().topLeftCorner<3,3>() + _expected_feature_cov).inverse();
-
-    Eigen::VectorXs squared_mahalanobis_distances(_mu.cols());
-
-    for (unsigned int i = 0; i < _mu.cols(); i++)
-        squared_mahalanobis_distances(i) = (d - _mu.col(i)).transpose() * iSigma_d * (d - _mu.col(i));
-
-    return squared_mahalanobis_distances;
+    _Sigma_d = _feature_ptr->getMeasurementCovariance().topLeftCorner<3,3>() + _expected_feature_cov;
 }
 
 bool ProcessorLaser2D::fitNewContainer(FeatureCorner2D* _corner_feature_ptr, LandmarkCorner2D*& _corner_landmark_ptr, int& feature_corner_idx, int& landmark_corner_idx)
@@ -485,81 +490,100 @@ bool ProcessorLaser2D::fitNewContainer(FeatureCorner2D* _corner_feature_ptr, Lan
     // It has to be 90º corner feature
     if (std::fabs(pi2pi(_corner_feature_ptr->getMeasurement()(3) + M_PI / 2)) < MAX_ACCEPTED_APERTURE_DIFF)
     {
-        // Check all existing corners searching a container
+        Scalar SQ2 = sqrt(2)/2;
+        Eigen::Matrix<Scalar, 3, 6> corners_relative_positions;
+                                      // FROM A (see LandmarkContainer.h)                                                        // FROM B
+                                      // Large side           // Short side          // Diagonal                                 // Large side           // Short side          // Diagonal
+        corners_relative_positions << SQ2 * CONTAINER_LENGTH, SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_LENGTH + CONTAINER_WIDTH), SQ2 * CONTAINER_LENGTH, SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_LENGTH + CONTAINER_WIDTH),
+                                     -SQ2 * CONTAINER_LENGTH, SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_WIDTH - CONTAINER_LENGTH), SQ2 * CONTAINER_LENGTH,-SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_LENGTH - CONTAINER_WIDTH),
+                                      M_PI / 2,              -M_PI / 2,              M_PI,                                      -M_PI / 2,               M_PI / 2,              M_PI;
+
+        Eigen::Matrix2s R_feature = Eigen::Rotation2D<Scalar>(_corner_feature_ptr->getMeasurement()(2)).matrix();
+        corners_relative_positions = - corners_relative_positions;
+        corners_relative_positions.topRows(2) = R_feature * corners_relative_positions.topRows(2);
+
+        // All existing corners, candidates to be in the same container
+        std::vector<LandmarkBase*> candidates;
         for (auto landmark_it = getProblem()->getMapPtr()->getLandmarkListPtr()->rbegin(); landmark_it != getProblem()->getMapPtr()->getLandmarkListPtr()->rend(); landmark_it++)
-        {
             if ((*landmark_it)->getType() == LANDMARK_CORNER // should be a corner
                     && std::fabs(pi2pi(((LandmarkCorner2D*)(*landmark_it))->getAperture() + M_PI / 2)) < MAX_ACCEPTED_APERTURE_DIFF) // should be a corner
+                candidates.push_back(*landmark_it);
+
+        // Squared Mahalanobis distances to the 6 relative positions of all candidates, computed in one batch
+        innovations_.resize(3, 6 * candidates.size());
+        innovations_covs_.resize(6, 6 * candidates.size());
+        Eigen::Vector3s d;
+        Eigen::Matrix3s Sigma_d;
+        for (unsigned int k = 0; k < candidates.size(); k++)
+        {
+            computeInnovation(_corner_feature_ptr, candidates[k], d, Sigma_d);
+            for (unsigned int i = 0; i < 6; i++)
             {
-                //std::cout << "landmark " << (*landmark_it)->nodeId() << std::endl;
-                Scalar SQ2 = sqrt(2)/2;
-                Eigen::MatrixXs corners_relative_positions(3,6);
-                                              // FROM A (see LandmarkContainer.h)                                                        // FROM B
-                                              // Large side           // Short side          // Diagonal                                 // Large side           // Short side          // Diagonal
-                corners_relative_positions << SQ2 * CONTAINER_LENGTH, SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_LENGTH + CONTAINER_WIDTH), SQ2 * CONTAINER_LENGTH, SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_LENGTH + CONTAINER_WIDTH),
-                                             -SQ2 * CONTAINER_LENGTH, SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_WIDTH - CONTAINER_LENGTH), SQ2 * CONTAINER_LENGTH,-SQ2 * CONTAINER_WIDTH, SQ2 * (CONTAINER_LENGTH - CONTAINER_WIDTH),
-                                              M_PI / 2,              -M_PI / 2,              M_PI,                                      -M_PI / 2,               M_PI / 2,              M_PI;
-
-                Eigen::Matrix2s R_feature = Eigen::Rotation2D<Scalar>(_corner_feature_ptr->getMeasurement()(2)).matrix();
-                corners_relative_positions = - corners_relative_positions;
-                corners_relative_positions.topRows(2) = R_feature * corners_relative_positions.topRows(2);
-
-                Eigen::VectorXs squared_mahalanobis_distances = computeSquaredMahalanobisDistances(_corner_feature_ptr, (*landmark_it), corners_relative_positions);
-
-//                std::cout << "squared_mahalanobis_distances " << std::endl << squared_mahalanobis_distances << std::endl;
-//                std::cout << "probabilities " << std::endl;
-//                for (unsigned int i = 0; i < 6; i++)
-//                    std::cout << erfc( sqrt(squared_mahalanobis_distances(i)/2) ) << std::endl;
-
-                Scalar SMD_threshold = 8;
-                if (squared_mahalanobis_distances(0) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(0)/2) ) > 0.8 )
-                {
-                    std::cout << "   large side! prob =  " << erfc( sqrt(squared_mahalanobis_distances(0)/2.0)) << std::endl;
-                    feature_corner_idx = 0;
-                    landmark_corner_idx = 1;
-                    _corner_landmark_ptr = (LandmarkCorner2D*)(*landmark_it);
-                    return true;
-                }
-                if (squared_mahalanobis_distances(1) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(1)/2) ) > 0.8 )
-                {
-                    std::cout << "   short side!  prob = " << erfc( sqrt(squared_mahalanobis_distances(1)/2)) << std::endl;
-                    feature_corner_idx = 2;
-                    landmark_corner_idx = 1;
-                    _corner_landmark_ptr = (LandmarkCorner2D*)(*landmark_it);
-                    return true;
-                }
-                if (squared_mahalanobis_distances(2) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(2)/2) ) > 0.8 )
-                {
-                    std::cout << "   diagonal!  prob = " << erfc( sqrt(squared_mahalanobis_distances(2)/2)) << std::endl;
-                    feature_corner_idx = 0;
-                    landmark_corner_idx = 2;
-                    _corner_landmark_ptr = (LandmarkCorner2D*)(*landmark_it);
-                    return true;
-                }
-                if (squared_mahalanobis_distances(3) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(3)/2) ) > 0.8 )
-                {
-                    std::cout << "   large side! prob = " << erfc( sqrt(squared_mahalanobis_distances(3)/2)) << std::endl;
-                    feature_corner_idx = 1;
-                    landmark_corner_idx = 0;
-                    _corner_landmark_ptr = (LandmarkCorner2D*)(*landmark_it);
-                    return true;
-                }
-                if (squared_mahalanobis_distances(4) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(4)/2) ) > 0.8 )
-                {
-                    std::cout << "   short side!  prob = " << erfc( sqrt(squared_mahalanobis_distances(4)/2)) << std::endl;
-                    feature_corner_idx = 1;
-                    landmark_corner_idx = 2;
-                    _corner_landmark_ptr = (LandmarkCorner2D*)(*landmark_it);
-                    return true;
-                }
-                if (squared_mahalanobis_distances(5) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(5)/2) ) > 0.8 )
-                {
-                    std::cout << "   diagonal!  prob = " << erfc( sqrt(squared_mahalanobis_distances(5)/2)) << std::endl;
-                    feature_corner_idx = 1;
-                    landmark_corner_idx = 3;
-                    _corner_landmark_ptr = (LandmarkCorner2D*)(*landmark_it);
-                    return true;
-                }
+                innovations_.col(6 * k + i) = d - corners_relative_positions.col(i);
+                setBatchCovariance(innovations_covs_, 6 * k + i, Sigma_d);
+            }
+        }
+        squaredMahalanobisDistances(innovations_, innovations_covs_, squared_mahalanobis_distances_);
+
+        // Check all candidates searching a container
+        Scalar SMD_threshold = 8;
+        for (unsigned int k = 0; k < candidates.size(); k++)
+        {
+            //std::cout << "landmark " << candidates[k]->nodeId() << std::endl;
+            Eigen::Matrix<Scalar, 6, 1> squared_mahalanobis_distances = squared_mahalanobis_distances_.segment<6>(6 * k);
+
+//            std::cout << "squared_mahalanobis_distances " << std::endl << squared_mahalanobis_distances << std::endl;
+//            std::cout << "probabilities " << std::endl;
+//            for (unsigned int i = 0; i < 6; i++)
+//                std::cout << erfc( sqrt(squared_mahalanobis_distances(i)/2) ) << std::endl;
+
+            if (squared_mahalanobis_distances(0) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(0)/2) ) > 0.8 )
+            {
+                std::cout << "   large side! prob =  " << erfc( sqrt(squared_mahalanobis_distances(0)/2.0)) << std::endl;
+                feature_corner_idx = 0;
+                landmark_corner_idx = 1;
+                _corner_landmark_ptr = (LandmarkCorner2D*)(candidates[k]);
+                return true;
+            }
+            if (squared_mahalanobis_distances(1) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(1)/2) ) > 0.8 )
+            {
+                std::cout << "   short side!  prob = " << erfc( sqrt(squared_mahalanobis_distances(1)/2)) << std::endl;
+                feature_corner_idx = 2;
+                landmark_corner_idx = 1;
+                _corner_landmark_ptr = (LandmarkCorner2D*)(candidates[k]);
+                return true;
+            }
+            if (squared_mahalanobis_distances(2) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(2)/2) ) > 0.8 )
+            {
+                std::cout << "   diagonal!  prob = " << erfc( sqrt(squared_mahalanobis_distances(2)/2)) << std::endl;
+                feature_corner_idx = 0;
+                landmark_corner_idx = 2;
+                _corner_landmark_ptr = (LandmarkCorner2D*)(candidates[k]);
+                return true;
+            }
+            if (squared_mahalanobis_distances(3) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(3)/2) ) > 0.8 )
+            {
+                std::cout << "   large side! prob = " << erfc( sqrt(squared_mahalanobis_distances(3)/2)) << std::endl;
+                feature_corner_idx = 1;
+                landmark_corner_idx = 0;
+                _corner_landmark_ptr = (LandmarkCorner2D*)(candidates[k]);
+                return true;
+            }
+            if (squared_mahalanobis_distances(4) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(4)/2) ) > 0.8 )
+            {
+                std::cout << "   short side!  prob = " << erfc( sqrt(squared_mahalanobis_distances(4)/2)) << std::endl;
+                feature_corner_idx = 1;
+                landmark_corner_idx = 2;
+                _corner_landmark_ptr = (LandmarkCorner2D*)(candidates[k]);
+                return true;
+            }
+            if (squared_mahalanobis_distances(5) < SMD_threshold ) //erfc( sqrt(squared_mahalanobis_distances(5)/2) ) > 0.8 )
+            {
+                std::cout << "   diagonal!  prob = " << erfc( sqrt(squared_mahalanobis_distances(5)/2)) << std::endl;
+                feature_corner_idx = 1;
+                landmark_corner_idx = 3;
+                _corner_landmark_ptr = (LandmarkCorner2D*)(candidates[k]);
+                return true;
             }
         }
     }
@@ -31,6 +31,7 @@
 #include "constraint_container.h"
 
 #include "data_association/association_tree.h"
+#include "data_association/mahalanobis_gating.h"
 
 //std includes
 #include <list>
@@ -44,6 +45,8 @@ namespace wolf {
 const Scalar MAX_ACCEPTED_APERTURE_DIFF = 20.0*M_PI/180.; //20 degrees
 const Scalar CONTAINER_WIDTH = 2.44;
 const Scalar CONTAINER_LENGTH = 12.20;
+const unsigned int ASSOCIATION_BEAM_WIDTH = 32; // hypotheses kept per detection in the association tree
+const double ASSOCIATION_PRUNE_RATIO = 1e-3;
 
 struct ProcessorParamsLaser2D : public ProcessorParamsBase
 {
@@ -60,6 +63,11 @@ class ProcessorLaser2D : public ProcessorBase
         SensorLaser2D* sensor_laser_ptr_; //specific pointer to sensor laser 2D object
         CaptureLaser2D* capture_laser_ptr_; // specific pointer to capture laser 2D object
 
+        // Data association workspace, kept between calls to avoid reallocations
+        InnovationBatch3 innovations_;              ///< innovations of one feature w.r.t. all association targets
+        CovarianceBatch3 innovations_covs_;         ///< and their covariances
+        Eigen::VectorXs squared_mahalanobis_distances_;
+
     public:
         ProcessorLaser2D();
         virtual ~ProcessorLaser2D();
@@ -88,13 +96,11 @@ class ProcessorLaser2D : public ProcessorBase
         void establishConstraintsMHTree();
         void computeExpectedFeature(LandmarkBase* _landmark_ptr, Eigen::Vector4s& expected_feature_,
                                     Eigen::Matrix3s& expected_feature_cov_);
-        Eigen::VectorXs computeSquaredMahalanobisDistances(const FeatureBase* _feature_ptr,
-                                                           const LandmarkBase* _landmark_ptr,
-                                                           const Eigen::MatrixXs& _mu);
-        Eigen::VectorXs computeSquaredMahalanobisDistances(const FeatureBase* _feature_ptr,
-                                                           const Eigen::Vector4s& _expected_feature,
-                                                           const Eigen::Matrix3s& _expected_feature_cov,
-                                                           const Eigen::MatrixXs& _mu);
+        void computeInnovation(const FeatureBase* _feature_ptr, const LandmarkBase* _landmark_ptr,
+                               Eigen::Vector3s& _d, Eigen::Matrix3s& _Sigma_d);
+        void computeInnovation(const FeatureBase* _feature_ptr, const Eigen::Vector4s& _expected_feature,
+                               const Eigen::Matrix3s& _expected_feature_cov,
+                               Eigen::Vector3s& _d, Eigen::Matrix3s& _Sigma_d);
         bool fitNewContainer(FeatureCorner2D* _corner_ptr, LandmarkCorner2D*& old_corner_landmark_ptr, int& feature_idx,
                              int& corner_idx);
         void createCornerLandmark(FeatureCorner2D* _corner_ptr, const Eigen::Vector3s& _feature_global_pose);
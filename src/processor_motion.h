@@ -13,6 +13,13 @@
 #include "capture_motion2.h"
 #include "time_stamp.h"
 
+// STL
+#include <vector>
+#include <list>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+
 namespace wolf
 {
 
@@ -62,6 +69,34 @@ namespace wolf
  * which are called at the beginning and at the end of process(). See the doc of these functions for more info.
  *
  *
+ * ### Delayed data:
+ *
+ * Data arriving with a time stamp older than the last integrated one (e.g. from a delayed USB board)
+ * is inserted in the buffer at its correct place, and only the part of the buffer after it is reintegrated.
+ * The deltas already in the buffer are kept, so this is exact for data in the form of increments (e.g. odometry).
+ * Data is dropped if it is older than the origin of the buffer (the last key frame),
+ * or if it is delayed by more than the maximum delay set with setMaxDelay(). See getNumDropped().
+ *
+ *
+ * ### Key frames created by other processors:
+ *
+ * A key frame may be created by another processor at a time stamp that this processor's data has not reached yet,
+ * e.g. by a faster motion processor. Splitting the buffer there would attribute no motion to the key frame,
+ * and would move the origin past the data still to come, which would then be dropped as too old.
+ * Instead, such key frames are kept pending, and the buffer is split as soon as the data passes them.
+ *
+ *
+ * ### Buffer compression:
+ *
+ * When key frames are rare (e.g. the robot stands still), the buffer would grow at the rate of the data.
+ * Two compression modes, which can be combined, merge consecutive motions into one by composing their deltas:
+ *   - setBufferCompressionThreshold(): the newest motion is merged with its predecessor while the composed delta is small.
+ *   - setMaxBufferLength(): the oldest motions are merged when the buffer exceeds a maximum length.
+ *
+ * Merging a motion into the next one does not alter the integrated delta and covariance of the latter,
+ * so the buffer stays exact at the retained time stamps.
+ *
+ *
  * ### Defining (or not) the fromSensorFrame():
  *
  * In most cases, one will be interested in avoiding the \b fromSensorFrame() issue.
@@ -86,6 +121,20 @@ class ProcessorMotion : public ProcessorBase
 
         virtual void process(CaptureBase* _incoming_ptr);
 
+        /** \brief Integrate a batch of motion data in one call
+         * \param _ts_list the time stamps of the samples, in increasing order
+         * \param _data the raw motion data, one sample per row (data_size_ columns)
+         * \param _data_cov the raw motion data covariance, common to all samples in the batch
+         *
+         * This is equivalent to calling process() once per sample, but no Capture is created for each sample.
+         * Since the data is accepted through an Eigen::Ref, any contiguous block of memory
+         * (e.g. a driver buffer or a memory-mapped file) can be wrapped with an Eigen::Map and passed without copies.
+         *
+         * Note: preProcess() and postProcess() are not called, as there is no incoming Capture.
+         */
+        void process(const std::vector<TimeStamp>& _ts_list, const Eigen::Ref<const Eigen::MatrixXs>& _data,
+                     const Eigen::MatrixXs& _data_cov);
+
         // Queries to the processor:
 
         virtual bool voteForKeyFrame();
@@ -149,10 +198,14 @@ class ProcessorMotion : public ProcessorBase
          * \param _jacobian1 jacobian of the composition w.r.t. _delta1
          * \param _jacobian2 jacobian of the composition w.r.t. _delta2
          * \param _delta_cov1_plus_delta_cov2 the covariance of the composition.
+         *
+         * The default implementation performs the generic dense products J1*P1*J1' + J2*P2*J2'.
+         * Derived classes knowing the sparsity structure of their Jacobians
+         * (as returned by deltaPlusDelta()) can overload it with a cheaper, structured update.
          */
-        void deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1, const Eigen::MatrixXs& _delta_cov2,
-                                  const Eigen::MatrixXs& _jacobian1, const Eigen::MatrixXs& _jacobian2,
-                                  Eigen::MatrixXs& _delta_cov1_plus_delta_cov2);
+        virtual void deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1, const Eigen::MatrixXs& _delta_cov2,
+                                          const Eigen::MatrixXs& _jacobian1, const Eigen::MatrixXs& _jacobian2,
+                                          Eigen::MatrixXs& _delta_cov1_plus_delta_cov2);
         /** Set the origin of all motion for this processor
          * \param _origin_frame the key frame to be the origin
          */
@@ -166,6 +219,51 @@ class ProcessorMotion : public ProcessorBase
 
         virtual bool keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol);
 
+        /** \brief Forgets a key frame being removed, if it is still pending
+         */
+        virtual void keyFrameRemovedCallback(FrameBase* _keyframe_ptr);
+
+        /** \brief Number of key frames waiting for the data to reach them, see keyFrameCallback()
+         */
+        Size getNumPendingKeyFrames() const;
+
+        /** \brief Tells whether the origin of motion has been set, and so if the processor can provide states
+         */
+        bool isOriginSet() const;
+
+        /** \brief Average rate of the integrated data, in Hz
+         *
+         * It is computed over all the data integrated since the origin was set.
+         * It is zero if no data has been integrated yet.
+         *
+         * Used by Problem to select the processor providing the state when several motion processors are installed.
+         */
+        Scalar getRate() const;
+
+        /** \brief Set the maximum delay of the data that is accepted out of order
+         * \param _max_delay the maximum delay, in seconds, with respect to the last integrated data.
+         *
+         * Delayed data requires reintegrating the part of the buffer after it, so this bounds the reintegration cost.
+         * By default there is no limit other than the origin of the buffer.
+         */
+        void setMaxDelay(const Scalar& _max_delay);
+
+        /** \brief Number of data samples dropped for being too old, see setMaxDelay()
+         */
+        unsigned long int getNumDropped() const;
+
+        /** \brief Set the threshold for merging small motions in the buffer
+         * \param _delta_norm_threshold merge the last two motions if the norm of their composed delta,
+         * measured with respect to deltaZero(), is smaller than this. Zero disables this compression.
+         */
+        void setBufferCompressionThreshold(const Scalar& _delta_norm_threshold);
+
+        /** \brief Set the maximum length of the buffer
+         * \param _max_buffer_length maximum number of motions in the buffer. The oldest motions are merged
+         * to keep the buffer within this length. Zero means unlimited.
+         */
+        void setMaxBufferLength(const Size& _max_buffer_length);
+
         // Helper functions:
     public:
         // TODO change to protected
@@ -185,8 +283,16 @@ class ProcessorMotion : public ProcessorBase
 
     protected:
         void updateDt();
+        void updateDt(const TimeStamp& _ts);
         void integrate();
+        void integrate(const TimeStamp& _ts, const Eigen::VectorXs& _data, const Eigen::MatrixXs& _data_cov);
+        void integrateDelayed(const TimeStamp& _ts, const Eigen::VectorXs& _data, const Eigen::MatrixXs& _data_cov);
         void reintegrate();
+        void reintegrate(std::list<Motion>::iterator _motion_it);
+        void compressBuffer();
+        void mergeMotions(std::list<Motion>::iterator _motion_it);
+        void splitAtKeyFrame(FrameBase* _keyframe_ptr);
+        void splitPendingKeyFrames();
 
         /** Pre-process incoming Capture
          *
@@ -313,6 +419,13 @@ class ProcessorMotion : public ProcessorBase
         CaptureBase* origin_ptr_; //TODO: JV: change by FrameBase* origin_frame_ptr_
         CaptureMotion2* last_ptr_;
         CaptureMotion2* incoming_ptr_;
+        TimeStamp ts_start_;                ///< time stamp of the first origin, to compute the data rate
+        unsigned long int n_integrated_;    ///< number of data integrated since the first origin
+        Scalar max_delay_;                  ///< maximum delay of the data accepted out of order
+        unsigned long int n_dropped_;       ///< number of data dropped for being too old
+        Scalar compression_threshold_;      ///< norm of a delta under which consecutive motions are merged
+        Size max_buffer_length_;            ///< maximum number of motions in the buffer
+        std::list<FrameBase*> pending_keyframes_; ///< key frames newer than the last integrated data, sorted by time stamp
 
     protected:
         // helpers to avoid allocation
@@ -330,7 +443,7 @@ class ProcessorMotion : public ProcessorBase
 
 inline ProcessorMotion::ProcessorMotion(ProcessorType _tp, size_t _state_size, size_t _delta_size, size_t _data_size) :
         ProcessorBase(_tp), x_size_(_state_size), delta_size_(_delta_size), data_size_(_data_size), origin_ptr_(
-                nullptr), last_ptr_(nullptr), incoming_ptr_(nullptr), dt_(0.0), x_(_state_size), delta_(_delta_size), delta_cov_(
+                nullptr), last_ptr_(nullptr), incoming_ptr_(nullptr), ts_start_(0.0), n_integrated_(0), max_delay_(std::numeric_limits<Scalar>::max()), n_dropped_(0), compression_threshold_(0), max_buffer_length_(0), dt_(0.0), x_(_state_size), delta_(_delta_size), delta_cov_(
                 delta_size_, delta_size_), delta_integrated_(_delta_size), delta_integrated_cov_(delta_size_,
                                                                                                  delta_size_), data_(
                 _data_size), jacobian_prev_(delta_size_, delta_size_), jacobian_curr_(delta_size_, delta_size_)
@@ -377,6 +490,11 @@ inline void ProcessorMotion::setOrigin(FrameBase* _origin_frame)
 {
     assert(_origin_frame->isKey() && "ProcessorMotion::setOrigin: origin frame must be KEY FRAME.");
 
+    // restart data rate estimation
+    ts_start_ = _origin_frame->getTimeStamp();
+    n_integrated_ = 0;
+    pending_keyframes_.clear();
+
     // make (empty) origin Capture
     origin_ptr_ = new CaptureMotion2(_origin_frame->getTimeStamp(), this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
                                      Eigen::MatrixXs::Zero(data_size_, data_size_));
@@ -404,13 +522,39 @@ inline void ProcessorMotion::process(CaptureBase* _incoming_ptr)
     postProcess();
 }
 
+inline void ProcessorMotion::process(const std::vector<TimeStamp>& _ts_list,
+                                     const Eigen::Ref<const Eigen::MatrixXs>& _data, const Eigen::MatrixXs& _data_cov)
+{
+    assert(_data.rows() == (Size)_ts_list.size() && "Wrong number of data samples");
+    assert(_data.cols() == data_size_ && "Wrong _data size");
+    assert(_data_cov.rows() == data_size_ && _data_cov.cols() == data_size_ && "Wrong _data_cov size");
+
+    for (std::size_t i = 0; i < _ts_list.size(); i++)
+    {
+        data_ = _data.row(i).transpose(); // no allocation: data_ already has the right size
+        integrate(_ts_list[i], data_, _data_cov);
+    }
+}
+
 inline void ProcessorMotion::integrate()
 {
+    integrate(incoming_ptr_->getTimeStamp(), incoming_ptr_->getData(), incoming_ptr_->getDataCovariance());
+}
+
+inline void ProcessorMotion::integrate(const TimeStamp& _ts, const Eigen::VectorXs& _data,
+                                       const Eigen::MatrixXs& _data_cov)
+{
+    if (_ts < getBufferPtr()->get().back().ts_)
+    {
+        integrateDelayed(_ts, _data, _data_cov);
+        return;
+    }
+
     // Set dt
-    updateDt();
+    updateDt(_ts);
 
     // get data and convert it to delta
-    data2delta(incoming_ptr_->getData(), incoming_ptr_->getDataCovariance(), dt_, delta_, delta_cov_);
+    data2delta(_data, _data_cov, dt_, delta_, delta_cov_);
 
     // then integrate delta
     deltaPlusDelta(getBufferPtr()->get().back().delta_integr_, delta_, delta_integrated_, jacobian_prev_,
@@ -423,13 +567,19 @@ inline void ProcessorMotion::integrate()
     //std::cout << delta_integrated_cov_ << std::endl;
 
         // then push it into buffer
-    getBufferPtr()->get().push_back(Motion( {incoming_ptr_->getTimeStamp(),
+    getBufferPtr()->get().push_back(Motion( {_ts,
                                              delta_,
                                              delta_integrated_,
                                              delta_cov_,
                                              delta_integrated_cov_,
                                              Eigen::MatrixXs::Zero(delta_size_, delta_size_),
                                              Eigen::MatrixXs::Zero(delta_size_, delta_size_)}));
+    n_integrated_++;
+
+    // the data may have reached some key frames of other processors
+    splitPendingKeyFrames();
+
+    compressBuffer();
 
     //std::cout << "motion integrated: " << getBufferPtr()->get().size()-1 << std::endl;
     //std::cout << "\tts: " << getBufferPtr()->get().back().ts_.getSeconds() << "." << getBufferPtr()->get().back().ts_.getNanoSeconds() << std::endl;
@@ -437,6 +587,44 @@ inline void ProcessorMotion::integrate()
     //std::cout << "\tx_integrated_: " << x_.transpose() << std::endl;
 }
 
+inline void ProcessorMotion::integrateDelayed(const TimeStamp& _ts, const Eigen::VectorXs& _data,
+                                              const Eigen::MatrixXs& _data_cov)
+{
+    std::list<Motion>& buffer = getBufferPtr()->get();
+
+    // Data before the origin belongs to an already closed key frame, and too old data would cost too much to reintegrate
+    if (_ts <= buffer.front().ts_ || buffer.back().ts_ - _ts > max_delay_)
+    {
+        n_dropped_++;
+        return;
+    }
+
+    // find the first motion after the delayed data
+    auto next_it = std::find_if(buffer.begin(), buffer.end(), [&](const Motion& m)
+    {
+        return _ts < m.ts_;
+    });
+
+    // convert the data to delta, with the time step since the previous motion
+    dt_ = _ts - std::prev(next_it)->ts_;
+    data2delta(_data, _data_cov, dt_, delta_, delta_cov_);
+
+    // insert it before the next motion (integrals are computed by reintegrate())
+    auto motion_it = buffer.insert(next_it, Motion( {_ts,
+                                                      delta_,
+                                                      delta_,
+                                                      delta_cov_,
+                                                      delta_cov_,
+                                                      Eigen::MatrixXs::Zero(delta_size_, delta_size_),
+                                                      Eigen::MatrixXs::Zero(delta_size_, delta_size_)}));
+    n_integrated_++;
+
+    // reintegrate only from the inserted motion on
+    reintegrate(motion_it);
+
+    compressBuffer();
+}
+
 inline void ProcessorMotion::reintegrate()
 {
     //std::cout << "ProcessorMotion::reintegrate" << std::endl;
@@ -450,17 +638,22 @@ inline void ProcessorMotion::reintegrate()
 
     this->getBufferPtr()->get().push_front(zero_motion);
 
-    auto motion_it = getBufferPtr()->get().begin();
-    auto prev_motion_it = motion_it;
-    motion_it++;
+    reintegrate(std::next(getBufferPtr()->get().begin()));
+}
+
+inline void ProcessorMotion::reintegrate(std::list<Motion>::iterator _motion_it)
+{
+    assert(_motion_it != getBufferPtr()->get().begin() && "Cannot reintegrate from the first motion in the buffer");
+
+    auto motion_it = _motion_it;
+    auto prev_motion_it = std::prev(motion_it);
 
-    Eigen::MatrixXs jacobian_prev(delta_size_, delta_size_), jacobian_curr(delta_size_, delta_size_);
     while (motion_it != getBufferPtr()->get().end())
     {
-        deltaPlusDelta(prev_motion_it->delta_integr_, motion_it->delta_, motion_it->delta_integr_, jacobian_prev,
-                       jacobian_curr);
+        deltaPlusDelta(prev_motion_it->delta_integr_, motion_it->delta_, motion_it->delta_integr_, jacobian_prev_,
+                       jacobian_curr_);
         //std::cout << "delta reintegrated" << std::endl;
-        deltaCovPlusDeltaCov(prev_motion_it->delta_integr_cov_, motion_it->delta_cov_, jacobian_prev, jacobian_curr,
+        deltaCovPlusDeltaCov(prev_motion_it->delta_integr_cov_, motion_it->delta_cov_, jacobian_prev_, jacobian_curr_,
                              motion_it->delta_integr_cov_);
         //std::cout << "delta_cov reintegrated" << std::endl;
 
@@ -474,12 +667,86 @@ inline void ProcessorMotion::reintegrate()
     }
 }
 
+inline void ProcessorMotion::compressBuffer()
+{
+    std::list<Motion>& buffer = getBufferPtr()->get();
+
+    // The first motion (the origin) and the last one (the current one) are never removed.
+
+    // merge the last motion with its predecessor if the composed motion is small
+    if (compression_threshold_ > 0 && buffer.size() > 2)
+    {
+        auto prev_it = std::prev(buffer.end(), 2);
+        deltaPlusDelta(prev_it->delta_, buffer.back().delta_, delta_);
+        if ((delta_ - deltaZero()).norm() < compression_threshold_)
+            mergeMotions(prev_it);
+    }
+
+    // merge the oldest motions until the buffer is short enough
+    while (max_buffer_length_ > 0 && buffer.size() > std::max<std::size_t>(max_buffer_length_, 2))
+        mergeMotions(std::next(buffer.begin()));
+}
+
+inline void ProcessorMotion::mergeMotions(std::list<Motion>::iterator _motion_it)
+{
+    auto next_it = std::next(_motion_it);
+    assert(_motion_it != getBufferPtr()->get().begin() && next_it != getBufferPtr()->get().end()
+           && "Can only merge motions in the middle of the buffer");
+
+    // compose deltas: next = this (+) next. The integrated delta and covariance of next do not change.
+    deltaPlusDelta(_motion_it->delta_, next_it->delta_, delta_, jacobian_prev_, jacobian_curr_);
+    deltaCovPlusDeltaCov(_motion_it->delta_cov_, next_it->delta_cov_, jacobian_prev_, jacobian_curr_, delta_cov_);
+    next_it->delta_ = delta_;
+    next_it->delta_cov_ = delta_cov_;
+
+    getBufferPtr()->get().erase(_motion_it);
+}
+
 inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
 {
     //std::cout << "ProcessorMotion::keyFrameCallback: ts = " << _keyframe_ptr->getTimeStamp().getSeconds() << "." << _keyframe_ptr->getTimeStamp().getNanoSeconds() << std::endl;
     //std::cout << "\tnew keyframe " << _keyframe_ptr->id() << ": " << _keyframe_ptr->getState().transpose() << std::endl;
     //std::cout << "\torigin keyframe " << origin_ptr_->getFramePtr()->id() << std::endl;
 
+    // The data has not reached the key frame yet: split when it does
+    if (!pending_keyframes_.empty() || getBufferPtr()->get().back().ts_ < _keyframe_ptr->getTimeStamp())
+    {
+        auto next_it = std::find_if(pending_keyframes_.begin(), pending_keyframes_.end(), [&](FrameBase* _frame_ptr)
+        {
+            return _keyframe_ptr->getTimeStamp() < _frame_ptr->getTimeStamp();
+        });
+        pending_keyframes_.insert(next_it, _keyframe_ptr);
+        splitPendingKeyFrames();
+        return true;
+    }
+
+    splitAtKeyFrame(_keyframe_ptr);
+    return true;
+}
+
+inline void ProcessorMotion::keyFrameRemovedCallback(FrameBase* _keyframe_ptr)
+{
+    pending_keyframes_.remove(_keyframe_ptr);
+}
+
+inline Size ProcessorMotion::getNumPendingKeyFrames() const
+{
+    return pending_keyframes_.size();
+}
+
+inline void ProcessorMotion::splitPendingKeyFrames()
+{
+    while (!pending_keyframes_.empty()
+            && pending_keyframes_.front()->getTimeStamp() <= getBufferPtr()->get().back().ts_)
+    {
+        FrameBase* keyframe_ptr = pending_keyframes_.front();
+        pending_keyframes_.pop_front();
+        splitAtKeyFrame(keyframe_ptr);
+    }
+}
+
+inline void ProcessorMotion::splitAtKeyFrame(FrameBase* _keyframe_ptr)
+{
     // get time stamp
     TimeStamp ts = _keyframe_ptr->getTimeStamp();
     // create motion capture
@@ -493,8 +760,12 @@ inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Sc
     splitBuffer(ts, *(key_capture_ptr->getBufferPtr()));
 
     // interpolate individual delta
+    // If the last data is exactly at the key frame time stamp, the new buffer is empty
+    // and we hold the last Motion of the old buffer.
+    Motion& motion_after = getBufferPtr()->get().empty() ? key_capture_ptr->getBufferPtr()->get().back() :
+                                                           getBufferPtr()->get().front();
     Motion mot = interpolate(key_capture_ptr->getBufferPtr()->get().back(), // last Motion of old buffer
-                             getBufferPtr()->get().front(), // first motion of new buffer
+                             motion_after, // first motion of new buffer
                              ts);
 
     // add to old buffer
@@ -517,8 +788,6 @@ inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Sc
 
     // reintegrate own buffer
     reintegrate();
-
-    return true;
 }
 
 inline void ProcessorMotion::splitBuffer(const TimeStamp& _t_split, MotionBuffer& _oldest_part)
@@ -613,9 +882,47 @@ inline bool ProcessorMotion::isMotion()
     return true;
 }
 
+inline bool ProcessorMotion::isOriginSet() const
+{
+    return origin_ptr_ != nullptr;
+}
+
+inline void ProcessorMotion::setMaxDelay(const Scalar& _max_delay)
+{
+    max_delay_ = _max_delay;
+}
+
+inline unsigned long int ProcessorMotion::getNumDropped() const
+{
+    return n_dropped_;
+}
+
+inline void ProcessorMotion::setBufferCompressionThreshold(const Scalar& _delta_norm_threshold)
+{
+    compression_threshold_ = _delta_norm_threshold;
+}
+
+inline void ProcessorMotion::setMaxBufferLength(const Size& _max_buffer_length)
+{
+    max_buffer_length_ = _max_buffer_length;
+}
+
+inline Scalar ProcessorMotion::getRate() const
+{
+    if (n_integrated_ == 0)
+        return 0;
+    Scalar period = getBufferPtr()->get().back().ts_ - ts_start_;
+    return (period > 0 ? n_integrated_ / period : 0);
+}
+
 inline void ProcessorMotion::updateDt()
 {
-    dt_ = incoming_ptr_->getTimeStamp() - getBufferPtr()->get().back().ts_;
+    updateDt(incoming_ptr_->getTimeStamp());
+}
+
+inline void ProcessorMotion::updateDt(const TimeStamp& _ts)
+{
+    dt_ = _ts - getBufferPtr()->get().back().ts_;
 }
 
 inline const MotionBuffer* ProcessorMotion::getBufferPtr() const
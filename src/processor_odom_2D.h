@@ -26,12 +26,14 @@ class ProcessorOdom2D : public ProcessorMotion
 //        virtual void preProcess(){}
 //        virtual void postProcess(){}
 
-    private:
         void xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, Eigen::VectorXs& _x_plus_delta);
         void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, Eigen::VectorXs& _delta1_plus_delta2);
         void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
                             Eigen::VectorXs& _delta1_plus_delta2, Eigen::MatrixXs& _jacobian1,
                             Eigen::MatrixXs& _jacobian2);
+        virtual void deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1, const Eigen::MatrixXs& _delta_cov2,
+                                          const Eigen::MatrixXs& _jacobian1, const Eigen::MatrixXs& _jacobian2,
+                                          Eigen::MatrixXs& _delta_cov1_plus_delta_cov2);
         virtual void deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
                                      Eigen::VectorXs& _delta2_minus_delta1);
         Eigen::VectorXs deltaZero() const;
@@ -71,7 +73,7 @@ inline void ProcessorOdom2D::data2delta(const Eigen::VectorXs& _data, const Eige
     _delta(2) = _data(1);
 
     // Fill delta covariance
-    Eigen::MatrixXs J(3,2);
+    Eigen::Matrix<Scalar, 3, 2> J;
     J(0,0) = cos(_data(1) / 2);
     J(1,0) = sin(_data(1) / 2);
     J(2,0) = 0;
@@ -79,7 +81,7 @@ inline void ProcessorOdom2D::data2delta(const Eigen::VectorXs& _data, const Eige
     J(1,1) = _data(0) / 2 * cos(_data(1) / 2);
     J(2,1) = 1;
 
-    _delta_cov = J * _data_cov * J.transpose();
+    _delta_cov = J * Eigen::Map<const Eigen::Matrix2s>(_data_cov.data()) * J.transpose();
 
     //std::cout << "data cov:" << std::endl << _data_cov << std::endl;
     //std::cout << "delta cov:" << std::endl << _delta_cov << std::endl;
@@ -144,17 +146,46 @@ inline void ProcessorOdom2D::deltaPlusDelta(const Eigen::VectorXs& _delta1, cons
     _delta1_plus_delta2.head<2>() = _delta1.head<2>() + Eigen::Rotation2Ds(_delta1(2)).matrix() * _delta2.head<2>();
     _delta1_plus_delta2(2) = _delta1(2) + _delta2(2);
 
-    // TODO: fill the jacobians
-    _jacobian1 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
+    // Jacobians have the structure
+    //   J1 = [I a ; 0 1],  J2 = [R 0 ; 0 1]
+    // with a = dR(th1)/dth1 * p2, and R = R(th1). See deltaCovPlusDeltaCov().
+    _jacobian1.setIdentity();
     _jacobian1(0,2) = -sin(_delta1(2))*_delta2(0) - cos(_delta1(2))*_delta2(1);
     _jacobian1(1,2) =  cos(_delta1(2))*_delta2(0) - sin(_delta1(2))*_delta2(1);
-    _jacobian2 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
+    _jacobian2.setIdentity();
     _jacobian2.topLeftCorner<2,2>() = Eigen::Rotation2Ds(_delta1(2)).matrix();
 
     //std::cout << "-----------------------------------------------" << std::endl;
     //std::cout << "_delta1_plus_delta2: " << _delta1_plus_delta2.transpose() << std::endl;
 }
 
+inline void ProcessorOdom2D::deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1, const Eigen::MatrixXs& _delta_cov2,
+                                                  const Eigen::MatrixXs& _jacobian1, const Eigen::MatrixXs& _jacobian2,
+                                                  Eigen::MatrixXs& _delta_cov1_plus_delta_cov2)
+{
+    assert(_delta_cov1.rows() == 3 && _delta_cov1.cols() == 3 && "Wrong _delta_cov1 size");
+    assert(_delta_cov2.rows() == 3 && _delta_cov2.cols() == 3 && "Wrong _delta_cov2 size");
+    assert(_delta_cov1_plus_delta_cov2.rows() == 3 && _delta_cov1_plus_delta_cov2.cols() == 3 && "Wrong _delta_cov1_plus_delta_cov2 size");
+
+    // Closed form of J1*P1*J1' + J2*P2*J2', with J1 = [I a ; 0 1] and J2 = [R 0 ; 0 1] (see deltaPlusDelta()).
+    // Blocks are named after the position (p) and orientation (o) components.
+    Eigen::Map<const Eigen::Matrix3s> P1(_delta_cov1.data());
+    Eigen::Map<const Eigen::Matrix3s> P2(_delta_cov2.data());
+    Eigen::Map<Eigen::Matrix3s> P(_delta_cov1_plus_delta_cov2.data());
+    const Eigen::Vector2s a = _jacobian1.block<2,1>(0,2);
+    const Eigen::Matrix2s R = _jacobian2.topLeftCorner<2,2>();
+
+    // orientation part is additive
+    const Eigen::Vector2s P1_po_plus_a_P1_oo = P1.block<2,1>(0,2) + a * P1(2,2);
+    const Eigen::Vector2s R_P2_po = R * P2.block<2,1>(0,2);
+
+    P.topLeftCorner<2,2>() = P1.topLeftCorner<2,2>() + a * P1.block<1,2>(2,0) + P1_po_plus_a_P1_oo * a.transpose()
+            + R * P2.topLeftCorner<2,2>() * R.transpose();
+    P.block<2,1>(0,2) = P1_po_plus_a_P1_oo + R_P2_po;
+    P.block<1,2>(2,0) = P.block<2,1>(0,2).transpose();
+    P(2,2) = P1(2,2) + P2(2,2);
+}
+
 inline void ProcessorOdom2D::deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
                                              Eigen::VectorXs& _delta2_minus_delta1)
 {
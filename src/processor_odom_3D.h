@@ -34,6 +34,10 @@ namespace wolf {
  * The processor integrates data by ignoring the time increment dt_
  * (as it integrates motion directly, not velocities).
  *
+ * Covariances are propagated to first order using closed-form Jacobians of the composition
+ * with respect to the quaternion components, so that all covariances are 7x7 matrices in the delta space.
+ * The Jacobians are block-sparse, and deltaCovPlusDeltaCov() exploits this structure.
+ *
  * All frames are assumed FLU (front, left, up).
  */
 class ProcessorOdom3D : public ProcessorMotion
@@ -48,12 +52,14 @@ class ProcessorOdom3D : public ProcessorMotion
 //        virtual void preProcess(){}
 //        virtual void postProcess(){}
 
-    private:
         void xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, Eigen::VectorXs& _x_plus_delta);
         void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, Eigen::VectorXs& _delta1_plus_delta2);
         void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
                             Eigen::VectorXs& _delta1_plus_delta2, Eigen::MatrixXs& _jacobian1,
                             Eigen::MatrixXs& _jacobian2);
+        virtual void deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1, const Eigen::MatrixXs& _delta_cov2,
+                                          const Eigen::MatrixXs& _jacobian1, const Eigen::MatrixXs& _jacobian2,
+                                          Eigen::MatrixXs& _delta_cov1_plus_delta_cov2);
         virtual void deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
                                      Eigen::VectorXs& _delta2_minus_delta1);
         Eigen::VectorXs deltaZero() const;
@@ -68,6 +74,10 @@ class ProcessorOdom3D : public ProcessorMotion
         Eigen::Map<Eigen::Quaternions> q_out_;
         void remap(const Eigen::VectorXs& _x1, const Eigen::VectorXs& _x2, Eigen::VectorXs& _x_out);
 
+        /** \brief skew-symmetric matrix such that skew(a)*b = a x b
+         */
+        static Eigen::Matrix3s skew(const Eigen::Vector3s& _v);
+
     // Factory method
     public:
         static ProcessorBase* create(const std::string& _unique_name, const ProcessorParamsBase* _params);
@@ -93,12 +103,41 @@ inline ProcessorOdom3D::~ProcessorOdom3D()
 inline void ProcessorOdom3D::data2delta(const Eigen::VectorXs& _data, const Eigen::MatrixXs& _data_cov, const Scalar _dt,
                                         Eigen::VectorXs& _delta, Eigen::MatrixXs& _delta_cov)
 {
+    assert(_data.size() == 6 && "Wrong _data vector size");
+    assert(_data_cov.rows() == 6 && _data_cov.cols() == 6 && "Wrong _data_cov size");
+    assert(_delta.size() == 7 && "Wrong _delta vector size");
+    assert(_delta_cov.rows() == 7 && _delta_cov.cols() == 7 && "Wrong _delta_cov size");
+
     _delta.head(3) = _data.head(3);
     new (&q_out_) Eigen::Map<Eigen::Quaternions>(_delta.data() + 3);
 
-    Eigen::v2q(_data.tail(3), q_out_);
-    // TODO: fill delta covariance
-    _delta_cov = Eigen::MatrixXs::Identity(delta_size_, delta_size_) * 0.01;
+    const Eigen::Vector3s v = _data.tail<3>();
+    Eigen::v2q(v, q_out_);
+
+    // Jacobian of the quaternion q = [sin(th/2)*v/th , cos(th/2)] wrt. the rotation vector v, with th = |v|
+    Eigen::Matrix<Scalar, 4, 3> Jq;
+    Scalar angle = v.norm();
+    if (angle < Constants::EPS)
+    {
+        Jq.topRows<3>() = 0.5 * Eigen::Matrix3s::Identity();
+        Jq.bottomRows<1>() = -0.25 * v.transpose();
+    }
+    else
+    {
+        Scalar s = sin(angle / 2), c = cos(angle / 2);
+        Scalar sinc = s / angle; // sin(th/2)/th
+        Scalar dsinc = (0.5 * c - sinc) / (angle * angle); // d(sinc)/dth / th
+        Jq.topRows<3>() = sinc * Eigen::Matrix3s::Identity() + dsinc * v * v.transpose();
+        Jq.bottomRows<1>() = -0.5 * sinc * v.transpose();
+    }
+
+    // delta_cov = J * data_cov * J', with J = [I 0 ; 0 Jq]
+    Eigen::Map<const Eigen::Matrix<Scalar, 6, 6, Eigen::RowMajor> > Q(_data_cov.data());
+    Eigen::Map<Eigen::Matrix7s> P(_delta_cov.data());
+    P.topLeftCorner<3,3>() = Q.topLeftCorner<3,3>();
+    P.topRightCorner<3,4>() = Q.topRightCorner<3,3>() * Jq.transpose();
+    P.bottomLeftCorner<4,3>() = P.topRightCorner<3,4>().transpose();
+    P.bottomRightCorner<4,4>() = Jq * Q.bottomRightCorner<3,3>() * Jq.transpose();
 }
 
 inline void ProcessorOdom3D::xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, Eigen::VectorXs& _x_plus_delta)
@@ -131,15 +170,66 @@ inline void ProcessorOdom3D::deltaPlusDelta(const Eigen::VectorXs& _delta1, cons
     assert(_delta1.size() == 7 && "Wrong _delta1 vector size");
     assert(_delta2.size() == 7 && "Wrong _delta2 vector size");
     assert(_delta1_plus_delta2.size() == 7 && "Wrong _delta1_plus_delta2 vector size");
-    // TODO: assert sizes of jacobians
+    assert(_jacobian1.rows() == 7 && _jacobian1.cols() == 7 && "Wrong _jacobian1 size");
+    assert(_jacobian2.rows() == 7 && _jacobian2.cols() == 7 && "Wrong _jacobian2 size");
 
     remap(_delta1, _delta2, _delta1_plus_delta2);
     p_out_ = p1_ + q1_ * p2_;
     q_out_ = q1_ * q2_;
 
-    // TODO: fill the jacobians
-    _jacobian1 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
-    _jacobian2 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
+    // Jacobians have the structure
+    //   J1 = [I A ; 0 B],  J2 = [R 0 ; 0 C]
+    // with A = d(q1*p2)/dq1, B = d(q1*q2)/dq1, R = R(q1), and C = d(q1*q2)/dq2.
+    // Quaternions are in Eigen's storage order (x, y, z, w). See deltaCovPlusDeltaCov().
+    const Eigen::Vector4s& q1 = q1_.coeffs();
+    const Eigen::Vector4s& q2 = q2_.coeffs();
+    const Eigen::Vector3s v1 = q1.head<3>(), v2 = q2.head<3>(), p2 = p2_;
+    const Scalar w1 = q1(3), w2 = q2(3);
+
+    _jacobian1.setZero();
+    _jacobian1.topLeftCorner<3,3>().setIdentity();
+    _jacobian1.block<3,3>(0,3) = 2 * (-w1 * skew(p2) + v1.dot(p2) * Eigen::Matrix3s::Identity() + v1 * p2.transpose()
+                                      - 2 * p2 * v1.transpose());
+    _jacobian1.block<3,1>(0,6) = 2 * v1.cross(p2);
+    _jacobian1.block<3,3>(3,3) = w2 * Eigen::Matrix3s::Identity() - skew(v2);
+    _jacobian1.block<3,1>(3,6) = v2;
+    _jacobian1.block<1,3>(6,3) = -v2.transpose();
+    _jacobian1(6,6) = w2;
+
+    _jacobian2.setZero();
+    _jacobian2.topLeftCorner<3,3>() = q1_.matrix();
+    _jacobian2.block<3,3>(3,3) = w1 * Eigen::Matrix3s::Identity() + skew(v1);
+    _jacobian2.block<3,1>(3,6) = v1;
+    _jacobian2.block<1,3>(6,3) = -v1.transpose();
+    _jacobian2(6,6) = w1;
+}
+
+inline void ProcessorOdom3D::deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1, const Eigen::MatrixXs& _delta_cov2,
+                                                  const Eigen::MatrixXs& _jacobian1, const Eigen::MatrixXs& _jacobian2,
+                                                  Eigen::MatrixXs& _delta_cov1_plus_delta_cov2)
+{
+    assert(_delta_cov1.rows() == 7 && _delta_cov1.cols() == 7 && "Wrong _delta_cov1 size");
+    assert(_delta_cov2.rows() == 7 && _delta_cov2.cols() == 7 && "Wrong _delta_cov2 size");
+    assert(_delta_cov1_plus_delta_cov2.rows() == 7 && _delta_cov1_plus_delta_cov2.cols() == 7 && "Wrong _delta_cov1_plus_delta_cov2 size");
+
+    // Closed form of J1*P1*J1' + J2*P2*J2', with J1 = [I A ; 0 B] and J2 = [R 0 ; 0 C] (see deltaPlusDelta()).
+    // Blocks are named after the position (p) and quaternion (q) components.
+    Eigen::Map<const Eigen::Matrix7s> P1(_delta_cov1.data());
+    Eigen::Map<const Eigen::Matrix7s> P2(_delta_cov2.data());
+    Eigen::Map<Eigen::Matrix7s> P(_delta_cov1_plus_delta_cov2.data());
+    const Eigen::Matrix<Scalar, 3, 4> A = _jacobian1.block<3,4>(0,3);
+    const Eigen::Matrix4s B = _jacobian1.block<4,4>(3,3);
+    const Eigen::Matrix3s R = _jacobian2.topLeftCorner<3,3>();
+    const Eigen::Matrix4s C = _jacobian2.block<4,4>(3,3);
+
+    const Eigen::Matrix<Scalar, 3, 4> P1_pq_plus_A_P1_qq = P1.topRightCorner<3,4>() + A * P1.bottomRightCorner<4,4>();
+
+    P.topLeftCorner<3,3>() = P1.topLeftCorner<3,3>() + A * P1.bottomLeftCorner<4,3>()
+            + P1_pq_plus_A_P1_qq * A.transpose() + R * P2.topLeftCorner<3,3>() * R.transpose();
+    P.topRightCorner<3,4>() = P1_pq_plus_A_P1_qq * B.transpose() + R * P2.topRightCorner<3,4>() * C.transpose();
+    P.bottomLeftCorner<4,3>() = P.topRightCorner<3,4>().transpose();
+    P.bottomRightCorner<4,4>() = B * P1.bottomRightCorner<4,4>() * B.transpose()
+            + C * P2.bottomRightCorner<4,4>() * C.transpose();
 }
 
 inline void ProcessorOdom3D::deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
@@ -183,6 +273,15 @@ inline void ProcessorOdom3D::remap(const Eigen::VectorXs& _x1, const Eigen::Vect
     new (&q_out_) Eigen::Map<Eigen::Quaternions>(_x_out.data() + 3);
 }
 
+inline Eigen::Matrix3s ProcessorOdom3D::skew(const Eigen::Vector3s& _v)
+{
+    Eigen::Matrix3s S;
+    S <<      0, -_v(2),  _v(1),
+          _v(2),      0, -_v(0),
+         -_v(1),  _v(0),      0;
+    return S;
+}
+
 } // namespace wolf
 
 #endif /* SRC_PROCESSOR_ODOM_3D_H_ */
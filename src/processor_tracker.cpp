@@ -12,7 +12,9 @@ namespace wolf
 
 ProcessorTracker::ProcessorTracker(ProcessorType _tp, const unsigned int _max_new_features, const Scalar& _time_tolerance) :
         ProcessorBase(_tp), origin_ptr_(nullptr), last_ptr_(nullptr), incoming_ptr_(nullptr),
-        max_new_features_(_max_new_features), time_tolerance_(_time_tolerance)
+        max_new_features_(_max_new_features), time_tolerance_(_time_tolerance),
+        min_track_ratio_(0), max_keyframe_period_(0), min_keyframe_period_(0), solver_time_(0),
+        time_budget_(0), tracking_time_(0), detection_cost_(0)
 {
     //
 }
@@ -66,7 +68,7 @@ void ProcessorTracker::process(CaptureBase* const _incoming_ptr)
             makeFrame(last_ptr_);
 
         // Detect new Features, initialize Landmarks, create Constraints, ...
-        processNew(max_new_features_);
+        processNewInBudget();
 
         // Make the last Capture's Frame a KeyFrame so that it gets into the solver
         if (!last_ptr_->getFramePtr()->isKey())
@@ -112,10 +114,11 @@ void ProcessorTracker::process(CaptureBase* const _incoming_ptr)
 
         // 1. First we track the known Features and create new constraints as needed
 
-        processKnown();
+        processKnownTimed();
 
         // 2. Then we see if we want and we are allowed to create a KeyFrame
-        if (!(voteForKeyFrame() && permittedKeyFrame()))
+        bool vote = (voteForKeyFrame() || voteForKeyFramePolicy()) && !vetoKeyFramePolicy();
+        if (!(vote && permittedKeyFrame()))
         {
             // We did not create a KeyFrame:
 
@@ -132,7 +135,7 @@ void ProcessorTracker::process(CaptureBase* const _incoming_ptr)
         else
         {
             // 2.b. Detect new Features, initialize Landmarks, create Constraints, ...
-            processNew(max_new_features_);
+            processNewInBudget();
 
             // Create a new non-key Frame in the Trajectory with the incoming Capture
             makeFrame(incoming_ptr_);
@@ -140,8 +143,9 @@ void ProcessorTracker::process(CaptureBase* const _incoming_ptr)
             // Make the last Capture's Frame a KeyFrame so that it gets into the solver
             last_ptr_->getFramePtr()->setKey();
 
-            // Set state to the keyframe
-            last_ptr_->getFramePtr()->setState(getProblem()->getStateAtTimeStamp(last_ptr_->getTimeStamp()));
+            // Set state to the keyframe, if a motion processor provides it
+            if (getProblem()->getProcessorMotionPtr() != nullptr)
+                last_ptr_->getFramePtr()->setState(getProblem()->getStateAtTimeStamp(last_ptr_->getTimeStamp()));
 
             // Establish constraints between last and origin
             establishConstraints();
@@ -193,7 +197,7 @@ bool ProcessorTracker::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar&
     _keyframe_ptr->addCapture(last_ptr_);
 
     // Detect new Features, initialize Landmarks, create Constraints, ...
-    processNew(max_new_features_);
+    processNewInBudget();
 
     // Establish constraints between last and origin
     establishConstraints();
@@ -204,5 +208,65 @@ bool ProcessorTracker::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar&
     return true;
 }
 
+bool ProcessorTracker::voteForKeyFramePolicy()
+{
+    // too few Features of origin tracked in incoming
+    if (min_track_ratio_ > 0 && !origin_ptr_->getFeatureListPtr()->empty()
+            && incoming_ptr_->getFeatureListPtr()->size() < min_track_ratio_ * origin_ptr_->getFeatureListPtr()->size())
+        return true;
+
+    // too long since the last KeyFrame
+    if (max_keyframe_period_ > 0 && last_ptr_->getTimeStamp() - origin_ptr_->getTimeStamp() >= max_keyframe_period_)
+        return true;
+
+    return false;
+}
+
+bool ProcessorTracker::vetoKeyFramePolicy()
+{
+    // the KeyFrame would be made at last: do not make them faster than allowed, nor faster than the solver
+    Scalar period = last_ptr_->getTimeStamp() - origin_ptr_->getTimeStamp();
+    return period < min_keyframe_period_ || period < solver_time_;
+}
+
+unsigned int ProcessorTracker::getMaxNewFeaturesInBudget() const
+{
+    if (time_budget_ <= 0 || detection_cost_ <= 0)
+        return max_new_features_;
+
+    // Note: 0 means 'no limit' to processNew(), so we always ask for at least one Feature.
+    Scalar time_left = time_budget_ - tracking_time_;
+    unsigned int n = (time_left > detection_cost_ ? (unsigned int)(time_left / detection_cost_) : 1);
+    if (max_new_features_ > 0 && n > max_new_features_)
+        n = max_new_features_;
+    return n;
+}
+
+unsigned int ProcessorTracker::processKnownTimed()
+{
+    TimeStamp t_start, t_end;
+    t_start.setToNow();
+    unsigned int n = processKnown();
+    t_end.setToNow();
+    tracking_time_ = t_end - t_start;
+    return n;
+}
+
+unsigned int ProcessorTracker::processNewInBudget()
+{
+    TimeStamp t_start, t_end;
+    t_start.setToNow();
+    unsigned int n = processNew(getMaxNewFeaturesInBudget());
+    t_end.setToNow();
+
+    // update the average detection cost per Feature
+    if (n > 0)
+    {
+        Scalar cost = (t_end - t_start) / n;
+        detection_cost_ = (detection_cost_ > 0 ? 0.5 * (detection_cost_ + cost) : cost);
+    }
+    return n;
+}
+
 } // namespace wolf
 
@@ -15,7 +15,11 @@ namespace wolf {
 
 struct ProcessorParamsTracker : public ProcessorParamsBase
 {
-        unsigned int max_new_features;
+        unsigned int max_new_features = 0;
+        Scalar min_track_ratio = 0;     ///< vote for KeyFrame when the ratio of Features of origin tracked in incoming is below this value. 0: disabled
+        Scalar max_keyframe_period = 0; ///< vote for KeyFrame when this time has passed since the last KeyFrame. 0: disabled
+        Scalar min_keyframe_period = 0; ///< never create KeyFrames closer in time than this
+        Scalar time_budget = 0;         ///< processing time per Capture, in seconds, to adapt the number of new Features. 0: disabled
 };
 
 /** \brief General tracker processor
@@ -62,6 +66,33 @@ struct ProcessorParamsTracker : public ProcessorParamsBase
  *   -  postProcess() { }
  *
  * which are called at the beginning and at the end of process(). See the doc of these functions for more info.
+ *
+ * ### Key frame policy and feature budget:
+ * On top of the derived voteForKeyFrame(), the tracker can apply a generic policy, see setKeyFramePolicy():
+ *   - vote for a KeyFrame if the ratio of Features of \b origin still tracked in \b incoming falls below a threshold,
+ *   - vote for a KeyFrame if too much time has passed since the last KeyFrame,
+ *   - veto any KeyFrame closer in time to the last one than a minimum period,
+ *     or than the duration of the last solver run (see setSolverTime()), so that KeyFrames
+ *     are not created faster than the solver can absorb them.
+ *
+ * With a time budget per Capture (see setTimeBudget()), the number of new Features requested to processNew()
+ * is adapted at each KeyFrame: the time left after tracking is divided by the measured cost of detecting one Feature.
+ * The result never exceeds max_new_features_, if this is set.
+ *
+ * All these options are disabled by default.
+ *
+ * ### Pipelined tracking:
+ * Captures can also be handed over from a sensor driver thread through ProcessorBase::enqueue().
+ * With ProcessorBase::startPipeline(), the tracker runs in two stages:
+ *   - front-end, on a worker thread: frontEnd() prepares each enqueued Capture on its own,
+ *     e.g. detecting and describing the features of the whole image, and caching them in the Capture.
+ *   - back-end, on the thread owning the Problem: process(), called by ProcessorBase::processQueue()
+ *     or Problem::processQueues(), tracks the prepared \b incoming, creates the KeyFrame and the constraints
+ *     of \b last, and calls back the other processors.
+ *
+ * So the detection on the next \b incoming overlaps with the constraint establishment for \b last,
+ * and the per-Capture latency is that of the slowest stage, not of their sum.
+ * The wolf tree is only modified by the back-end, and needs no locks.
  */
 class ProcessorTracker : public ProcessorBase
 {
@@ -74,6 +105,15 @@ class ProcessorTracker : public ProcessorBase
         unsigned int max_new_features_; ///< max features alowed to detect in one iteration. 0 = no limit
         Scalar time_tolerance_;         ///< self time tolerance for adding a capture into a frame
 
+        // Key frame policy and feature budget
+        Scalar min_track_ratio_;        ///< vote for KeyFrame below this ratio of tracked Features. 0: disabled
+        Scalar max_keyframe_period_;    ///< vote for KeyFrame after this time since the last KeyFrame. 0: disabled
+        Scalar min_keyframe_period_;    ///< veto KeyFrames before this time since the last KeyFrame
+        Scalar solver_time_;            ///< duration of the last solver run, see setSolverTime()
+        Scalar time_budget_;            ///< processing time per Capture. 0: disabled
+        Scalar tracking_time_;          ///< duration of the last processKnown()
+        Scalar detection_cost_;         ///< average duration of processNew() per new Feature
+
     public:
         ProcessorTracker(ProcessorType _tp, const unsigned int _max_new_features = 0, const Scalar& _time_tolerance = 0.1);
         virtual ~ProcessorTracker();
@@ -88,6 +128,33 @@ class ProcessorTracker : public ProcessorBase
         void setMaxNewFeatures(const unsigned int& _max_new_features);
         const unsigned int getMaxNewFeatures();
 
+        /** \brief Set the generic KeyFrame policy
+         * \param _min_track_ratio vote for KeyFrame when the ratio of Features of \b origin tracked in \b incoming is below this value. 0: disabled
+         * \param _max_keyframe_period vote for KeyFrame when this time has passed since the last KeyFrame. 0: disabled
+         * \param _min_keyframe_period veto KeyFrames closer in time than this to the last KeyFrame
+         */
+        void setKeyFramePolicy(const Scalar& _min_track_ratio, const Scalar& _max_keyframe_period, const Scalar& _min_keyframe_period = 0);
+
+        /** \brief Set the generic KeyFrame policy and the time budget from the tracker parameters
+         */
+        void setKeyFramePolicy(const ProcessorParamsTracker& _params);
+
+        /** \brief Set the processing time allowed per Capture, in seconds. 0: disabled
+         */
+        void setTimeBudget(const Scalar& _time_budget);
+
+        /** \brief Report the duration of the last solver run, in seconds.
+         *
+         * No KeyFrame is created closer in time to the last one than this duration.
+         */
+        void setSolverTime(const Scalar& _solver_time);
+
+        /** \brief Number of new Features to detect at the next KeyFrame, according to the time budget.
+         *
+         * Without time budget, or before any detection cost has been measured, this is max_new_features_.
+         */
+        unsigned int getMaxNewFeaturesInBudget() const;
+
         virtual bool keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _dt);
 
         virtual CaptureBase* getLastPtr();
@@ -163,6 +230,16 @@ class ProcessorTracker : public ProcessorBase
          */
         virtual unsigned int processNew(const unsigned int& _max_features) = 0;
 
+        /** \brief Generic KeyFrame votes, see setKeyFramePolicy()
+         * \return true if the policy votes for a KeyFrame at \b last.
+         */
+        bool voteForKeyFramePolicy();
+
+        /** \brief Generic KeyFrame veto, see setKeyFramePolicy() and setSolverTime()
+         * \return true if the policy forbids a KeyFrame at \b last.
+         */
+        bool vetoKeyFramePolicy();
+
         /**\brief Creates and adds constraints from last_ to origin_
          *
          */
@@ -176,6 +253,10 @@ class ProcessorTracker : public ProcessorBase
          */
         virtual void reset() = 0;
 
+    private:
+        unsigned int processKnownTimed();
+        unsigned int processNewInBudget();
+
     public:
 
         FeatureBaseList& getNewFeaturesListLast();
@@ -199,6 +280,30 @@ inline const unsigned int ProcessorTracker::getMaxNewFeatures()
     return max_new_features_;
 }
 
+inline void ProcessorTracker::setKeyFramePolicy(const Scalar& _min_track_ratio, const Scalar& _max_keyframe_period,
+                                                const Scalar& _min_keyframe_period)
+{
+    min_track_ratio_ = _min_track_ratio;
+    max_keyframe_period_ = _max_keyframe_period;
+    min_keyframe_period_ = _min_keyframe_period;
+}
+
+inline void ProcessorTracker::setKeyFramePolicy(const ProcessorParamsTracker& _params)
+{
+    setKeyFramePolicy(_params.min_track_ratio, _params.max_keyframe_period, _params.min_keyframe_period);
+    setTimeBudget(_params.time_budget);
+}
+
+inline void ProcessorTracker::setTimeBudget(const Scalar& _time_budget)
+{
+    time_budget_ = _time_budget;
+}
+
+inline void ProcessorTracker::setSolverTime(const Scalar& _solver_time)
+{
+    solver_time_ = _solver_time;
+}
+
 inline void ProcessorTracker::makeFrame(CaptureBase* _capture_ptr, FrameKeyType _type)
 {
     // We need to create the new free Frame to hold what will become the last Capture
@@ -180,12 +180,12 @@ inline void ProcessorTrackerFeature::advance()
     //    std::cout << "ProcessorTrackerFeature::advance()" << std::endl;
 
     // Compose correspondences to get origin_from_incoming
-    for (auto match : matches_last_from_incoming_)
-    {
-        matches_last_from_incoming_[match.first] =
-                matches_origin_from_last_[matches_last_from_incoming_[match.first].feature_ptr_];
-    }
-    matches_origin_from_last_ = std::move(matches_last_from_incoming_);
+    for (auto& match : matches_last_from_incoming_)
+        match.second = matches_origin_from_last_[match.second.feature_ptr_];
+
+    // Swap the tables, so that their memory is reused in the next frame
+    matches_origin_from_last_.swap(matches_last_from_incoming_);
+    matches_last_from_incoming_.clear();
 
     //    std::cout << "advanced correspondences: " << std::endl;
     //    std::cout << "\tincoming 2 last: " << matches_last_from_incoming_.size() << std::endl;
@@ -200,7 +200,8 @@ inline void ProcessorTrackerFeature::reset()
     //    std::cout << "ProcessorTrackerFeature::reset()" << std::endl;
 
     // We also reset here the list of correspondences, which passes from last--incoming to origin--last.
-    matches_origin_from_last_ = std::move(matches_last_from_incoming_);
+    matches_origin_from_last_.swap(matches_last_from_incoming_);
+    matches_last_from_incoming_.clear();
 }
 
 } // namespace wolf
@@ -11,7 +11,7 @@ namespace wolf
 {
 
 ProcessorTrackerLandmark::ProcessorTrackerLandmark(ProcessorType _tp, const unsigned int& _max_new_features) :
-    ProcessorTracker(_tp, _max_new_features)
+    ProcessorTracker(_tp, _max_new_features), landmark_search_range_(0)
 {
 }
 
@@ -93,8 +93,18 @@ unsigned int ProcessorTrackerLandmark::processKnown()
 
     // Find landmarks in incoming_ptr_
     FeatureBaseList known_features_list_incoming;
-    unsigned int found_landmarks = findLandmarks(*(getProblem()->getMapPtr()->getLandmarkListPtr()),
-                                                 known_features_list_incoming, matches_landmark_from_incoming_);
+    unsigned int found_landmarks;
+    if (landmark_search_range_ > 0)
+    {
+        // only the landmarks around the robot
+        LandmarkBaseList landmarks_in_range;
+        getProblem()->getMapPtr()->getLandmarksInRange(getProblem()->getStateAtTimeStamp(incoming_ptr_->getTimeStamp()),
+                                                       landmark_search_range_, landmarks_in_range);
+        found_landmarks = findLandmarks(landmarks_in_range, known_features_list_incoming, matches_landmark_from_incoming_);
+    }
+    else
+        found_landmarks = findLandmarks(*(getProblem()->getMapPtr()->getLandmarkListPtr()),
+                                        known_features_list_incoming, matches_landmark_from_incoming_);
     // Append found incoming features
     incoming_ptr_->addDownNodeList(known_features_list_incoming);
 
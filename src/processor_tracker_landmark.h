@@ -57,6 +57,10 @@ namespace wolf
  *   - establishConstraints() : which calls the pure virtual:
  *     - createConstraint() : create a Feature-Landmark constraint of the correct derived type <=== IMPLEMENT
  *
+ * If a search range is set (see setLandmarkSearchRange()), processKnown() only searches the Landmarks of the Map
+ * within this range of the current robot position, using the Map's spatial index (see MapBase::setLandmarkIndexCellSize()).
+ * The range should account for the sensor range, the sensor mounting offset and the gating distance.
+ *
  * Should you need extra functionality for your derived types, you can overload these two methods,
  *
  *   -  preProcess() { }
@@ -71,8 +75,14 @@ class ProcessorTrackerLandmark : public ProcessorTracker
         ProcessorTrackerLandmark(ProcessorType _tp, const unsigned int& _max_new_features = 0);
         virtual ~ProcessorTrackerLandmark();
 
+        /** \brief Search only the Landmarks within this range of the robot. 0: search the whole Map.
+         */
+        void setLandmarkSearchRange(const Scalar& _range);
+
     protected:
 
+        Scalar landmark_search_range_; ///< Range of the Landmarks searched by processKnown(). 0: all Landmarks
+
         LandmarkMatchMap matches_landmark_from_incoming_;
         LandmarkMatchMap matches_landmark_from_last_;
 
@@ -165,10 +175,16 @@ class ProcessorTrackerLandmark : public ProcessorTracker
 #include <utility>
 namespace wolf
 {
+inline void ProcessorTrackerLandmark::setLandmarkSearchRange(const Scalar& _range)
+{
+    landmark_search_range_ = _range;
+}
+
 inline void ProcessorTrackerLandmark::advance()
 {
     //std::cout << "ProcessorTrackerLandmark::advance" << std::endl;
-    matches_landmark_from_last_ = std::move(matches_landmark_from_incoming_);
+    matches_landmark_from_last_.swap(matches_landmark_from_incoming_);
+    matches_landmark_from_incoming_.clear();
 
     new_features_last_ = std::move(new_features_incoming_);
 
@@ -179,7 +195,8 @@ inline void ProcessorTrackerLandmark::advance()
 inline void ProcessorTrackerLandmark::reset()
 {
     //std::cout << "ProcessorTrackerLandmark::reset" << std::endl;
-    matches_landmark_from_last_ = std::move(matches_landmark_from_incoming_);
+    matches_landmark_from_last_.swap(matches_landmark_from_incoming_);
+    matches_landmark_from_incoming_.clear();
 
     new_features_last_ = std::move(new_features_incoming_);
 
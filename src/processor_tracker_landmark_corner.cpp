@@ -46,46 +46,68 @@ unsigned int ProcessorTrackerLandmarkCorner::findLandmarks(const LandmarkBaseLis
     //std::cout << "ProcessorTrackerLandmarkCorner::findLandmarks: " << _landmarks_corner_searched.size() << " features: " << corners_incoming_.size()  << std::endl;
 
     // NAIVE FIRST NEAREST NEIGHBOR MATCHING
-    LandmarkBaseList not_matched_landmarks = _landmarks_corner_searched;
-    Scalar dm2;
+    std::vector<LandmarkBase*> landmarks(_landmarks_corner_searched.begin(), _landmarks_corner_searched.end());
+    std::vector<bool> landmark_matched(landmarks.size(), false);
+    const unsigned int n_landmarks = landmarks.size();
 
     // COMPUTING ALL EXPECTED FEATURES
-    std::map<LandmarkBase*, Eigen::Vector4s> expected_features;
-    std::map<LandmarkBase*, Eigen::Matrix3s> expected_features_covs;
-    for (auto landmark : not_matched_landmarks)
-        expectedFeature(landmark, expected_features[landmark], expected_features_covs[landmark]);
+    expected_features_.resize(4, n_landmarks);
+    expected_features_covs_.resize(9, n_landmarks);
+    Eigen::Vector4s expected_feature;
+    Eigen::Matrix3s expected_feature_cov;
+    for (unsigned int j = 0; j < n_landmarks; j++)
+    {
+        expectedFeature(landmarks[j], expected_feature, expected_feature_cov);
+        expected_features_.col(j) = expected_feature;
+        Eigen::Map<Eigen::Matrix3s>(expected_features_covs_.col(j).data()) = expected_feature_cov;
+    }
+
+    // Squared Mahalanobis distances of each feature to all landmarks, computed in one batch
+    innovations_.resize(3, n_landmarks);
+    innovations_covs_.resize(6, n_landmarks);
+    squared_mahalanobis_distances_.resize(n_landmarks);
 
     auto next_feature_it = corners_incoming_.begin();
     auto feature_it = next_feature_it++;
     while (feature_it != corners_incoming_.end())
     {
-        LandmarkBaseIter closest_landmark = not_matched_landmarks.end();
+        const Eigen::VectorXs& measurement = (*feature_it)->getMeasurement();
+        const Eigen::Matrix3s feature_cov = (*feature_it)->getMeasurementCovariance().topLeftCorner<3, 3>();
+        for (unsigned int j = 0; j < n_landmarks; j++)
+        {
+            innovations_(0, j) = measurement(0) - expected_features_(0, j);
+            innovations_(1, j) = measurement(1) - expected_features_(1, j);
+            innovations_(2, j) = pi2pi(measurement(2) - expected_features_(2, j));
+            setBatchCovariance(innovations_covs_, j,
+                               feature_cov + Eigen::Map<const Eigen::Matrix3s>(expected_features_covs_.col(j).data()));
+        }
+        squaredMahalanobisDistances(innovations_, innovations_covs_, squared_mahalanobis_distances_);
+
+        int closest_landmark = -1;
         Scalar closest_dm2 = 1e3;
-        for (auto landmark_it = not_matched_landmarks.begin(); landmark_it != not_matched_landmarks.end(); landmark_it++)
+        for (unsigned int j = 0; j < n_landmarks; j++)
         {
-            if ((*landmark_it)->getType() == LANDMARK_CORNER &&
-                fabs(pi2pi(((FeatureCorner2D*)(*feature_it))->getAperture() - (*landmark_it)->getDescriptor(0))) < aperture_error_th_)
+            if (!landmark_matched[j] && landmarks[j]->getType() == LANDMARK_CORNER &&
+                fabs(pi2pi(((FeatureCorner2D*)(*feature_it))->getAperture() - landmarks[j]->getDescriptor(0))) < aperture_error_th_)
             {
-                dm2 = computeSquaredMahalanobisDistances((*feature_it), expected_features[*landmark_it],
-                                                         expected_features_covs[*landmark_it],
-                                                         Eigen::MatrixXs::Zero(3, 1))(0); //Mahalanobis squared
-                if (dm2 < 0.5 && (closest_landmark == not_matched_landmarks.end() || dm2 < closest_dm2))
+                Scalar dm2 = squared_mahalanobis_distances_(j); //Mahalanobis squared
+                if (dm2 < 0.5 && (closest_landmark < 0 || dm2 < closest_dm2))
                 {
-                    //std::cout << "pair feature " << (*feature_it)->id() << " & landmark " << (*landmark_it)->id() << std::endl;
+                    //std::cout << "pair feature " << (*feature_it)->id() << " & landmark " << landmarks[j]->id() << std::endl;
                     //std::cout << "pair SqMahalanobisDist = " << dm2 << std::endl;
                     closest_dm2 = dm2;
-                    closest_landmark = landmark_it;
+                    closest_landmark = j;
                 }
             }
         }
         //std::cout << "all landmarks checked with feature " << (*feature_it)->id() << std::endl;
-        if (closest_landmark != not_matched_landmarks.end())
+        if (closest_landmark >= 0)
         {
-            //std::cout << "closest landmark: " << (*closest_landmark)->id() << std::endl;
+            //std::cout << "closest landmark: " << landmarks[closest_landmark]->id() << std::endl;
             // match
-            matches_landmark_from_incoming_[*feature_it] = LandmarkMatch({*closest_landmark, closest_dm2});
-            // erase from the landmarks to be found
-            not_matched_landmarks.erase(closest_landmark);
+            matches_landmark_from_incoming_[*feature_it] = LandmarkMatch({landmarks[closest_landmark], closest_dm2});
+            // remove from the landmarks to be found
+            landmark_matched[closest_landmark] = true;
             // move corner feature to output list
             _features_corner_found.splice(_features_corner_found.end(), corners_incoming_, feature_it);
         }
@@ -123,6 +145,18 @@ unsigned int ProcessorTrackerLandmarkCorner::findLandmarks(const LandmarkBaseLis
         {
             features_map[ii] = feature_it;
             //std::cout << "Feature: " << (*i_it)->nodeId() << std::endl << (*i_it)->getMeasurement().head(3).transpose() << std::endl;
+            // squared Mahalanobis distances to all landmarks, computed in one batch
+            jj = 0;
+            for (auto landmark_it = _landmarks_corner_searched.begin(); landmark_it != _landmarks_corner_searched.end();
+                    landmark_it++, jj++)
+            {
+                innovations_(0, jj) = (*feature_it)->getMeasurement()(0) - expected_features[*landmark_it](0);
+                innovations_(1, jj) = (*feature_it)->getMeasurement()(1) - expected_features[*landmark_it](1);
+                innovations_(2, jj) = pi2pi((*feature_it)->getMeasurement()(2) - expected_features[*landmark_it](2));
+                setBatchCovariance(innovations_covs_, jj, (*feature_it)->getMeasurementCovariance().topLeftCorner<3, 3>()
+                                                          + expected_features_covs[*landmark_it]);
+            }
+            squaredMahalanobisDistances(innovations_, innovations_covs_, squared_mahalanobis_distances_);
             jj = 0;
             for (auto landmark_it = _landmarks_corner_searched.begin(); landmark_it != _landmarks_corner_searched.end();
                     landmark_it++, jj++)
@@ -137,9 +171,7 @@ unsigned int ProcessorTrackerLandmarkCorner::findLandmarks(const LandmarkBaseLis
                             pi2pi(((FeatureCorner2D*)(((*feature_it))))->getAperture()
                                     - (*landmark_it)->getDescriptor(0))) < aperture_error_th_)
                     {
-                        dm2 = computeSquaredMahalanobisDistances(*feature_it, expected_features[*landmark_it],
-                                                                 expected_features_covs[*landmark_it],
-                                                                 Eigen::MatrixXs::Zero(3, 1))(0); //Mahalanobis squared
+                        dm2 = squared_mahalanobis_distances_(jj); //Mahalanobis squared
                         //prob = (dm2 < 5 * 5 ? 5 * erfc(sqrt(dm2 / 2)) : 0); //prob = erfc( sqrt(dm2/2) ); //prob = erfc( sqrt(dm2)/1.4142136 );// sqrt(2) = 1.4142136
                         prob = 10*erfc( sqrt(dm2/2) );
                         if (dm2 < 0.5)
@@ -327,36 +359,6 @@ void ProcessorTrackerLandmarkCorner::expectedFeature(LandmarkBase* _landmark_ptr
         expected_feature_cov_ = Eigen::Matrix3s::Identity()*0.1;
 }
 
-Eigen::VectorXs ProcessorTrackerLandmarkCorner::computeSquaredMahalanobisDistances(const FeatureBase* _feature_ptr,
-                                                                          const Eigen::Vector4s& _expected_feature,
-                                                                          const Eigen::Matrix3s& _expected_feature_cov,
-                                                                          const Eigen::MatrixXs& _mu)
-{
-
-    const Eigen::Vector2s& p_feature = _feature_ptr->getMeasurement().head(2);
-    const Scalar& o_feature = _feature_ptr->getMeasurement()(2);
-    // ------------------------ d
-    Eigen::Vector3s d;
-    d.head(2) = p_feature - _expected_feature.head(2);
-    d(2) = pi2pi(o_feature - _expected_feature(2));
-    // ------------------------ Sigma_d
-    Eigen::Matrix3s iSigma_d =
-            (_feature_ptr->getMeasurementCovariance().topLeftCorner<3, 3>() + _expected_feature_cov).inverse();
-    Eigen::VectorXs squared_mahalanobis_distances(_mu.cols());
-    for (unsigned int i = 0; i < _mu.cols(); i++)
-    {
-        squared_mahalanobis_distances(i) = (d - _mu.col(i)).transpose() * iSigma_d * (d - _mu.col(i));
-        //if ((d - _mu.col(i)).norm() < 1)
-        //{
-        //    std::cout << "distance:    " << (d - _mu.col(i)).norm() << std::endl;
-        //    std::cout << "iSigma_d:    " << std::endl << iSigma_d << std::endl;
-        //    std::cout << "mahalanobis: " << squared_mahalanobis_distances(i) << std::endl;
-        //}
-    }
-
-    return squared_mahalanobis_distances;
-}
-
 ProcessorBase* ProcessorTrackerLandmarkCorner::create(const std::string& _unique_name, const ProcessorParamsBase* _params)
 {
     ProcessorParamsLaser* params = (ProcessorParamsLaser*)_params;
@@ -16,6 +16,7 @@
 #include "constraint_corner_2D.h"
 #include "state_block.h"
 #include "data_association/association_tree.h"
+#include "data_association/mahalanobis_gating.h"
 #include "processor_tracker_landmark.h"
 
 //laser_scan_utils
@@ -76,6 +77,13 @@ class ProcessorTrackerLandmarkCorner : public ProcessorTrackerLandmark
         Eigen::Vector3s t_world_robot_;
         bool extrinsics_transformation_computed_;
 
+        // Data association workspace, kept between calls to avoid reallocations
+        Eigen::Matrix<Scalar, 4, Eigen::Dynamic> expected_features_;    ///< expected features of the searched landmarks
+        Eigen::Matrix<Scalar, 9, Eigen::Dynamic> expected_features_covs_; ///< their 3x3 covariances, stacked column-wise
+        InnovationBatch3 innovations_;              ///< innovations of one feature w.r.t. all searched landmarks
+        CovarianceBatch3 innovations_covs_;         ///< and their covariances
+        Eigen::VectorXs squared_mahalanobis_distances_;
+
     public:
         ProcessorTrackerLandmarkCorner(const laserscanutils::LineFinderIterativeParams& _line_finder_params,
                                        const unsigned int& _new_corners_th, const unsigned int& _loop_frames_th);
@@ -162,11 +170,6 @@ class ProcessorTrackerLandmarkCorner : public ProcessorTrackerLandmark
 
         void expectedFeature(LandmarkBase* _landmark_ptr, Eigen::Vector4s& expected_feature_,
                              Eigen::Matrix3s& expected_feature_cov_);
-
-        Eigen::VectorXs computeSquaredMahalanobisDistances(const FeatureBase* _feature_ptr,
-                                                           const Eigen::Vector4s& _expected_feature,
-                                                           const Eigen::Matrix3s& _expected_feature_cov,
-                                                           const Eigen::MatrixXs& _mu);
     // Factory method
     public:
         static ProcessorBase* create(const std::string& _unique_name, const ProcessorParamsBase* _params);
@@ -0,0 +1,376 @@
+/**
+ * \file processor_tracker_landmark_image.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "processor_tracker_landmark_image.h"
+#include "capture_image.h"
+#include "feature_point_image.h"
+#include "sensor_camera.h"
+#include "state_homogeneous_3D.h"
+#include "pinholeTools.h"
+
+// OpenCV includes
+#include <opencv2/calib3d/calib3d.hpp>
+
+#include <limits>
+#include <set>
+
+namespace wolf
+{
+
+ProcessorTrackerLandmarkImage::ProcessorTrackerLandmarkImage(ProcessorTrackerLandmarkImageParameters _params) :
+        ProcessorTrackerLandmark(PRC_TRACKER_LANDMARK_IMAGE, _params.algorithm.max_new_features), params_(_params),
+        detector_descriptor_ptr_(nullptr), pattern_radius_(0), size_bits_(0), active_search_grid_()
+{
+    setType("IMAGE LANDMARK");
+
+    // 1. detector-descriptor
+    detector_descriptor_ptr_ = descriptor::createDetectorDescriptor(_params.detector_descriptor_params_ptr, pattern_radius_);
+    size_bits_ = detector_descriptor_ptr_->descriptorSize() * 8;
+
+    // 2. active search params
+    active_search_grid_.setParameters(_params.image.width, _params.image.height,
+            _params.active_search.grid_width, _params.active_search.grid_height,
+            pattern_radius_,
+            _params.active_search.separation);
+
+    // 3. buckets of the matching
+    incoming_buckets_.setParameters(_params.image.width, _params.image.height,
+                                    _params.matcher.roi_width, _params.matcher.roi_height);
+
+    // 4. relocalization
+    if (!_params.relocalization.vocabulary_file.empty())
+    {
+        vocabulary_.load(_params.relocalization.vocabulary_file);
+        if (vocabulary_.getDescriptorBytes() != (unsigned int)detector_descriptor_ptr_->descriptorSize())
+            throw std::runtime_error("The vocabulary does not match the descriptors of the detector-descriptor");
+    }
+
+    // 5. key frame policy
+    setKeyFramePolicy(_params);
+}
+
+ProcessorTrackerLandmarkImage::~ProcessorTrackerLandmarkImage()
+{
+    delete detector_descriptor_ptr_;
+}
+
+void ProcessorTrackerLandmarkImage::preProcess()
+{
+    CaptureImage* capture_ptr = (CaptureImage*)incoming_ptr_;
+    capture_ptr->describe(detector_descriptor_ptr_);
+    incoming_buckets_.bucket(capture_ptr->getKeypoints(), capture_ptr->getDescriptors());
+    keypoint_matched_.assign(capture_ptr->getKeypoints().size(), false);
+}
+
+void ProcessorTrackerLandmarkImage::frontEnd(CaptureBase* _capture_ptr)
+{
+    ((CaptureImage*)_capture_ptr)->describe(detector_descriptor_ptr_);
+}
+
+unsigned int ProcessorTrackerLandmarkImage::processKnown()
+{
+    unsigned int n_found = ProcessorTrackerLandmark::processKnown();
+    if (n_found < params_.relocalization.min_inliers && !vocabulary_.empty() && keyframe_database_.size() > 0)
+    {
+        FeatureBaseList relocalized_features;
+        n_found += relocalize(relocalized_features, matches_landmark_from_incoming_);
+        incoming_ptr_->addDownNodeList(relocalized_features);
+    }
+    return n_found;
+}
+
+unsigned int ProcessorTrackerLandmarkImage::findLandmarks(const LandmarkBaseList& _landmark_list_in,
+                                                          FeatureBaseList& _feature_list_out,
+                                                          LandmarkMatchMap& _feature_landmark_correspondences)
+{
+    CaptureImage* capture_ptr = (CaptureImage*)incoming_ptr_;
+    const std::vector<cv::KeyPoint>& keypoints = capture_ptr->getKeypoints();
+    const cv::Mat& descriptors = capture_ptr->getDescriptors();
+
+    // Camera pose in the world
+    SensorCamera* camera_ptr = (SensorCamera*)getSensorPtr();
+    Eigen::Vector3s p_wr;
+    Eigen::Quaternions q_wr;
+    predictPose(incoming_ptr_->getTimeStamp(), p_wr, q_wr);
+    Eigen::Vector3s t_rc = camera_ptr->getPPtr()->getVector();
+    Eigen::Matrix3s R_rc = Eigen::Map<const Eigen::Quaternions>(camera_ptr->getOPtr()->getPtr()).toRotationMatrix();
+    Eigen::Matrix3s R_cw = R_rc.transpose() * q_wr.toRotationMatrix().transpose();
+    Eigen::Vector3s t_wc = p_wr + q_wr * t_rc;
+
+    // Landmark directions in the camera frame: v = R_cw * (m - t_wc * w)
+    projected_landmarks_.clear();
+    landmarks_in_camera_.resize(3, _landmark_list_in.size());
+    for (auto landmark_base_ptr : _landmark_list_in)
+    {
+        if (landmark_base_ptr->getType() != LANDMARK_POINT)
+            continue;
+        LandmarkPoint3D* landmark_ptr = (LandmarkPoint3D*)landmark_base_ptr;
+        Eigen::VectorXs lmk = landmark_ptr->getPPtr()->getVector();
+        Scalar w = (landmark_ptr->isHomogeneous() ? lmk(3) : 1);
+        Eigen::Vector3s v = R_cw * (lmk.head<3>() - t_wc * w);
+        if (v(2) <= 0) // behind the camera
+            continue;
+        landmarks_in_camera_.col(projected_landmarks_.size()) = v;
+        projected_landmarks_.push_back(landmark_ptr);
+    }
+    if (projected_landmarks_.empty())
+        return 0;
+    pinhole::projectPoints(camera_ptr->getIntrinsicPtr()->getVector(), camera_ptr->getDistortionVector(),
+                           landmarks_in_camera_.leftCols(projected_landmarks_.size()), landmark_pixels_);
+
+    unsigned int n_found = 0;
+    for (unsigned int i = 0; i < projected_landmarks_.size(); i++)
+    {
+        const Scalar u = landmark_pixels_(0, i);
+        const Scalar v = landmark_pixels_(1, i);
+        if (u < 0 || v < 0 || u >= params_.image.width || v >= params_.image.height)
+            continue;
+
+        // best free candidate in the roi
+        Scalar best_distance;
+        int best_idx = incoming_buckets_.findBest(projected_landmarks_[i]->getCvDescriptor().ptr<uchar>(), u, v,
+                                                  keypoint_matched_, params_.matcher.similarity_norm, best_distance);
+        if (best_idx < 0)
+            continue;
+
+        Scalar normalized_score = 1 - best_distance / size_bits_;
+        if (normalized_score > params_.matcher.min_normalized_score)
+        {
+            FeaturePointImage* feature_ptr = new FeaturePointImage(keypoints[best_idx], descriptors.row(best_idx), true);
+            _feature_list_out.push_back(feature_ptr);
+            _feature_landmark_correspondences[feature_ptr] = LandmarkMatch({projected_landmarks_[i], normalized_score});
+            keypoint_matched_[best_idx] = true;
+            n_found++;
+        }
+    }
+    return n_found;
+}
+
+unsigned int ProcessorTrackerLandmarkImage::detectNewFeatures(const unsigned int& _max_features)
+{
+    CaptureImage* capture_ptr = (CaptureImage*)last_ptr_;
+    capture_ptr->describe(detector_descriptor_ptr_);
+    const std::vector<cv::KeyPoint>& keypoints = capture_ptr->getKeypoints();
+    const cv::Mat& descriptors = capture_ptr->getDescriptors();
+
+    // cells already observed by the landmarks found in last
+    active_search_grid_.renew();
+    for (auto feature_base_ptr : *(last_ptr_->getFeatureListPtr()))
+        active_search_grid_.hitCell(((FeaturePointImage*)feature_base_ptr)->getKeypoint());
+
+    // best keypoint of each empty cell
+    active_search_grid_.pickBestInEmptyRois(keypoints, _max_features, new_keypoints_);
+
+    for (auto idx : new_keypoints_)
+        new_features_last_.push_back(new FeaturePointImage(keypoints[idx], descriptors.row(idx), false));
+
+    return new_keypoints_.size();
+}
+
+LandmarkBase* ProcessorTrackerLandmarkImage::createLandmark(FeatureBase* _feature_ptr)
+{
+    FeaturePointImage* feature_ptr = (FeaturePointImage*)_feature_ptr;
+
+    // Camera pose at the Frame of last
+    SensorCamera* camera_ptr = (SensorCamera*)getSensorPtr();
+    FrameBase* frame_ptr = last_ptr_->getFramePtr();
+    Eigen::Vector3s p_wr = frame_ptr->getPPtr()->getVector();
+    Eigen::Map<const Eigen::Quaternions> q_wr(frame_ptr->getOPtr()->getPtr());
+    Eigen::Vector3s t_rc = camera_ptr->getPPtr()->getVector();
+    Eigen::Map<const Eigen::Quaternions> q_rc(camera_ptr->getOPtr()->getPtr());
+    Eigen::Vector3s t_wc = p_wr + q_wr * t_rc;
+
+    // Ray of the pixel, at unit depth, in the world frame
+    Eigen::Vector2s pixel = feature_ptr->getMeasurement();
+    Eigen::Vector3s ray = q_wr * (q_rc * pinhole::backprojectPoint(camera_ptr->getIntrinsicPtr()->getVector(),
+                                                                    camera_ptr->getCorrectionVector(), pixel));
+
+    StateBlock* p_ptr;
+    if (params_.landmark.homogeneous)
+    {
+        // h = [ray + t_wc * w ; w], with w = 1 / depth, normalized
+        Eigen::Vector4s h;
+        h << ray + t_wc / params_.landmark.initial_depth, 1 / params_.landmark.initial_depth;
+        p_ptr = new StateHomogeneous3D(h.normalized());
+    }
+    else
+        p_ptr = new StateBlock(t_wc + ray * params_.landmark.initial_depth);
+
+    return new LandmarkPoint3D(p_ptr, feature_ptr->getDescriptor());
+}
+
+void ProcessorTrackerLandmarkImage::establishConstraints()
+{
+    ProcessorTrackerLandmark::establishConstraints();
+
+    // index the new KeyFrame for the relocalization
+    if (!vocabulary_.empty())
+    {
+        const cv::Mat& descriptors = ((CaptureImage*)last_ptr_)->getDescriptors();
+        BowVector bow;
+        vocabulary_.transform(descriptors.ptr<uchar>(), descriptors.rows, bow);
+        keyframe_database_.addKeyFrame(last_ptr_->getFramePtr(), bow);
+    }
+}
+
+unsigned int ProcessorTrackerLandmarkImage::relocalize(FeatureBaseList& _feature_list_out,
+                                                       LandmarkMatchMap& _feature_landmark_correspondences)
+{
+    CaptureImage* capture_ptr = (CaptureImage*)incoming_ptr_;
+    const std::vector<cv::KeyPoint>& keypoints = capture_ptr->getKeypoints();
+    const cv::Mat& descriptors = capture_ptr->getDescriptors();
+    if (keypoints.empty())
+        return 0;
+
+    // KeyFrames similar to the incoming image
+    BowVector bow;
+    vocabulary_.transform(descriptors.ptr<uchar>(), descriptors.rows, bow);
+    std::vector<KeyFrameCandidate> candidates;
+    keyframe_database_.query(bow, params_.relocalization.max_candidates, params_.relocalization.min_score, candidates);
+
+    // Camera model in OpenCV format: the radial distortion of wolf is k1, k2, k3 of OpenCV
+    SensorCamera* camera_ptr = (SensorCamera*)getSensorPtr();
+    Eigen::Vector4s k = camera_ptr->getIntrinsicPtr()->getVector();
+    Eigen::VectorXs d = camera_ptr->getDistortionVector();
+    cv::Mat camera_matrix = cv::Mat::eye(3, 3, CV_64F);
+    camera_matrix.at<double>(0, 0) = k(2);
+    camera_matrix.at<double>(1, 1) = k(3);
+    camera_matrix.at<double>(0, 2) = k(0);
+    camera_matrix.at<double>(1, 2) = k(1);
+    cv::Mat distortion = cv::Mat::zeros(1, 5, CV_64F);
+    const int distortion_index[3] = {0, 1, 4};
+    for (unsigned int i = 0; i < d.size() && i < 3; i++)
+        distortion.at<double>(0, distortion_index[i]) = d(i);
+
+    // Landmarks already tracked
+    std::set<LandmarkBase*> tracked_landmarks;
+    for (auto& match : _feature_landmark_correspondences)
+        tracked_landmarks.insert(match.second.landmark_ptr_);
+
+    for (auto& candidate : candidates)
+    {
+        // Landmarks observed by the KeyFrame
+        std::set<LandmarkPoint3D*> keyframe_landmarks;
+        for (auto candidate_capture_ptr : *(candidate.frame_ptr->getCaptureListPtr()))
+            for (auto feature_ptr : *(candidate_capture_ptr->getFeatureListPtr()))
+                for (auto constraint_ptr : *(feature_ptr->getConstraintListPtr()))
+                {
+                    LandmarkBase* landmark_ptr = constraint_ptr->getLandmarkOtherPtr();
+                    if (landmark_ptr != nullptr && landmark_ptr->getType() == LANDMARK_POINT
+                            && tracked_landmarks.count(landmark_ptr) == 0)
+                        keyframe_landmarks.insert((LandmarkPoint3D*)landmark_ptr);
+                }
+
+        // Match them by appearance to the free keypoints
+        std::vector<bool> keypoint_used = keypoint_matched_;
+        std::vector<cv::Point3f> landmark_points;
+        std::vector<cv::Point2f> keypoint_points;
+        std::vector<std::pair<LandmarkPoint3D*, unsigned int> > matches;
+        std::vector<Scalar> match_scores;
+        for (auto landmark_ptr : keyframe_landmarks)
+        {
+            // Euclidean position, unless at infinity
+            Eigen::VectorXs lmk = landmark_ptr->getPPtr()->getVector();
+            Scalar w = (landmark_ptr->isHomogeneous() ? lmk(3) : 1);
+            if (std::abs(w) < 1e-6)
+                continue;
+            Eigen::Vector3s point = lmk.head<3>() / w;
+
+            const uchar* target_descriptor = landmark_ptr->getCvDescriptor().ptr<uchar>();
+            int best_idx = -1;
+            Scalar best_distance = std::numeric_limits<Scalar>::max();
+            for (unsigned int idx = 0; idx < keypoints.size(); idx++)
+            {
+                if (keypoint_used[idx])
+                    continue;
+                Scalar distance = descriptor::distance(target_descriptor, descriptors.ptr<uchar>(idx), descriptors.cols,
+                                                       params_.matcher.similarity_norm);
+                if (distance < best_distance)
+                {
+                    best_distance = distance;
+                    best_idx = idx;
+                }
+            }
+            if (best_idx < 0)
+                continue;
+            Scalar normalized_score = 1 - best_distance / size_bits_;
+            if (normalized_score <= params_.matcher.min_normalized_score)
+                continue;
+
+            keypoint_used[best_idx] = true;
+            landmark_points.push_back(cv::Point3f(point(0), point(1), point(2)));
+            keypoint_points.push_back(keypoints[best_idx].pt);
+            matches.push_back(std::make_pair(landmark_ptr, best_idx));
+            match_scores.push_back(normalized_score);
+        }
+        if (matches.size() < params_.relocalization.min_inliers)
+            continue;
+
+        // Geometric verification: camera pose consistent with the matched landmarks
+        cv::Mat rvec, tvec;
+        std::vector<int> inliers;
+        cv::solvePnPRansac(landmark_points, keypoint_points, camera_matrix, distortion, rvec, tvec, false, 100,
+                           params_.relocalization.max_reprojection_error, params_.relocalization.min_inliers, inliers);
+        if (inliers.size() < params_.relocalization.min_inliers)
+            continue;
+
+        for (auto i : inliers)
+        {
+            unsigned int idx = matches[i].second;
+            FeaturePointImage* feature_ptr = new FeaturePointImage(keypoints[idx], descriptors.row(idx), true);
+            _feature_list_out.push_back(feature_ptr);
+            _feature_landmark_correspondences[feature_ptr] = LandmarkMatch({matches[i].first, match_scores[i]});
+            keypoint_matched_[idx] = true;
+        }
+        return inliers.size();
+    }
+    return 0;
+}
+
+void ProcessorTrackerLandmarkImage::predictPose(const TimeStamp& _ts, Eigen::Vector3s& _p_wr, Eigen::Quaternions& _q_wr)
+{
+    if (getProblem()->getProcessorMotionPtr() != nullptr)
+    {
+        Eigen::VectorXs state = getProblem()->getStateAtTimeStamp(_ts);
+        _p_wr = state.head<3>();
+        _q_wr = Eigen::Map<const Eigen::Quaternions>(state.data() + 3);
+    }
+    else
+    {
+        FrameBase* frame_ptr = last_ptr_->getFramePtr();
+        _p_wr = frame_ptr->getPPtr()->getVector();
+        _q_wr = Eigen::Map<const Eigen::Quaternions>(frame_ptr->getOPtr()->getPtr());
+    }
+}
+
+Scalar ProcessorTrackerLandmarkImage::descriptorDistance(const cv::Mat& _descriptor_1, const cv::Mat& _descriptor_2) const
+{
+    return descriptor::distance(_descriptor_1.ptr<uchar>(), _descriptor_2.ptr<uchar>(), _descriptor_1.cols,
+                                params_.matcher.similarity_norm);
+}
+
+ProcessorBase* ProcessorTrackerLandmarkImage::create(const std::string& _unique_name, const ProcessorParamsBase* _params)
+{
+    const ProcessorTrackerLandmarkImageParameters* params = dynamic_cast<const ProcessorTrackerLandmarkImageParameters*>(_params);
+    if (params == nullptr)
+        throw std::runtime_error("ProcessorTrackerLandmarkImage::create: params are not of type ProcessorTrackerLandmarkImageParameters");
+    ProcessorTrackerLandmarkImage* prc_ptr = new ProcessorTrackerLandmarkImage(*params);
+    prc_ptr->setName(_unique_name);
+    return prc_ptr;
+}
+
+} // namespace wolf
+
+
+// Register in the ProcessorFactory
+#include "processor_factory.h"
+namespace wolf {
+namespace
+{
+const bool registered_prc_tracker_landmark_image = ProcessorFactory::get().registerCreator("IMAGE LANDMARK", ProcessorTrackerLandmarkImage::create);
+}
+} // namespace wolf
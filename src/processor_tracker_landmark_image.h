@@ -0,0 +1,181 @@
+/**
+ * \file processor_tracker_landmark_image.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef PROCESSOR_TRACKER_LANDMARK_IMAGE_H_
+#define PROCESSOR_TRACKER_LANDMARK_IMAGE_H_
+
+// Wolf includes
+#include "processor_tracker_landmark.h"
+#include "processor_image.h"
+#include "landmark_point_3D.h"
+#include "constraint_image_point.h"
+#include "vocabulary_tree.h"
+#include "keyframe_database.h"
+
+namespace wolf
+{
+
+struct ProcessorTrackerLandmarkImageParameters : public ProcessorImageParameters
+{
+        struct Landmark
+        {
+                bool homogeneous = true;    ///< create homogeneous (HP) landmarks. Otherwise, Euclidean (EP) ones
+                Scalar initial_depth = 1.0; ///< depth of the new landmarks, in meters, since a single image does not observe it
+        }landmark;
+        struct Relocalization
+        {
+                std::string vocabulary_file = "";   ///< VocabularyTree file of the descriptors. Empty: no relocalization
+                unsigned int max_candidates = 3;    ///< max number of KeyFrames verified at each relocalization
+                Scalar min_score = 0.05;            ///< min bag-of-words score of the verified KeyFrames
+                unsigned int min_inliers = 20;      ///< relocalize when fewer Landmarks are tracked, with at least this number of PnP inliers
+                Scalar max_reprojection_error = 4;  ///< max reprojection error of the PnP inliers, in pixels
+        }relocalization;
+};
+
+/** \brief Tracker of 3D point Landmarks with a monocular camera
+ *
+ * The Landmarks of the Map are found in the \b incoming image by projection:
+ *   - All searched Landmarks are projected at once, with pinhole::projectPoints(), at the predicted robot pose.
+ *   - Each projection is matched against the keypoints of the \b incoming image within a matcher roi around it.
+ *     The keypoints of the image are detected and described once, cached in the CaptureImage,
+ *     and bucketed in cells of the size of the roi (see KeypointBuckets), so that matching a Landmark visits at most 2x2 buckets.
+ *
+ * New Landmarks are created at KeyFrames, from the best keypoints of the empty cells of the ActiveSearchGrid.
+ * Their depth is not observable from one image: they are initialized at landmark.initial_depth along the ray of the pixel.
+ * Homogeneous Landmarks (the default) handle this uncertain depth well, including points at infinity.
+ *
+ * Each Feature-Landmark pair creates a ConstraintImagePoint, with analytic Jacobians,
+ * whose Landmark state block goes last for the Schur elimination of the Landmarks in the solver.
+ *
+ * The per-frame cost is bounded by the number of searched Landmarks and by algorithm.max_new_features.
+ * With a search range (see ProcessorTrackerLandmark::setLandmarkSearchRange()), the spatial index of the Map
+ * only returns the Landmarks near the robot. Homogeneous Landmarks are indexed at their Euclidean position,
+ * so that only those at infinity, which have no position, are searched at every frame.
+ *
+ * If a vocabulary file is given (see relocalization.vocabulary_file), each KeyFrame is inserted in a KeyFrameDatabase.
+ * When fewer than relocalization.min_inliers Landmarks are tracked, e.g. after the tracks are lost or when revisiting a place,
+ * the \b incoming image is queried in the database, and the Landmarks of the best KeyFrames are matched by appearance.
+ * A KeyFrame is accepted if PnP-RANSAC verifies enough of its matches, which become Features of the \b incoming Capture,
+ * and reconnect it to the old KeyFrame through the ConstraintImagePoint of the shared Landmarks.
+ */
+class ProcessorTrackerLandmarkImage : public ProcessorTrackerLandmark
+{
+    protected:
+        ProcessorTrackerLandmarkImageParameters params_;
+        cv::Feature2D* detector_descriptor_ptr_;
+        unsigned int pattern_radius_;   ///< radius of the detector pattern, in pixels
+        unsigned int size_bits_;        ///< length of the descriptor vector in bits
+        ActiveSearchGrid active_search_grid_;
+
+        // Workspace of the landmark projection
+        std::vector<LandmarkPoint3D*> projected_landmarks_;
+        Eigen::Matrix<Scalar, 3, Eigen::Dynamic> landmarks_in_camera_; ///< landmark directions in the camera frame, one per column
+        Eigen::Matrix<Scalar, 2, Eigen::Dynamic> landmark_pixels_;     ///< their projections
+
+        // Workspace of the matching
+        KeypointBuckets incoming_buckets_;          ///< keypoints of the incoming image, bucketed by matcher roi
+        std::vector<bool> keypoint_matched_;        ///< keypoints already matched to a landmark
+        std::vector<unsigned int> new_keypoints_;   ///< keypoints of the new features of last
+
+        // Relocalization
+        VocabularyTree vocabulary_;
+        KeyFrameDatabase keyframe_database_;
+
+    public:
+        ProcessorTrackerLandmarkImage(ProcessorTrackerLandmarkImageParameters _params);
+        virtual ~ProcessorTrackerLandmarkImage();
+
+        /** \brief Remove a removed KeyFrame from the KeyFrameDatabase, so that relocalize() does not retrieve it
+         */
+        virtual void keyFrameRemovedCallback(FrameBase* _keyframe_ptr);
+
+    protected:
+        /** \brief Detects and describes the \b incoming image, and renews the active search grid
+         */
+        virtual void preProcess();
+
+        /** \brief Detects and describes the whole image of the Capture, cached in it for preProcess()
+         */
+        virtual void frontEnd(CaptureBase* _capture_ptr);
+
+        /** \brief Tracks the known Landmarks in \b incoming, and relocalizes if too few of them are found
+         */
+        virtual unsigned int processKnown();
+
+        /** \brief Find provided landmarks in the incoming capture
+         * \param _landmark_list_in input list of landmarks to be found in incoming
+         * \param _feature_list_out returned list of incoming features corresponding to a landmark of _landmark_list_in
+         * \param _feature_landmark_correspondences returned map of landmark correspondences: _feature_landmark_correspondences[_feature_out_ptr] = landmark_in_ptr
+         */
+        virtual unsigned int findLandmarks(const LandmarkBaseList& _landmark_list_in, FeatureBaseList& _feature_list_out,
+                                           LandmarkMatchMap& _feature_landmark_correspondences);
+
+        /** \brief Vote for KeyFrame generation
+         *
+         * If a KeyFrame criterion is validated, this function returns true,
+         * meaning that it wants to create a KeyFrame at the \b last Capture.
+         *
+         * WARNING! This function only votes! It does not create KeyFrames!
+         */
+        virtual bool voteForKeyFrame();
+
+        /** \brief Detect new Features in the empty cells of the active search grid of \b last
+         */
+        virtual unsigned int detectNewFeatures(const unsigned int& _max_features);
+
+        /** \brief Create one 3D point landmark at landmark.initial_depth along the ray of the feature
+         */
+        virtual LandmarkBase* createLandmark(FeatureBase* _feature_ptr);
+
+        /** \brief Create a ConstraintImagePoint
+         */
+        virtual ConstraintBase* createConstraint(FeatureBase* _feature_ptr, LandmarkBase* _landmark_ptr);
+
+        /** \brief Creates the constraints of \b last, and inserts its KeyFrame in the KeyFrameDatabase
+         */
+        virtual void establishConstraints();
+
+    private:
+        /** \brief Predicted pose of the robot at a time stamp
+         *
+         * From the motion processor of the Problem if any, or else at the Frame of \b last.
+         */
+        void predictPose(const TimeStamp& _ts, Eigen::Vector3s& _p_wr, Eigen::Quaternions& _q_wr);
+
+        /** \brief Finds the Landmarks of the KeyFrames most similar to the \b incoming image
+         * \param _feature_list_out returned list of incoming features corresponding to the Landmarks of a verified KeyFrame
+         * \param _feature_landmark_correspondences returned map of landmark correspondences
+         * \return the number of Landmarks found
+         */
+        unsigned int relocalize(FeatureBaseList& _feature_list_out, LandmarkMatchMap& _feature_landmark_correspondences);
+
+        /** \brief Distance between two descriptors, with the norm of the matcher
+         */
+        Scalar descriptorDistance(const cv::Mat& _descriptor_1, const cv::Mat& _descriptor_2) const;
+
+    public:
+        static ProcessorBase* create(const std::string& _unique_name, const ProcessorParamsBase* _params);
+};
+
+inline bool ProcessorTrackerLandmarkImage::voteForKeyFrame()
+{
+    return (incoming_ptr_->getFeatureListPtr()->size() < params_.algorithm.min_features_for_keyframe);
+}
+
+inline void ProcessorTrackerLandmarkImage::keyFrameRemovedCallback(FrameBase* _keyframe_ptr)
+{
+    keyframe_database_.removeKeyFrame(_keyframe_ptr);
+}
+
+inline ConstraintBase* ProcessorTrackerLandmarkImage::createConstraint(FeatureBase* _feature_ptr, LandmarkBase* _landmark_ptr)
+{
+    return new ConstraintImagePoint(_feature_ptr, _landmark_ptr);
+}
+
+} // namespace wolf
+
+#endif /* PROCESSOR_TRACKER_LANDMARK_IMAGE_H_ */
@@ -0,0 +1,211 @@
+/**
+ * \file processor_tracker_scan_matching_2D.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "processor_tracker_scan_matching_2D.h"
+
+namespace wolf
+{
+
+ProcessorTrackerScanMatching2D::ProcessorTrackerScanMatching2D(const ProcessorParamsScanMatching2D& _params) :
+        ProcessorTracker(PRC_TRACKER_SCAN_MATCHING_2D, 0), params_(_params), matcher_(_params.matcher)
+{
+    assert(_params.n_keyframes > 0 && "ProcessorTrackerScanMatching2D: the local map needs at least one KeyFrame");
+    match_last_.n_points = match_incoming_.n_points = 0;
+    match_last_.reference_frame_ptr = match_incoming_.reference_frame_ptr = nullptr;
+    match_last_.score = match_incoming_.score = 0;
+}
+
+void ProcessorTrackerScanMatching2D::preProcess()
+{
+    computeScanPoints((CaptureLaser2D*)(incoming_ptr_), match_incoming_);
+}
+
+unsigned int ProcessorTrackerScanMatching2D::processKnown()
+{
+    match_incoming_.reference_frame_ptr = nullptr;
+    match_incoming_.score = 0;
+    if (key_scans_.empty() || match_incoming_.n_points == 0)
+        return 0;
+
+    // initial guess: robot pose at incoming w.r.t. the map KeyFrame
+    FrameBase* map_frame_ptr = key_scans_.rbegin()->second.frame_ptr;
+    Eigen::Vector3s map_frame_state = map_frame_ptr->getState();
+    Eigen::Vector3s state = getPriorState(incoming_ptr_->getTimeStamp());
+    Eigen::Vector3s pose_guess;
+    pose_guess.head<2>() = Eigen::Rotation2Ds(-map_frame_state(2)) * (state.head<2>() - map_frame_state.head<2>());
+    pose_guess(2) = pi2pi(state(2) - map_frame_state(2));
+
+    if (!matcher_.match(match_incoming_.points.leftCols(match_incoming_.n_points), pose_guess, match_incoming_.pose,
+                        match_incoming_.score))
+        return 0;
+
+    match_incoming_.reference_frame_ptr = map_frame_ptr;
+    return 1;
+}
+
+bool ProcessorTrackerScanMatching2D::voteForKeyFrame()
+{
+    // lost: make a KeyFrame at last to rebuild the map from there
+    if (match_incoming_.reference_frame_ptr == nullptr)
+        return !key_scans_.empty();
+
+    // incoming is too far from the map KeyFrame: make a KeyFrame at last, which is still close enough
+    return match_incoming_.pose.head<2>().norm() > params_.keyframe_distance
+            || std::abs(match_incoming_.pose(2)) > params_.keyframe_angle;
+}
+
+unsigned int ProcessorTrackerScanMatching2D::processNew(const unsigned int& _max_features)
+{
+    FrameBase* frame_ptr = last_ptr_->getFramePtr();
+    if (key_scans_.count(frame_ptr->id()) > 0)
+        return 0; // already in the map
+
+    // state of the new map KeyFrame: from the scan match if available
+    Eigen::Vector3s frame_state;
+    if (match_last_.reference_frame_ptr != nullptr)
+    {
+        Eigen::Vector3s reference_state = match_last_.reference_frame_ptr->getState();
+        frame_state.head<2>() = reference_state.head<2>() + Eigen::Rotation2Ds(reference_state(2)) * match_last_.pose.head<2>();
+        frame_state(2) = pi2pi(reference_state(2) + match_last_.pose(2));
+    }
+    else
+        frame_state = getPriorState(last_ptr_->getTimeStamp());
+
+    key_scans_[frame_ptr->id()] = KeyScan({frame_ptr, match_last_.points.leftCols(match_last_.n_points)});
+    while (key_scans_.size() > params_.n_keyframes)
+        key_scans_.erase(key_scans_.begin());
+
+    frame_ptr->setState(frame_state);
+    buildMap(frame_state);
+
+    return 1;
+}
+
+void ProcessorTrackerScanMatching2D::establishConstraints()
+{
+    if (match_last_.reference_frame_ptr == nullptr || match_last_.reference_frame_ptr == last_ptr_->getFramePtr())
+        return;
+
+    Eigen::Matrix3s cov = Eigen::Matrix3s::Zero();
+    cov(0, 0) = cov(1, 1) = params_.position_std_dev * params_.position_std_dev;
+    cov(2, 2) = params_.angle_std_dev * params_.angle_std_dev;
+
+    FeatureOdom2D* feature_ptr = new FeatureOdom2D(match_last_.pose, cov);
+    last_ptr_->addFeature(feature_ptr);
+    feature_ptr->addConstraint(new ConstraintOdom2D(feature_ptr, match_last_.reference_frame_ptr));
+}
+
+void ProcessorTrackerScanMatching2D::keyFrameRemovedCallback(FrameBase* _keyframe_ptr)
+{
+    if (match_last_.reference_frame_ptr == _keyframe_ptr)
+        match_last_.reference_frame_ptr = nullptr;
+    if (match_incoming_.reference_frame_ptr == _keyframe_ptr)
+        match_incoming_.reference_frame_ptr = nullptr;
+
+    auto key_scan_it = key_scans_.find(_keyframe_ptr->id());
+    if (key_scan_it == key_scans_.end())
+        return;
+    bool map_frame_removed = (std::next(key_scan_it) == key_scans_.end());
+    key_scans_.erase(key_scan_it);
+
+    // the map is expressed in the map KeyFrame: rebuild it in the new one
+    if (map_frame_removed && !key_scans_.empty())
+        buildMap(key_scans_.rbegin()->second.frame_ptr->getState());
+}
+
+Eigen::Vector3s ProcessorTrackerScanMatching2D::getPriorState(const TimeStamp& _ts)
+{
+    if (getProblem()->getProcessorMotionPtr() != nullptr)
+        return getProblem()->getStateAtTimeStamp(_ts);
+
+    FrameBase* keyframe_ptr = getProblem()->getLastKeyFramePtr();
+    if (keyframe_ptr != nullptr)
+        return keyframe_ptr->getState();
+    return Eigen::Vector3s::Zero();
+}
+
+void ProcessorTrackerScanMatching2D::computeScanPoints(CaptureLaser2D* _capture_ptr, ScanMatch& _match)
+{
+    const laserscanutils::LaserScanParams& scan_params = ((SensorLaser2D*)getSensorPtr())->getScanParams();
+    const std::vector<float>& ranges = _capture_ptr->getScan().ranges_raw_;
+
+    // beam directions, computed once
+    if (beam_cos_.size() != ranges.size())
+    {
+        beam_cos_.resize(ranges.size());
+        beam_sin_.resize(ranges.size());
+        for (unsigned int i = 0; i < ranges.size(); i++)
+        {
+            Scalar bearing = scan_params.angle_min_ + i * scan_params.angle_step_;
+            beam_cos_[i] = cos(bearing);
+            beam_sin_[i] = sin(bearing);
+        }
+    }
+
+    // sensor to robot
+    Eigen::Vector2s t_robot_sensor = Eigen::Map<const Eigen::Vector2s>(getSensorPtr()->getPPtr()->getPtr());
+    Eigen::Matrix2s R_robot_sensor = Eigen::Rotation2Ds(*getSensorPtr()->getOPtr()->getPtr()).matrix();
+
+    _match.points.resize(2, ranges.size()); // no reallocation if the size does not change
+    _match.n_points = 0;
+    for (unsigned int i = 0; i < ranges.size(); i++)
+    {
+        if (ranges[i] <= scan_params.range_min_ || ranges[i] >= scan_params.range_max_)
+            continue;
+        _match.points.col(_match.n_points++) = R_robot_sensor * Eigen::Vector2s(ranges[i] * beam_cos_[i], ranges[i] * beam_sin_[i])
+                + t_robot_sensor;
+    }
+}
+
+void ProcessorTrackerScanMatching2D::buildMap(const Eigen::Vector3s& _map_frame_state)
+{
+    unsigned int n_points = 0;
+    for (auto& id_scan : key_scans_)
+        n_points += id_scan.second.points.cols();
+    map_points_.resize(2, n_points);
+
+    // all scans in the robot frame of the map KeyFrame
+    unsigned int col = 0;
+    for (auto& id_scan : key_scans_)
+    {
+        const KeyScan& key_scan = id_scan.second;
+        Eigen::Vector3s state = (&id_scan == &*key_scans_.rbegin()) ? _map_frame_state : Eigen::Vector3s(key_scan.frame_ptr->getState());
+        Eigen::Matrix2s R_map_key = Eigen::Rotation2Ds(state(2) - _map_frame_state(2)).matrix();
+        Eigen::Vector2s t_map_key = Eigen::Rotation2Ds(-_map_frame_state(2)) * (state.head<2>() - _map_frame_state.head<2>());
+        map_points_.middleCols(col, key_scan.points.cols()) = (R_map_key * key_scan.points).colwise() + t_map_key;
+        col += key_scan.points.cols();
+    }
+
+    if (n_points == 0)
+        return;
+
+    ProbabilityGrid2D& grid = matcher_.getGrid();
+    grid.reset(map_points_.rowwise().minCoeff(), map_points_.rowwise().maxCoeff(), params_.matcher.n_levels);
+    grid.insertPoints(map_points_);
+    grid.computeLevels();
+}
+
+ProcessorBase* ProcessorTrackerScanMatching2D::create(const std::string& _unique_name, const ProcessorParamsBase* _params)
+{
+    const ProcessorParamsScanMatching2D* params = dynamic_cast<const ProcessorParamsScanMatching2D*>(_params);
+    if (params == nullptr)
+        throw std::runtime_error("ProcessorTrackerScanMatching2D::create: params are not of type ProcessorParamsScanMatching2D");
+    ProcessorTrackerScanMatching2D* prc_ptr = new ProcessorTrackerScanMatching2D(*params);
+    prc_ptr->setName(_unique_name);
+    return prc_ptr;
+}
+
+} // namespace wolf
+
+// Register in the ProcessorFactory
+#include "processor_factory.h"
+namespace wolf {
+namespace
+{
+const bool registered_prc_scan_matching_2d = ProcessorFactory::get().registerCreator("SCAN MATCHING 2D", ProcessorTrackerScanMatching2D::create);
+}
+} // namespace wolf
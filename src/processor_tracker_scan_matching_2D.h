@@ -0,0 +1,164 @@
+/**
+ * \file processor_tracker_scan_matching_2D.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef PROCESSOR_TRACKER_SCAN_MATCHING_2D_H_
+#define PROCESSOR_TRACKER_SCAN_MATCHING_2D_H_
+
+// Wolf includes
+#include "sensor_laser_2D.h"
+#include "capture_laser_2D.h"
+#include "feature_odom_2D.h"
+#include "constraint_odom_2D.h"
+#include "correlative_scan_matcher_2D.h"
+#include "processor_tracker.h"
+
+// STL
+#include <map>
+
+namespace wolf
+{
+
+struct ProcessorParamsScanMatching2D : public ProcessorParamsBase
+{
+        ScanMatcherParams2D matcher;     ///< see CorrelativeScanMatcher2D
+        unsigned int n_keyframes;        ///< number of recent KeyFrame scans in the local map
+        Scalar keyframe_distance;        ///< vote for KeyFrame when the robot moves this far from the map KeyFrame
+        Scalar keyframe_angle;           ///< vote for KeyFrame when the robot turns this much from the map KeyFrame
+        Scalar position_std_dev;         ///< std deviation of the position of the relative pose constraints
+        Scalar angle_std_dev;            ///< std deviation of the orientation of the relative pose constraints
+};
+
+/** \brief Laser 2D scan-to-map tracker
+ *
+ * This tracker registers each scan against a local map made of the scans of the last KeyFrames,
+ * using a CorrelativeScanMatcher2D. Unlike the corner trackers, it does not need any geometric
+ * feature in the scene, so that it also works in corridors and other scenes with few corners.
+ *
+ * The local map is a ProbabilityGrid2D expressed in the robot frame of the most recent KeyFrame.
+ * It is rebuilt at each new KeyFrame from the current state of the KeyFrames, so that it benefits
+ * from the corrections of the solver.
+ * The initial guess of each match is the state given by the Problem at the scan time stamp,
+ * typically coming from a motion processor. Without motion processor, the guess is the pose of the last KeyFrame.
+ *
+ * The scans of the local map are kept by KeyFrame id, and dropped when their KeyFrame is removed.
+ *
+ * At each KeyFrame, the tracker adds a FeatureOdom2D to the \b last Capture, with the matched relative pose
+ * of \b last w.r.t. the map KeyFrame, and a ConstraintOdom2D to that KeyFrame.
+ *
+ * The whole processing runs on the calling thread: grid lookups are precomputed per scan orientation,
+ * and the branch-and-bound search prunes most of the search window (see CorrelativeScanMatcher2D).
+ */
+class ProcessorTrackerScanMatching2D : public ProcessorTracker
+{
+    public:
+        ProcessorTrackerScanMatching2D(const ProcessorParamsScanMatching2D& _params);
+        virtual ~ProcessorTrackerScanMatching2D();
+
+        /** \brief Score of the last match, in [0,1]. 0 if it failed.
+         */
+        Scalar getLastScore() const;
+
+        /** \brief Number of KeyFrame scans in the local map
+         */
+        unsigned int getNumKeyScans() const;
+
+        /** \brief Drop the scan of a removed KeyFrame from the local map
+         */
+        virtual void keyFrameRemovedCallback(FrameBase* _keyframe_ptr);
+
+    protected:
+        virtual void preProcess();
+
+        /** \brief Match the \b incoming scan against the local map
+         * \return 1 if the match succeeded, 0 otherwise.
+         */
+        virtual unsigned int processKnown();
+
+        /** \brief Vote for KeyFrame at \b last when \b incoming is too far from the map KeyFrame, or could not be matched.
+         */
+        virtual bool voteForKeyFrame();
+
+        /** \brief Insert the scan of \b last in the local map, and make it the map KeyFrame.
+         * \return 1, the number of inserted scans.
+         */
+        virtual unsigned int processNew(const unsigned int& _max_features);
+
+        /** \brief Constrain \b last to the KeyFrame it was matched against.
+         */
+        virtual void establishConstraints();
+
+        virtual void advance();
+        virtual void reset();
+
+    private:
+        struct KeyScan
+        {
+                FrameBase* frame_ptr; ///< valid while the KeyFrame exists, see keyFrameRemovedCallback()
+                Eigen::Matrix<Scalar, 2, Eigen::Dynamic> points; ///< scan points in the robot frame
+        };
+
+        /** \brief Matching result of one scan
+         */
+        struct ScanMatch
+        {
+                Eigen::Matrix<Scalar, 2, Eigen::Dynamic> points; ///< scan points in the robot frame
+                unsigned int n_points;
+                FrameBase* reference_frame_ptr;     ///< map KeyFrame of the match. nullptr if not matched
+                Eigen::Vector3s pose;               ///< robot pose w.r.t. the reference frame
+                Scalar score;
+        };
+
+        ProcessorParamsScanMatching2D params_;
+        CorrelativeScanMatcher2D matcher_;
+
+        std::map<unsigned int, KeyScan> key_scans_; ///< scans of the map KeyFrames by frame id, the map KeyFrame last
+        Eigen::Matrix<Scalar, 2, Eigen::Dynamic> map_points_; ///< workspace to build the map
+
+        ScanMatch match_last_, match_incoming_;
+
+        // Lookup table of beam directions, in the sensor frame
+        std::vector<Scalar> beam_cos_, beam_sin_;
+
+        void computeScanPoints(CaptureLaser2D* _capture_ptr, ScanMatch& _match);
+        void buildMap(const Eigen::Vector3s& _map_frame_state);
+
+        /** \brief Prior robot state at a time stamp: from the motion processor if any, or the last KeyFrame
+         */
+        Eigen::Vector3s getPriorState(const TimeStamp& _ts);
+
+    public:
+        static ProcessorBase* create(const std::string& _unique_name, const ProcessorParamsBase* _params);
+};
+
+inline ProcessorTrackerScanMatching2D::~ProcessorTrackerScanMatching2D()
+{
+    //
+}
+
+inline Scalar ProcessorTrackerScanMatching2D::getLastScore() const
+{
+    return match_last_.reference_frame_ptr == nullptr ? 0 : match_last_.score;
+}
+
+inline unsigned int ProcessorTrackerScanMatching2D::getNumKeyScans() const
+{
+    return key_scans_.size();
+}
+
+inline void ProcessorTrackerScanMatching2D::advance()
+{
+    std::swap(match_last_, match_incoming_);
+}
+
+inline void ProcessorTrackerScanMatching2D::reset()
+{
+    std::swap(match_last_, match_incoming_);
+}
+
+} // namespace wolf
+
+#endif /* PROCESSOR_TRACKER_SCAN_MATCHING_2D_H_ */
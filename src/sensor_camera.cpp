@@ -3,15 +3,19 @@
 #include "state_quaternion.h"
 #include "pinholeTools.h"
 
+#include <limits>
+
 namespace wolf
 {
 
 SensorCamera::SensorCamera(StateBlock* _p_ptr, StateBlock* _o_ptr, StateBlock* _intr_ptr, //
                            int _img_width, int _img_height) :
         SensorBase(SEN_CAMERA, _p_ptr, _o_ptr, _intr_ptr, 2), //
-        img_width_(_img_width), img_height_(_img_height)
+        img_width_(_img_width), img_height_(_img_height), undistortion_map_step_(4),
+        undistortion_map_width_(0), undistortion_map_height_(0)
 {
     setType("CAMERA");
+    undistortion_map_intrinsics_.setConstant(std::numeric_limits<Scalar>::quiet_NaN()); // built on first use
 }
 
 SensorCamera::SensorCamera(const Eigen::VectorXs& _extrinsics, const IntrinsicsCamera* _intrinsics_ptr) :
@@ -19,14 +23,15 @@ SensorCamera::SensorCamera(const Eigen::VectorXs& _extrinsics, const IntrinsicsC
                 img_width_(_intrinsics_ptr->width), //
                 img_height_(_intrinsics_ptr->height), //
                 distortion_(_intrinsics_ptr->distortion), //
-                correction_(distortion_.size()) // make correction vector of the same size as distortion vector
+                correction_(distortion_.size()), // make correction vector of the same size as distortion vector
+                undistortion_map_step_(4), undistortion_map_width_(0), undistortion_map_height_(0)
 {
     assert(_extrinsics.size() == 7 && "Wrong intrinsics vector size. Should be 7 for 3D");
     setType("CAMERA");
     p_ptr_ = new StateBlock(_extrinsics.head(3));
     o_ptr_ = new StateQuaternion(_extrinsics.tail(4));
     intrinsic_ptr_ = new StateBlock(_intrinsics_ptr->pinhole_model);
-    pinhole::computeCorrectionModel(intrinsic_ptr_->getVector(), distortion_, correction_);
+    buildUndistortionMap();
 }
 
 
@@ -35,6 +40,94 @@ SensorCamera::~SensorCamera()
     //
 }
 
+void SensorCamera::setUndistortionMapStep(unsigned int _step)
+{
+    assert(_step > 0 && "Undistortion map step must be positive");
+    undistortion_map_step_ = _step;
+    buildUndistortionMap();
+}
+
+void SensorCamera::buildUndistortionMap()
+{
+    Eigen::Vector4s k = intrinsic_ptr_->getVector();
+    pinhole::computeCorrectionModel(k, distortion_, correction_);
+
+    // nodes covering the whole image, borders included
+    undistortion_map_width_ = img_width_ / undistortion_map_step_ + 2;
+    undistortion_map_height_ = img_height_ / undistortion_map_step_ + 2;
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> nodes(2, undistortion_map_width_ * undistortion_map_height_);
+    for (unsigned int j = 0; j < undistortion_map_height_; j++)
+        for (unsigned int i = 0; i < undistortion_map_width_; i++)
+            nodes.col(i + undistortion_map_width_ * j) << i * undistortion_map_step_, j * undistortion_map_step_;
+
+    // First guess with the correction model
+    Eigen::Matrix<Scalar, 3, Eigen::Dynamic> points;
+    pinhole::backprojectPoints(k, correction_, nodes, points);
+    undistortion_map_ = points.topRows<2>();
+
+    // Exact inverse of the distortion: solve r * s(r^2) = r_d for the undistorted radius r, by Newton iterations
+    if (distortion_.size() > 0)
+    {
+        Eigen::Array<Scalar, 1, Eigen::Dynamic> r_d(nodes.cols());
+        r_d = ((nodes.row(0).array() - k(0)) / k(2)).square() + ((nodes.row(1).array() - k(1)) / k(3)).square();
+        r_d = r_d.sqrt();
+        Eigen::Array<Scalar, 1, Eigen::Dynamic> r = undistortion_map_.colwise().norm().array();
+        Eigen::Array<Scalar, 1, Eigen::Dynamic> r2, r2i, s, S_r2;
+        for (int iteration = 0; iteration < 5; iteration++)
+        {
+            r2 = r.square();
+            s.setOnes(r.size());
+            S_r2.setZero(r.size());
+            r2i.setOnes(r.size());
+            for (unsigned int i = 0; i < distortion_.size(); i++)
+            {
+                S_r2 += (i + 1) * distortion_(i) * r2i;
+                r2i *= r2;
+                s += distortion_(i) * r2i;
+            }
+            r -= (r * s - r_d) / (s + 2 * r2 * S_r2);
+        }
+        // scale the guess to the exact radius. The principal point stays where it is.
+        Eigen::Array<Scalar, 1, Eigen::Dynamic> scale = (r_d > 1e-12).select(r / r_d, 1.0);
+        undistortion_map_.row(0) = (((nodes.row(0).array() - k(0)) / k(2)) * scale).matrix();
+        undistortion_map_.row(1) = (((nodes.row(1).array() - k(1)) / k(3)) * scale).matrix();
+    }
+
+    undistortion_map_intrinsics_ = k;
+}
+
+void SensorCamera::undistort(const Eigen::Matrix<Scalar, 2, Eigen::Dynamic>& _pixels,
+                             Eigen::Matrix<Scalar, 2, Eigen::Dynamic>& _undistorted_pixels)
+{
+    // rebuild the map if the intrinsics changed
+    Eigen::Vector4s k = intrinsic_ptr_->getVector();
+    if (k != undistortion_map_intrinsics_)
+        buildUndistortionMap();
+
+    _undistorted_pixels.resize(2, _pixels.cols());
+    const Scalar inv_step = 1.0 / undistortion_map_step_;
+    for (unsigned int n = 0; n < _pixels.cols(); n++)
+    {
+        Scalar x = _pixels(0, n) * inv_step;
+        Scalar y = _pixels(1, n) * inv_step;
+        Eigen::Vector2s point;
+        if (x >= 0 && y >= 0 && x < undistortion_map_width_ - 1 && y < undistortion_map_height_ - 1)
+        {
+            // bilinear interpolation between the 4 surrounding nodes
+            unsigned int i = x, j = y;
+            Scalar a = x - i, b = y - j;
+            unsigned int node = i + undistortion_map_width_ * j;
+            point = (1 - b) * ((1 - a) * undistortion_map_.col(node) + a * undistortion_map_.col(node + 1))
+                    + b * ((1 - a) * undistortion_map_.col(node + undistortion_map_width_)
+                            + a * undistortion_map_.col(node + undistortion_map_width_ + 1));
+        }
+        else
+            point = pinhole::backprojectPoint(k, correction_, _pixels.col(n)).head<2>();
+
+        _undistorted_pixels.col(n) = pinhole::pixellizePoint(k, point);
+    }
+}
+
 // Define the factory method
 SensorBase* SensorCamera::create(const std::string& _unique_name, //
                                  const Eigen::VectorXs& _extrinsics_pq, //
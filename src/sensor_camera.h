@@ -48,12 +48,37 @@ class SensorCamera : public SensorBase
     int getImgWidth(){return img_width_;}
     int getImgHeight(){return img_height_;}
 
+    /** \brief Undistort a set of pixels
+     * \param _pixels the distorted pixels, as a 2xN matrix
+     * \param _undistorted_pixels the pixels of the ideal pin-hole camera with the same intrinsic parameters, as a 2xN matrix
+     *
+     * Pixels inside the image are undistorted by bilinear interpolation in a lookup map
+     * of the exact inverse of the distortion model, which the correction model only approximates.
+     * The map is rebuilt whenever the intrinsic parameters change, e.g. after being estimated by the solver.
+     * Pixels out of the image are undistorted with the correction model.
+     */
+    void undistort(const Eigen::Matrix<Scalar, 2, Eigen::Dynamic>& _pixels, Eigen::Matrix<Scalar, 2, Eigen::Dynamic>& _undistorted_pixels);
+
+    /** \brief Set the spacing of the nodes of the undistortion map, in pixels
+     */
+    void setUndistortionMapStep(unsigned int _step);
+
     private:
     int img_width_;
     int img_height_;
     Eigen::VectorXs distortion_;
     Eigen::VectorXs correction_;
 
+    // Undistortion lookup map
+    unsigned int undistortion_map_step_;                        ///< pixels between map nodes
+    unsigned int undistortion_map_width_, undistortion_map_height_; ///< number of map nodes
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> undistortion_map_; ///< undistorted points in the normalized plane, one node per column, row by row
+    Eigen::Vector4s undistortion_map_intrinsics_;               ///< intrinsic parameters used to build the map
+
+    /** \brief Build the undistortion map, and the correction model, for the current intrinsic parameters
+     */
+    void buildUndistortionMap();
+
     public:
         static SensorBase* create(const std::string & _unique_name, //
                                   const Eigen::VectorXs& _extrinsics, //
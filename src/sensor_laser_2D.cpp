@@ -4,7 +4,8 @@
 namespace wolf {
 
 SensorLaser2D::SensorLaser2D(StateBlock* _p_ptr, StateBlock* _o_ptr) :
-    SensorBase(SEN_LIDAR, _p_ptr, _o_ptr, nullptr, 8)
+    SensorBase(SEN_LIDAR, _p_ptr, _o_ptr, nullptr, 8),
+    scan_pool_ptr_(std::make_shared<LaserScanPool>())
 {
     setType("LASER 2D");
     setDefaultScanParams();
@@ -12,14 +13,16 @@ SensorLaser2D::SensorLaser2D(StateBlock* _p_ptr, StateBlock* _o_ptr) :
 
 SensorLaser2D::SensorLaser2D(StateBlock* _p_ptr, StateBlock* _o_ptr, const double& _angle_min, const double& _angle_max, const double& _angle_step, const double& _scan_time, const double& _range_min, const double& _range_max, const double& _range_std_dev, const double& _angle_std_dev) :
         SensorBase(SEN_LIDAR, _p_ptr, _o_ptr, nullptr, 8),
-        scan_params_({ _angle_min, _angle_max, _angle_step, _scan_time, _range_min, _range_max, _range_std_dev, _angle_std_dev })
+        scan_params_({ _angle_min, _angle_max, _angle_step, _scan_time, _range_min, _range_max, _range_std_dev, _angle_std_dev }),
+        scan_pool_ptr_(std::make_shared<LaserScanPool>())
 {
     setType("LASER 2D");
 }
 
 SensorLaser2D::SensorLaser2D(StateBlock* _p_ptr, StateBlock* _o_ptr, const laserscanutils::LaserScanParams& _params) :
         SensorBase(SEN_LIDAR, _p_ptr, _o_ptr, nullptr, 8),
-        scan_params_(_params)
+        scan_params_(_params),
+        scan_pool_ptr_(std::make_shared<LaserScanPool>())
 {
     setType("LASER 2D");
 }
@@ -52,6 +55,11 @@ const laserscanutils::LaserScanParams& SensorLaser2D::getScanParams() const
     return scan_params_;
 }
 
+LaserScanPoolPtr SensorLaser2D::getScanPool() const
+{
+    return scan_pool_ptr_;
+}
+
 // Define the factory method
 SensorBase* SensorLaser2D::create(const std::string& _unique_name, const Eigen::VectorXs& _extrinsics_po,
                                   const IntrinsicsBase* _intrinsics)
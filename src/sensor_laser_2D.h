@@ -5,6 +5,7 @@
 
 //wolf
 #include "sensor_base.h"
+#include "laser_scan_pool.h"
 
 //laser_scan_utils
 #include "laser_scan_utils/laser_scan.h"
@@ -21,6 +22,7 @@ class SensorLaser2D : public SensorBase
 {
     protected:
         laserscanutils::LaserScanParams scan_params_;
+        LaserScanPoolPtr scan_pool_ptr_; ///< scans recycled by the captures of this sensor
 
     public:
         /** \brief Constructor with extrinsics
@@ -71,6 +73,12 @@ class SensorLaser2D : public SensorBase
          **/                        
         const laserscanutils::LaserScanParams & getScanParams() const;
 
+        /** \brief Get the pool of scans of this sensor
+         *
+         * Shared with all the CaptureLaser2D of this sensor, see CaptureLaser2D.
+         **/
+        LaserScanPoolPtr getScanPool() const;
+
     public:
         static SensorBase* create(const std::string& _unique_name, const Eigen::VectorXs& _extrinsics_po, const IntrinsicsBase* _intrinsics);
         static IntrinsicsBase* createParams(const std::string _filename_dot_yaml);
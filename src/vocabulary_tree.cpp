@@ -0,0 +1,302 @@
+/**
+ * \file vocabulary_tree.cpp
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#include "vocabulary_tree.h"
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace wolf
+{
+
+namespace
+{
+const char VOCABULARY_FILE_MAGIC[8] = {'W', 'O', 'L', 'F', 'V', 'O', 'C', '1'};
+}
+
+VocabularyTree::VocabularyTree() :
+        branching_(0), depth_(0), descriptor_bytes_(0)
+{
+}
+
+VocabularyTree::~VocabularyTree()
+{
+}
+
+void VocabularyTree::train(const std::vector<std::vector<unsigned char> >& _images, unsigned int _descriptor_bytes,
+                           unsigned int _branching, unsigned int _depth)
+{
+    assert(_descriptor_bytes > 0 && _branching > 1 && _depth > 0 && "VocabularyTree::train: bad vocabulary size");
+
+    branching_ = _branching;
+    depth_ = _depth;
+    descriptor_bytes_ = _descriptor_bytes;
+
+    // all training descriptors in one buffer
+    std::vector<unsigned char> descriptors;
+    std::vector<unsigned int> image_start(1, 0);
+    for (auto& image : _images)
+    {
+        assert(image.size() % descriptor_bytes_ == 0 && "VocabularyTree::train: truncated descriptor");
+        descriptors.insert(descriptors.end(), image.begin(), image.end());
+        image_start.push_back(descriptors.size() / descriptor_bytes_);
+    }
+    std::vector<unsigned int> indices(descriptors.size() / descriptor_bytes_);
+    for (unsigned int i = 0; i < indices.size(); i++)
+        indices[i] = i;
+
+    // the root
+    centers_.assign(descriptor_bytes_, 0);
+    first_child_.assign(1, 0);
+    n_children_.assign(1, 0);
+    node_word_.assign(1, 0);
+    word_weights_.clear();
+    cluster(0, descriptors, indices, 0);
+
+    // idf weights: number of training images where each word appears
+    std::vector<unsigned int> word_images(numWords(), 0);
+    std::vector<unsigned int> last_image(numWords(), _images.size());
+    for (unsigned int im = 0; im < _images.size(); im++)
+        for (unsigned int i = image_start[im]; i < image_start[im + 1]; i++)
+        {
+            unsigned int word = getWord(&descriptors[i * descriptor_bytes_]);
+            if (last_image[word] != im)
+            {
+                last_image[word] = im;
+                word_images[word]++;
+            }
+        }
+    for (unsigned int w = 0; w < numWords(); w++)
+        word_weights_[w] = (word_images[w] > 0 ? std::log((Scalar)_images.size() / word_images[w]) : 0);
+}
+
+void VocabularyTree::cluster(unsigned int _node, const std::vector<unsigned char>& _descriptors,
+                             const std::vector<unsigned int>& _indices, unsigned int _level)
+{
+    if (_level == depth_ || _indices.size() <= 1)
+    {
+        // a new word
+        node_word_[_node] = word_weights_.size();
+        word_weights_.push_back(0);
+        return;
+    }
+
+    // initial centers with k-means++, with a fixed seed for a reproducible vocabulary
+    unsigned int k = std::min(branching_, (unsigned int)_indices.size());
+    std::vector<unsigned char> centers(k * descriptor_bytes_);
+    std::mt19937 generator(_node);
+    std::vector<unsigned int> min_distance(_indices.size(), descriptor_bytes_ * 8 + 1);
+    unsigned int seed = _indices[std::uniform_int_distribution<unsigned int>(0, _indices.size() - 1)(generator)];
+    for (unsigned int c = 0; c < k; c++)
+    {
+        std::memcpy(&centers[c * descriptor_bytes_], &_descriptors[seed * descriptor_bytes_], descriptor_bytes_);
+        std::vector<Scalar> probability(_indices.size());
+        for (unsigned int i = 0; i < _indices.size(); i++)
+        {
+            unsigned int d = hammingDistance(&_descriptors[_indices[i] * descriptor_bytes_], &centers[c * descriptor_bytes_], descriptor_bytes_);
+            min_distance[i] = std::min(min_distance[i], d);
+            probability[i] = (Scalar)min_distance[i] * min_distance[i];
+        }
+        if (std::all_of(probability.begin(), probability.end(), [](Scalar _p) { return _p == 0; }))
+        {
+            k = c + 1; // all descriptors equal to some center
+            break;
+        }
+        seed = _indices[std::discrete_distribution<unsigned int>(probability.begin(), probability.end())(generator)];
+    }
+
+    // k-majority iterations
+    std::vector<unsigned int> assignment(_indices.size(), k);
+    std::vector<std::vector<unsigned int> > clusters(k);
+    const unsigned int max_iterations = 10;
+    for (unsigned int iteration = 0; iteration < max_iterations; iteration++)
+    {
+        bool changed = false;
+        for (auto& cl : clusters)
+            cl.clear();
+        for (unsigned int i = 0; i < _indices.size(); i++)
+        {
+            unsigned int best_c = 0;
+            unsigned int best_distance = descriptor_bytes_ * 8 + 1;
+            for (unsigned int c = 0; c < k; c++)
+            {
+                unsigned int d = hammingDistance(&_descriptors[_indices[i] * descriptor_bytes_], &centers[c * descriptor_bytes_], descriptor_bytes_);
+                if (d < best_distance)
+                {
+                    best_distance = d;
+                    best_c = c;
+                }
+            }
+            changed = changed || (assignment[i] != best_c);
+            assignment[i] = best_c;
+            clusters[best_c].push_back(_indices[i]);
+        }
+        if (!changed)
+            break;
+        for (unsigned int c = 0; c < k; c++)
+            if (!clusters[c].empty())
+                majority(_descriptors, clusters[c], &centers[c * descriptor_bytes_]);
+    }
+
+    // drop the empty clusters
+    unsigned int n_children = 0;
+    for (unsigned int c = 0; c < k; c++)
+        if (!clusters[c].empty())
+        {
+            if (n_children != c)
+            {
+                std::memcpy(&centers[n_children * descriptor_bytes_], &centers[c * descriptor_bytes_], descriptor_bytes_);
+                clusters[n_children].swap(clusters[c]);
+            }
+            n_children++;
+        }
+    if (n_children <= 1)
+    {
+        // nothing to split
+        node_word_[_node] = word_weights_.size();
+        word_weights_.push_back(0);
+        return;
+    }
+
+    // the children, contiguous, then their subtrees
+    unsigned int first_child = n_children_.size();
+    first_child_[_node] = first_child;
+    n_children_[_node] = n_children;
+    centers_.insert(centers_.end(), centers.begin(), centers.begin() + n_children * descriptor_bytes_);
+    first_child_.resize(first_child + n_children, 0);
+    n_children_.resize(first_child + n_children, 0);
+    node_word_.resize(first_child + n_children, 0);
+    for (unsigned int c = 0; c < n_children; c++)
+        cluster(first_child + c, _descriptors, clusters[c], _level + 1);
+}
+
+void VocabularyTree::majority(const std::vector<unsigned char>& _descriptors, const std::vector<unsigned int>& _indices,
+                              unsigned char* _center) const
+{
+    std::vector<unsigned int> ones(descriptor_bytes_ * 8, 0);
+    for (auto i : _indices)
+    {
+        const unsigned char* d = &_descriptors[i * descriptor_bytes_];
+        for (unsigned int bit = 0; bit < descriptor_bytes_ * 8; bit++)
+            ones[bit] += (d[bit / 8] >> (7 - bit % 8)) & 1;
+    }
+    std::memset(_center, 0, descriptor_bytes_);
+    for (unsigned int bit = 0; bit < descriptor_bytes_ * 8; bit++)
+        if (2 * ones[bit] > _indices.size())
+            _center[bit / 8] |= 1 << (7 - bit % 8);
+}
+
+void VocabularyTree::transform(const unsigned char* _descriptors, unsigned int _n_descriptors, BowVector& _bow) const
+{
+    _bow.clear();
+    if (_n_descriptors == 0)
+        return;
+
+    std::vector<unsigned int> words(_n_descriptors);
+    for (unsigned int i = 0; i < _n_descriptors; i++)
+        words[i] = getWord(_descriptors + i * descriptor_bytes_);
+    std::sort(words.begin(), words.end());
+
+    // tf-idf: count of each word times its weight. Words of weight 0, found in all training images, are dropped.
+    Scalar norm = 0;
+    for (unsigned int i = 0; i < words.size();)
+    {
+        unsigned int j = i;
+        while (j < words.size() && words[j] == words[i])
+            j++;
+        Scalar weight = (j - i) * word_weights_[words[i]];
+        if (weight > 0)
+        {
+            _bow.push_back(std::make_pair(words[i], weight));
+            norm += weight;
+        }
+        i = j;
+    }
+    for (auto& word_weight : _bow)
+        word_weight.second /= norm;
+}
+
+void VocabularyTree::save(const std::string& _filename) const
+{
+    std::ofstream file(_filename, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("VocabularyTree::save: cannot open file " + _filename);
+
+    std::uint32_t header[5] = {branching_, depth_, descriptor_bytes_, (std::uint32_t)n_children_.size(), numWords()};
+    file.write(VOCABULARY_FILE_MAGIC, sizeof(VOCABULARY_FILE_MAGIC));
+    file.write((const char*)header, sizeof(header));
+    file.write((const char*)centers_.data(), centers_.size());
+    file.write((const char*)first_child_.data(), first_child_.size() * sizeof(std::uint32_t));
+    file.write((const char*)n_children_.data(), n_children_.size() * sizeof(std::uint32_t));
+    file.write((const char*)node_word_.data(), node_word_.size() * sizeof(std::uint32_t));
+    file.write((const char*)word_weights_.data(), word_weights_.size() * sizeof(Scalar));
+    if (!file)
+        throw std::runtime_error("VocabularyTree::save: cannot write file " + _filename);
+}
+
+void VocabularyTree::load(const std::string& _filename)
+{
+    std::ifstream file(_filename, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("VocabularyTree::load: cannot open file " + _filename);
+    const std::uint64_t file_size = file.tellg();
+    file.seekg(0);
+
+    char magic[sizeof(VOCABULARY_FILE_MAGIC)];
+    std::uint32_t header[5];
+    file.read(magic, sizeof(magic));
+    file.read((char*)header, sizeof(header));
+    if (!file || !std::equal(magic, magic + sizeof(magic), VOCABULARY_FILE_MAGIC))
+        throw std::runtime_error("VocabularyTree::load: not a vocabulary file: " + _filename);
+
+    // the sizes in the header must match the file length, before allocating anything
+    const std::uint64_t descriptor_bytes = header[2];
+    const std::uint64_t n_nodes = header[3];
+    const std::uint64_t n_words = header[4];
+    const std::uint64_t expected_size = sizeof(magic) + sizeof(header) + n_nodes * descriptor_bytes
+            + 3 * n_nodes * sizeof(std::uint32_t) + n_words * sizeof(Scalar);
+    if (descriptor_bytes == 0 || n_nodes == 0 || n_words == 0 || file_size != expected_size)
+        throw std::runtime_error("VocabularyTree::load: bad vocabulary size in file " + _filename);
+
+    std::vector<unsigned char> centers(n_nodes * descriptor_bytes);
+    std::vector<std::uint32_t> first_child(n_nodes), n_children(n_nodes), node_word(n_nodes);
+    std::vector<Scalar> word_weights(n_words);
+    file.read((char*)centers.data(), centers.size());
+    file.read((char*)first_child.data(), first_child.size() * sizeof(std::uint32_t));
+    file.read((char*)n_children.data(), n_children.size() * sizeof(std::uint32_t));
+    file.read((char*)node_word.data(), node_word.size() * sizeof(std::uint32_t));
+    file.read((char*)word_weights.data(), word_weights.size() * sizeof(Scalar));
+    if (!file)
+        throw std::runtime_error("VocabularyTree::load: truncated vocabulary file: " + _filename);
+
+    // getWord() descends from the root: the children must be nodes after their parent, and the leaves valid words
+    for (std::uint64_t node = 0; node < n_nodes; node++)
+    {
+        if (n_children[node] > 0)
+        {
+            if (first_child[node] <= node || (std::uint64_t)first_child[node] + n_children[node] > n_nodes)
+                throw std::runtime_error("VocabularyTree::load: bad node children in file " + _filename);
+        }
+        else if (node_word[node] >= n_words)
+            throw std::runtime_error("VocabularyTree::load: bad node word in file " + _filename);
+    }
+
+    branching_ = header[0];
+    depth_ = header[1];
+    descriptor_bytes_ = descriptor_bytes;
+    centers_.swap(centers);
+    first_child_.swap(first_child);
+    n_children_.swap(n_children);
+    node_word_.swap(node_word);
+    word_weights_.swap(word_weights);
+}
+
+} // namespace wolf
@@ -0,0 +1,180 @@
+/**
+ * \file vocabulary_tree.h
+ *
+ *  Created on: Oct 19, 2016
+ *      \author: jsola
+ */
+
+#ifndef VOCABULARY_TREE_H_
+#define VOCABULARY_TREE_H_
+
+// Wolf includes
+#include "wolf.h"
+
+// std includes
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace wolf
+{
+
+/** \brief Bag-of-words vector of an image: pairs of (word, weight), sorted by word, with L1 norm 1
+ */
+typedef std::vector<std::pair<unsigned int, Scalar> > BowVector;
+
+/** \brief Vocabulary tree of binary descriptors
+ *
+ * A tree of binary descriptor centers, built by hierarchical k-majority clustering (k-means with the Hamming distance).
+ * Each node has up to \a branching children, and the leaves are the words of the vocabulary.
+ * A descriptor is quantized to a word by descending the tree, choosing the closest child at each level:
+ * this costs branching * depth Hamming distances, instead of one per word.
+ *
+ * Each word has an inverse document frequency weight, idf = log(N / N_i),
+ * with N the number of training images and N_i the number of them where the word appears.
+ * Frequent words are little discriminant, and get low weights.
+ *
+ * The nodes are stored in flat arrays, with the children of each node contiguous, so that descending the tree
+ * touches few cache lines. The vocabulary file is a dump of these arrays, read back in one pass by load().
+ *
+ * The descriptors are raw byte arrays, e.g. the rows of the cv::Mat of ORB or BRISK descriptors.
+ */
+class VocabularyTree
+{
+    protected:
+        unsigned int branching_;                ///< max number of children of each node
+        unsigned int depth_;                    ///< max number of levels below the root
+        unsigned int descriptor_bytes_;         ///< length of the descriptors in bytes, e.g. 32 for ORB
+        std::vector<unsigned char> centers_;    ///< center of each node, descriptor_bytes_ each. The root has none.
+        std::vector<std::uint32_t> first_child_;///< index of the first child of each node
+        std::vector<std::uint32_t> n_children_; ///< number of children of each node. 0: the node is a word
+        std::vector<std::uint32_t> node_word_;  ///< word of each leaf node
+        std::vector<Scalar> word_weights_;      ///< idf weight of each word
+
+    public:
+        VocabularyTree();
+        virtual ~VocabularyTree();
+
+        /** \brief Build the vocabulary from a set of training images
+         * \param _images the descriptors of each image, concatenated, \a _descriptor_bytes each
+         * \param _descriptor_bytes the length of the descriptors in bytes
+         * \param _branching the max number of children of each node
+         * \param _depth the number of levels, so that there are up to _branching^_depth words
+         */
+        void train(const std::vector<std::vector<unsigned char> >& _images, unsigned int _descriptor_bytes,
+                   unsigned int _branching, unsigned int _depth);
+
+        /** \brief Save the vocabulary to a binary file
+         */
+        void save(const std::string& _filename) const;
+
+        /** \brief Load the vocabulary from a binary file written by save()
+         *
+         * The sizes and the node indices of the file are checked before use.
+         * Throws std::runtime_error if the file is not a valid vocabulary, and the vocabulary is then unchanged.
+         */
+        void load(const std::string& _filename);
+
+        bool empty() const;
+        unsigned int numWords() const;
+        unsigned int getDescriptorBytes() const;
+        Scalar getWordWeight(unsigned int _word) const;
+
+        /** \brief Word of a descriptor
+         */
+        unsigned int getWord(const unsigned char* _descriptor) const;
+
+        /** \brief Bag-of-words vector of a set of descriptors
+         * \param _descriptors the descriptors, contiguous, getDescriptorBytes() each
+         * \param _n_descriptors the number of descriptors
+         * \param _bow the returned tf-idf weights of the words, L1-normalized
+         */
+        void transform(const unsigned char* _descriptors, unsigned int _n_descriptors, BowVector& _bow) const;
+
+        /** \brief Hamming distance between two binary descriptors
+         */
+        static unsigned int hammingDistance(const unsigned char* _d1, const unsigned char* _d2, unsigned int _bytes);
+
+    private:
+        /** \brief Cluster the descriptors of a node into its children, and recurse down to the leaves
+         */
+        void cluster(unsigned int _node, const std::vector<unsigned char>& _descriptors,
+                     const std::vector<unsigned int>& _indices, unsigned int _level);
+
+        /** \brief Bitwise majority of a set of descriptors: the center of a k-majority cluster
+         */
+        void majority(const std::vector<unsigned char>& _descriptors, const std::vector<unsigned int>& _indices,
+                      unsigned char* _center) const;
+};
+
+inline bool VocabularyTree::empty() const
+{
+    return word_weights_.empty();
+}
+
+inline unsigned int VocabularyTree::numWords() const
+{
+    return word_weights_.size();
+}
+
+inline unsigned int VocabularyTree::getDescriptorBytes() const
+{
+    return descriptor_bytes_;
+}
+
+inline Scalar VocabularyTree::getWordWeight(unsigned int _word) const
+{
+    return word_weights_[_word];
+}
+
+inline unsigned int VocabularyTree::getWord(const unsigned char* _descriptor) const
+{
+    assert(!empty() && "VocabularyTree::getWord: empty vocabulary");
+    unsigned int node = 0;
+    while (n_children_[node] > 0)
+    {
+        unsigned int best_child = first_child_[node];
+        unsigned int best_distance = descriptor_bytes_ * 8 + 1;
+        for (unsigned int child = first_child_[node]; child < first_child_[node] + n_children_[node]; child++)
+        {
+            unsigned int distance = hammingDistance(_descriptor, &centers_[child * descriptor_bytes_], descriptor_bytes_);
+            if (distance < best_distance)
+            {
+                best_distance = distance;
+                best_child = child;
+            }
+        }
+        node = best_child;
+    }
+    return node_word_[node];
+}
+
+inline unsigned int VocabularyTree::hammingDistance(const unsigned char* _d1, const unsigned char* _d2, unsigned int _bytes)
+{
+    unsigned int distance = 0;
+    unsigned int i = 0;
+    // 8 bytes at a time, with a SWAR popcount
+    for (; i + 8 <= _bytes; i += 8)
+    {
+        std::uint64_t a, b;
+        std::memcpy(&a, _d1 + i, 8);
+        std::memcpy(&b, _d2 + i, 8);
+        std::uint64_t x = a ^ b;
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        distance += (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+    }
+    for (; i < _bytes; i++)
+    {
+        unsigned char x = _d1[i] ^ _d2[i];
+        for (; x; x &= x - 1)
+            distance++;
+    }
+    return distance;
+}
+
+} // namespace wolf
+
+#endif /* VOCABULARY_TREE_H_ */
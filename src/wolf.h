@@ -17,6 +17,9 @@
 #include <eigen3/Eigen/Geometry>
 #include <eigen3/Eigen/Sparse>
 
+//includes from wolf
+#include "match_map.h"
+
 namespace wolf {
 
 /**
@@ -228,7 +231,10 @@ typedef enum
     PRC_LIDAR, ///< Laser 2D processor
     PRC_ODOM_2D, ///< 2D odometry integrator
     PRC_ODOM_3D, ///< 2D odometry integrator
-    PRC_IMU ///< IMU delta pre-integrator
+    PRC_IMU, ///< IMU delta pre-integrator
+    PRC_TRACKER_SCAN_MATCHING_2D, ///< Laser 2D scan-to-map matcher
+    PRC_TRACKER_IMAGE_KLT, ///< Point feature tracker for video sequences, with optical flow
+    PRC_TRACKER_LANDMARK_IMAGE ///< Tracker of 3D point Landmarks in video sequences
 } ProcessorType;
 
 /** \brief enumeration of all possible Feature types
@@ -359,7 +365,7 @@ struct LandmarkMatch
 };
 
 // Match map Feature - Landmark
-typedef std::map<FeatureBase*, LandmarkMatch> LandmarkMatchMap;
+typedef MatchMap<FeatureBase*, LandmarkMatch> LandmarkMatchMap;
 
 
 inline Scalar pi2pi(const Scalar& angle)
@@ -375,7 +381,7 @@ struct FeatureMatch
         Scalar normalized_score_;
 };
 
-typedef std::map<FeatureBase*, FeatureMatch> FeatureMatchMap;
+typedef MatchMap<FeatureBase*, FeatureMatch> FeatureMatchMap;
 
 } // namespace wolf
 
@@ -10,6 +10,8 @@
 
 // wolf
 #include "../processor_image.h"
+#include "../processor_image_klt.h"
+#include "../processor_tracker_landmark_image.h"
 #include "../factory.h"
 
 // yaml-cpp library
@@ -19,15 +21,29 @@ namespace wolf
 {
 namespace
 {
-static ProcessorParamsBase* createProcessorParamsImage(const std::string & _filename_dot_yaml)
+/** Optional key frame policy of the trackers, see ProcessorTracker::setKeyFramePolicy()
+ */
+static void readKeyFramePolicy(const YAML::Node& _policy, ProcessorParamsTracker* _p)
+{
+    if (!_policy)
+        return;
+    if (_policy["minimum track ratio"])
+        _p->min_track_ratio     = _policy["minimum track ratio"].as<Scalar>();
+    if (_policy["maximum key frame period"])
+        _p->max_keyframe_period = _policy["maximum key frame period"].as<Scalar>();
+    if (_policy["minimum key frame period"])
+        _p->min_keyframe_period = _policy["minimum key frame period"].as<Scalar>();
+    if (_policy["time budget"])
+        _p->time_budget         = _policy["time budget"].as<Scalar>();
+}
+
+/** Params common to all image processors
+ */
+static void readProcessorParamsImage(const YAML::Node& params, ProcessorImageParameters* p)
 {
     using std::string;
     using YAML::Node;
 
-    ProcessorImageParameters* p = new ProcessorImageParameters;
-
-    Node params = YAML::LoadFile(_filename_dot_yaml);
-
     if (params["processor type"])
     {
         Node dd_yaml = params["detector-descriptor"];
@@ -80,15 +96,76 @@ static ProcessorParamsBase* createProcessorParamsImage(const std::string & _file
 
         Node alg = params["algorithm"];
         p->algorithm.max_new_features = alg["maximum new features"].as<unsigned int>();
+        p->max_new_features = p->algorithm.max_new_features;
         p->algorithm.min_features_for_keyframe = alg["minimum features for new keyframe"].as<unsigned int>();
+        if (alg["detect whole image"])
+            p->algorithm.detect_whole_image = alg["detect whole image"].as<bool>();
+        if (alg["track whole image"])
+            p->algorithm.track_whole_image = alg["track whole image"].as<bool>();
 
+        readKeyFramePolicy(params["key frame policy"], p);
     }
+}
+
+static ProcessorParamsBase* createProcessorParamsImage(const std::string & _filename_dot_yaml)
+{
+    ProcessorImageParameters* p = new ProcessorImageParameters;
+
+    readProcessorParamsImage(YAML::LoadFile(_filename_dot_yaml), p);
+
+    return p;
+}
+
+static ProcessorParamsBase* createProcessorParamsImageKLT(const std::string & _filename_dot_yaml)
+{
+    ProcessorImageKLTParameters* p = new ProcessorImageKLTParameters;
+
+    YAML::Node params = YAML::LoadFile(_filename_dot_yaml);
+    readProcessorParamsImage(params, p);
+
+    YAML::Node klt = params["klt"]; // Optional, see ProcessorImageKLTParameters for the defaults
+    if (klt["window size"])
+        p->klt.window_size      = klt["window size"].as<unsigned int>();
+    if (klt["pyramid levels"])
+        p->klt.pyramid_levels   = klt["pyramid levels"].as<unsigned int>();
+    if (klt["maximum error"])
+        p->klt.max_error        = klt["maximum error"].as<Scalar>();
+
+    return p;
+}
+
+static ProcessorParamsBase* createProcessorParamsImageLandmark(const std::string & _filename_dot_yaml)
+{
+    ProcessorTrackerLandmarkImageParameters* p = new ProcessorTrackerLandmarkImageParameters;
+
+    YAML::Node params = YAML::LoadFile(_filename_dot_yaml);
+    readProcessorParamsImage(params, p);
+
+    YAML::Node lmk = params["landmark"]; // Optional, see ProcessorTrackerLandmarkImageParameters for the defaults
+    if (lmk["homogeneous"])
+        p->landmark.homogeneous     = lmk["homogeneous"].as<bool>();
+    if (lmk["initial depth"])
+        p->landmark.initial_depth   = lmk["initial depth"].as<Scalar>();
+
+    YAML::Node reloc = params["relocalization"]; // Optional, no relocalization without vocabulary file
+    if (reloc["vocabulary file"])
+        p->relocalization.vocabulary_file           = reloc["vocabulary file"].as<std::string>();
+    if (reloc["maximum candidates"])
+        p->relocalization.max_candidates            = reloc["maximum candidates"].as<unsigned int>();
+    if (reloc["minimum score"])
+        p->relocalization.min_score                 = reloc["minimum score"].as<Scalar>();
+    if (reloc["minimum inliers"])
+        p->relocalization.min_inliers               = reloc["minimum inliers"].as<unsigned int>();
+    if (reloc["maximum reprojection error"])
+        p->relocalization.max_reprojection_error    = reloc["maximum reprojection error"].as<Scalar>();
 
     return p;
 }
 
 // Register in the SensorFactory
 const bool registered_prc_image_par = ProcessorParamsFactory::get().registerCreator("IMAGE", createProcessorParamsImage);
+const bool registered_prc_image_klt_par = ProcessorParamsFactory::get().registerCreator("IMAGE KLT", createProcessorParamsImageKLT);
+const bool registered_prc_image_landmark_par = ProcessorParamsFactory::get().registerCreator("IMAGE LANDMARK", createProcessorParamsImageLandmark);
 
 
 }